@@ -0,0 +1,124 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef DEWETTING_EVENT_DETECTOR_HPP
+#define DEWETTING_EVENT_DETECTOR_HPP
+
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Data container for a single dewetting event.
+ *
+ * Start and end are the time stamps of the first frame in which the solvent 
+ * density fell below the lower threshold and of the first frame in which it 
+ * rose above the upper threshold again. If the pathway was still dewetted at
+ * the end of the trajectory, the end is the last time stamp and isComplete_ 
+ * is false.
+ */
+struct DewettingEvent
+{
+    real start_;
+    real end_;
+    real location_;
+    real minDensity_;
+    real minNumPathway_;
+    bool isComplete_;
+
+    // duration of event:
+    real duration() const { return end_ - start_; }
+};
+
+
+/*!
+ * \brief Detects transient dewetting of the pathway from the minimum solvent
+ * density in each frame.
+ *
+ * Frames must be passed to update() in chronological order. Dewetting is
+ * detected with a hysteresis: the pathway is considered dewetted once the 
+ * minimum solvent density drops below a lower threshold and considered wet 
+ * again only once it rises above an upper threshold. This avoids spurious 
+ * events if the density fluctuates around a single threshold. Events shorter
+ * than a minimum duration are discarded.
+ *
+ * For each event, the location of the constriction is taken to be the 
+ * position of minimum density in the frame with the lowest density during
+ * the event. Apart from the list of detected events, only a constant amount 
+ * of state is kept.
+ */
+class DewettingEventDetector
+{
+    public:
+
+        // constructor:
+        DewettingEventDetector(
+                const real lowThreshold,
+                const real highThreshold,
+                const real minDuration);
+
+        // update with data from new frame:
+        void update(
+                const real time,
+                const real minDensity,
+                const real argMinDensity,
+                const real numPathway);
+
+        // close any open event at end of trajectory:
+        void finish();
+
+        // getter methods for results:
+        const std::vector<DewettingEvent>& events() const;
+        SummaryStatistics durationSummary() const;
+        SummaryStatistics locationSummary() const;
+        real dewettedFraction() const;
+
+    private:
+
+        // parameters:
+        real lowThreshold_;
+        real highThreshold_;
+        real minDuration_;
+
+        // internal state:
+        bool isDewetted_;
+        bool hasFrames_;
+        real firstTime_;
+        real lastTime_;
+        DewettingEvent current_;
+
+        // detected events:
+        std::vector<DewettingEvent> events_;
+
+        // auxiliary function for closing an event:
+        void closeEvent(
+                const real time,
+                const bool isComplete);
+};
+
+#endif
+
@@ -0,0 +1,117 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef DIFFUSION_PROFILE_CALCULATOR_HPP
+#define DIFFUSION_PROFILE_CALCULATOR_HPP
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Estimates a position-dependent diffusion coefficient along the arc 
+ * length coordinate of a pathway in an online fashion.
+ *
+ * For each particle, this class keeps a ring buffer holding the arc length 
+ * coordinate and time stamp of the last maxLag frames in which the particle
+ * has been mapped. Whenever a new frame is passed to update(), the squared 
+ * displacement with respect to each buffered frame is accumulated in a bin 
+ * determined by the arc length coordinate at the start of the lag window. 
+ * Only lag windows starting inside the pathway sample region contribute, but 
+ * particles are tracked even after leaving this region, so that particles 
+ * diffusing out of the pathway do not bias the mean squared displacement. 
+ * The cost per frame is therefore proportional to the number of particles 
+ * times the maximum lag.
+ *
+ * If a particle is missing from a frame, its ring buffer is reset, so that
+ * displacements are never computed across gaps in the trajectory.
+ *
+ * The diffusion coefficient in each bin is then obtained as half the slope of
+ * a least squares fit of mean squared displacement against lag time, 
+ * weighted by the number of samples for each lag. The intercept of this fit
+ * absorbs the noise inherent in the mapping of particles onto the centre 
+ * line. If the maximum lag is one, the fit is forced through the origin.
+ */
+class DiffusionProfileCalculator
+{
+    public:
+
+        // constructor:
+        DiffusionProfileCalculator(
+                const int maxLag, 
+                const real binWidth);
+
+        // update with data from new frame:
+        void update(
+                const std::map<int, real> &arcLength,
+                const std::map<int, bool> &isInsideSample,
+                const real time);
+
+        // getter methods for results:
+        std::vector<real> binCentres() const;
+        std::vector<real> diffusionCoefficients() const;
+        std::vector<int> numSamples() const;
+
+    private:
+
+        // ring buffer of recent positions of an individual particle:
+        struct ParticleHistory
+        {
+            std::vector<real> s_;
+            std::vector<real> t_;
+            std::vector<char> inside_;
+            size_t head_;
+            size_t count_;
+            int lastFrame_;
+        };
+
+        // accumulated displacements for one bin and lag:
+        struct LagAccumulator
+        {
+            SummaryStatistics sqDisp_;
+            SummaryStatistics lagTime_;
+        };
+
+        // parameters:
+        int maxLag_;
+        real binWidth_;
+
+        // internal state:
+        int frameCount_;
+        std::unordered_map<int, ParticleHistory> history_;
+        std::map<int, std::vector<LagAccumulator>> acc_;
+
+        // auxiliary functions:
+        inline int binIndex(const real s) const;
+        real fitDiffusionCoefficient(
+                const std::vector<LagAccumulator> &lagAcc) const;
+};
+
+#endif
+
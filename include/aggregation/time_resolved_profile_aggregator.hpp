@@ -0,0 +1,104 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef TIME_RESOLVED_PROFILE_AGGREGATOR_HPP
+#define TIME_RESOLVED_PROFILE_AGGREGATOR_HPP
+
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Online aggregation of a pathway profile over a rolling window of 
+ * frames and as an exponential moving average.
+ *
+ * Profiles (i.e. a property evaluated at a fixed set of support points) are
+ * passed to update() frame by frame. Every stride frames, once at least 
+ * windowSize frames have been seen, the mean and standard deviation of the 
+ * profile over the last windowSize frames are recorded together with the 
+ * current value of an exponential moving average (EMA) of the profile. If 
+ * stride equals windowSize, this yields non-overlapping blocks, otherwise a
+ * rolling window.
+ *
+ * The EMA uses a time constant tau, so that a frame at time t is weighted 
+ * with \f$ 1 - \exp(-\Delta t/\tau) \f$ relative to the previous average. This
+ * handles non-uniform time steps correctly.
+ *
+ * Only the last windowSize profiles are kept in memory, so that memory use is
+ * independent of the trajectory length apart from the recorded output. A 
+ * window size of zero disables the window statistics and a time constant of
+ * zero disables the EMA.
+ */
+class TimeResolvedProfileAggregator
+{
+    public:
+
+        // constructor:
+        TimeResolvedProfileAggregator(
+                int windowSize,
+                int stride,
+                real emaTimeConstant);
+
+        // update with profile from new frame:
+        void update(
+                real time, 
+                const std::vector<real> &profile);
+
+        // shift all recorded profiles by a constant:
+        void shift(real shift);
+
+        // getter methods for results:
+        const std::vector<real>& timeStamps() const;
+        const std::vector<std::vector<real>>& mean() const;
+        const std::vector<std::vector<real>>& sd() const;
+        const std::vector<std::vector<real>>& ema() const;
+        bool hasWindow() const;
+        bool hasEma() const;
+
+    private:
+
+        // parameters:
+        int windowSize_;
+        int stride_;
+        real emaTimeConstant_;
+
+        // ring buffer of recent profiles:
+        std::vector<std::vector<real>> window_;
+        size_t windowHead_;
+        int numFrames_;
+
+        // current exponential moving average:
+        std::vector<real> currentEma_;
+        real lastTime_;
+
+        // recorded output:
+        std::vector<real> timeStamps_;
+        std::vector<std::vector<real>> mean_;
+        std::vector<std::vector<real>> sd_;
+        std::vector<std::vector<real>> ema_;
+};
+
+#endif
+
@@ -0,0 +1,103 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef WATER_WIRE_CALCULATOR_HPP
+#define WATER_WIRE_CALCULATOR_HPP
+
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Data container for the water wire in a single frame.
+ *
+ * If the pore openings are connected, gapLocation_ is the position along the
+ * pathway of the largest spacing between consecutive particles of the wire 
+ * (i.e. its weakest point) and gapWidth_ is zero. Otherwise gapLocation_ is 
+ * the centre of the stretch of pathway not reached from either opening and
+ * gapWidth_ is its length.
+ */
+struct WaterWire
+{
+    bool isConnected_;
+    real gapLocation_;
+    real gapWidth_;
+};
+
+
+/*!
+ * \brief Functor for determining whether a continuous chain of solvent 
+ * particles connects the two pore openings.
+ *
+ * Two solvent particles are considered in contact if their distance is below
+ * a cutoff and a particle is considered in contact with a pore opening if its
+ * arc length coordinate lies within the cutoff of that opening. Contacts are 
+ * found with a cell list of cell size equal to the cutoff, so that only 
+ * particles in neighbouring cells need to be compared, and connected 
+ * components of the contact graph are tracked with a union-find structure. 
+ * The openings are connected if any component touches both of them. The cost
+ * is linear in the number of particles passed in, which should be restricted
+ * to those inside the pore.
+ */
+class WaterWireCalculator
+{
+    public:
+
+        // constructor:
+        WaterWireCalculator(
+                const real cutoff);
+
+        // interface for finding water wire:
+        WaterWire operator()(
+                const std::vector<gmx::RVec> &positions,
+                const std::vector<real> &arcLength,
+                const real sLo,
+                const real sHi);
+
+    private:
+
+        // parameters:
+        real cutoff_;
+
+        // internal union-find state:
+        std::vector<size_t> parent_;
+        std::vector<size_t> size_;
+
+        // union-find operations:
+        size_t findRoot(
+                size_t i);
+        void unite(
+                size_t i, 
+                size_t j);
+
+        // contact graph:
+        void connectContacts(
+                const std::vector<gmx::RVec> &positions);
+};
+
+#endif
+
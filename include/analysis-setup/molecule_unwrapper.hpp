@@ -0,0 +1,103 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef MOLECULE_UNWRAPPER_HPP
+#define MOLECULE_UNWRAPPER_HPP
+
+#include <utility>
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/pbcutil/pbc.h>
+#include <gromacs/topology/topology.h>
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Makes a group of atoms whole across periodic boundaries.
+ *
+ * On construction, a spanning tree of the bond graph restricted to the given
+ * atoms is built once. In each frame, every atom is then moved to the 
+ * periodic image closest to its parent in this tree, which makes each 
+ * connected component (e.g. each protein chain) whole. Components are 
+ * subsequently moved to the image closest to the centre of geometry of the 
+ * components already placed, largest first, so that multimeric assemblies 
+ * are kept together. If a reference centre is set, the entire group is 
+ * finally shifted by a box vector such that its centre of geometry lies as 
+ * close as possible to this reference, which avoids jumps of the group 
+ * between frames. 
+ *
+ * Only the coordinates of the group atoms are touched, so the cost is linear
+ * in the size of the group rather than the system. Other particles can be 
+ * brought close to the group with nearestImage().
+ */
+class MoleculeUnwrapper
+{
+    public:
+
+        // constructor:
+        MoleculeUnwrapper(
+                const std::vector<int> &atomIndices,
+                const std::vector<std::pair<int, int>> &bonds);
+
+        // bond graph of topology:
+        static std::vector<std::pair<int, int>> bondsFromTopology(
+                const t_topology &top);
+
+        // setter methods:
+        void setReferenceCentre(
+                const gmx::RVec &centre);
+
+        // interface for unwrapping:
+        std::vector<gmx::RVec> operator()(
+                const rvec *x,
+                const t_pbc *pbc) const;
+
+        // utilities:
+        static gmx::RVec centreOfGeometry(
+                const std::vector<gmx::RVec> &positions);
+        static gmx::RVec nearestImage(
+                const gmx::RVec &position,
+                const gmx::RVec &centre,
+                const t_pbc *pbc);
+
+    private:
+
+        // global indices of group atoms:
+        std::vector<int> atomIndices_;
+
+        // spanning tree in traversal order with local indices:
+        // (parent is negative for the root of each component)
+        std::vector<size_t> order_;
+        std::vector<int> parent_;
+        std::vector<size_t> componentOffsets_;
+
+        // reference position of group:
+        bool hasReferenceCentre_;
+        gmx::RVec referenceCentre_;
+};
+
+#endif
+
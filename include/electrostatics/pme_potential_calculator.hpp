@@ -0,0 +1,203 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef PME_POTENTIAL_CALCULATOR_HPP
+#define PME_POTENTIAL_CALCULATOR_HPP
+
+#include <complex>
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Parameter container for PmePotentialCalculator.
+ *
+ * Maintains the parameters of the smooth particle mesh Ewald method together
+ * with flags indicating whether each of them has been set. The meaning of the
+ * parameters follows the corresponding GROMACS mdp options (fourierspacing,
+ * pme-order, rcoulomb, and ewald-rtol). No sanity checks are performed here,
+ * this is left to PmePotentialCalculator::setParameters().
+ */
+class PmeParameters
+{
+    public:
+
+        // constructor:
+        PmeParameters();
+
+        // setter methods:
+        void setGridSpacing(real gridSpacing);
+        void setSplineOrder(int splineOrder);
+        void setRealSpaceCutoff(real realSpaceCutoff);
+        void setEwaldTolerance(real ewaldTolerance);
+
+        // getter methods:
+        real gridSpacing() const;
+        bool gridSpacingIsSet() const;
+
+        int splineOrder() const;
+        bool splineOrderIsSet() const;
+
+        real realSpaceCutoff() const;
+        bool realSpaceCutoffIsSet() const;
+
+        real ewaldTolerance() const;
+        bool ewaldToleranceIsSet() const;
+
+
+    private:
+
+        real gridSpacing_;
+        bool gridSpacingIsSet_;
+
+        int splineOrder_;
+        bool splineOrderIsSet_;
+
+        real realSpaceCutoff_;
+        bool realSpaceCutoffIsSet_;
+
+        real ewaldTolerance_;
+        bool ewaldToleranceIsSet_;
+};
+
+
+/*!
+ * \brief Electrostatic potential at arbitrary points under periodic boundary
+ * conditions using the smooth particle mesh Ewald (SPME) method.
+ *
+ * This class calculates the electrostatic potential
+ *
+ * \f[
+ *      \phi(\mathbf{r}) = \frac{1}{4 \pi \epsilon_0} \sum_{\mathbf{n}} 
+ *      \sum_j \frac{q_j}{|\mathbf{r} - \mathbf{r}_j + \mathbf{n}|}
+ * \f]
+ *
+ * due to a periodic system of point charges at a set of evaluation points
+ * (such as points on the centre line of a MolecularPath). As usual, the sum
+ * is split into a short-ranged real space part
+ *
+ * \f[
+ *      \phi_{\text{dir}}(\mathbf{r}) = \sum_{|\mathbf{r} - \mathbf{r}_j| < r_c} 
+ *      q_j \frac{\text{erfc}(\beta |\mathbf{r} - \mathbf{r}_j|)}
+ *      {|\mathbf{r} - \mathbf{r}_j|}
+ * \f]
+ *
+ * which is evaluated using a cell list, and a smooth reciprocal space part
+ *
+ * \f[
+ *      \phi_{\text{rec}}(\mathbf{r}) = \frac{1}{\pi V} 
+ *      \sum_{\mathbf{m} \neq 0} 
+ *      \frac{\exp(-\pi^2 \mathbf{m}^2 / \beta^2)}{\mathbf{m}^2}
+ *      S(\mathbf{m}) \exp(-2 \pi i \mathbf{m} \cdot \mathbf{r})
+ * \f]
+ *
+ * where the structure factor \f$ S(\mathbf{m}) \f$ is approximated by 
+ * spreading the charges onto a regular grid with cardinal B-splines of order
+ * \f$ n \f$ and using a FastFourierTransform3D (Essmann et al., J. Chem. Phys.
+ * 103, 8577, 1995). The reciprocal potential on the grid is then interpolated
+ * to the evaluation points with the same B-splines. The overall cost therefore
+ * scales as \f$ O(N n^3 + K \log K + M) \f$ for \f$ N \f$ charges, \f$ K \f$ 
+ * grid points, and \f$ M \f$ evaluation points, rather than the 
+ * \f$ O(NM) \f$ of a naive Coulomb sum.
+ *
+ * The Ewald splitting coefficient \f$ \beta \f$ is chosen such that 
+ * \f$ \text{erfc}(\beta r_c) \f$ equals the Ewald tolerance, exactly as done
+ * in GROMACS. The potential is returned in units of 
+ * \f$ \text{kJ} \, \text{mol}^{-1} \, e^{-1} \f$. The 
+ * \f$ \mathbf{m} = 0 \f$ term is omitted, which corresponds to a 
+ * neutralising background for systems with a net charge and implies that the
+ * potential is defined up to an additive constant only.
+ *
+ * The simulation box is expected in the GROMACS convention, i.e. the box
+ * vectors are the rows of a lower triangular matrix.
+ */
+class PmePotentialCalculator
+{
+    public:
+
+        // constructor:
+        PmePotentialCalculator();
+
+        // setter function for parameters:
+        void setParameters(const PmeParameters &params);
+
+        // public interface for potential calculation:
+        std::vector<real> operator()(
+                const std::vector<gmx::RVec> &positions,
+                const std::vector<real> &charges,
+                const matrix box,
+                const std::vector<gmx::RVec> &evalPoints);
+
+        // getter for splitting coefficient:
+        real ewaldCoefficient() const;
+
+
+    private:
+
+        // parameters:
+        real gridSpacing_;
+        int splineOrder_;
+        real realSpaceCutoff_;
+        real ewaldTolerance_;
+        real ewaldCoef_;
+        bool parametersSet_;
+
+        // electric conversion factor in kJ mol^-1 nm e^-2:
+        const real cOneOverFourPiEpsZero_ = 138.935458;
+
+        // auxiliary functions for reciprocal space part:
+        std::vector<real> reciprocalSpacePotential(
+                const std::vector<gmx::RVec> &positions,
+                const std::vector<real> &charges,
+                const matrix box,
+                const std::vector<gmx::RVec> &evalPoints) const;
+        void splineWeights(
+                real t, 
+                std::vector<real> &weights) const;
+        std::vector<real> splineModuli(
+                size_t numGridPoints) const;
+
+        // auxiliary functions for real space part:
+        std::vector<real> realSpacePotential(
+                const std::vector<gmx::RVec> &positions,
+                const std::vector<real> &charges,
+                const matrix box,
+                const std::vector<gmx::RVec> &evalPoints) const;
+
+        // utilities:
+        real calcEwaldCoefficient(
+                real cutoff, 
+                real tolerance) const;
+        void reciprocalBox(
+                const matrix box, 
+                matrix recipBox) const;
+        inline gmx::RVec fractionalCoordinates(
+                const gmx::RVec &pos,
+                const matrix recipBox) const;
+};
+
+#endif
+
@@ -0,0 +1,133 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef FAST_FOURIER_TRANSFORM_HPP
+#define FAST_FOURIER_TRANSFORM_HPP
+
+#include <complex>
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+
+/*!
+ * Enum for the direction of a discrete Fourier transform. The forward 
+ * transform uses a negative exponent, the backward transform a positive one.
+ */
+enum eFftDirection {eFftDirectionForward, 
+                    eFftDirectionBackward};
+
+
+/*!
+ * \brief Mixed radix fast Fourier transform of a one-dimensional sequence.
+ *
+ * This class implements the discrete Fourier transform
+ *
+ * \f[
+ *      X_k = \sum_{j=0}^{N-1} x_j \exp\left( \mp 2 \pi i \frac{jk}{N} \right)
+ * \f]
+ *
+ * using a recursive decimation-in-time Cooley-Tukey algorithm. The length 
+ * \f$ N \f$ is factorised into primes upon construction and the twiddle 
+ * factors are precomputed, so that a single object can be reused to transform
+ * many sequences of the same length. The transform is not normalised, i.e.
+ * a forward transform followed by a backward transform multiplies the input
+ * by \f$ N \f$.
+ *
+ * The algorithm works for arbitrary \f$ N \f$, but is only efficient if 
+ * \f$ N \f$ has small prime factors. The convenience function fastSize() can
+ * be used to find the smallest length of the form \f$ 2^a 3^b 5^c \f$ not 
+ * smaller than a given length.
+ */
+class FastFourierTransform
+{
+    public:
+
+        // constructor:
+        FastFourierTransform(size_t n);
+
+        // public interface for transform:
+        void operator()(
+                std::vector<std::complex<real>> &data,
+                eFftDirection direction) const;
+
+        // getter functions:
+        size_t size() const;
+
+        // utilities:
+        static size_t fastSize(size_t n);
+
+
+    private:
+
+        // length and its prime factors:
+        size_t n_;
+        std::vector<size_t> factors_;
+
+        // precomputed twiddle factors for forward transform:
+        std::vector<std::complex<real>> twiddles_;
+
+        // recursive implementation of transform:
+        void transform(
+                const std::complex<real> *in,
+                std::complex<real> *out,
+                size_t n,
+                size_t stride,
+                size_t factorIdx,
+                bool forward) const;
+};
+
+
+/*!
+ * \brief Fast Fourier transform of a three-dimensional array.
+ *
+ * The transform is carried out as a sequence of one-dimensional transforms
+ * along each axis using FastFourierTransform. Data is expected in row major
+ * order, i.e. element \f$ (i, j, k) \f$ is stored at index 
+ * \f$ (i n_y + j) n_z + k \f$. As for the one-dimensional case, the transform
+ * is not normalised.
+ */
+class FastFourierTransform3D
+{
+    public:
+
+        // constructor:
+        FastFourierTransform3D(size_t nx, size_t ny, size_t nz);
+
+        // public interface for transform:
+        void operator()(
+                std::vector<std::complex<real>> &data,
+                eFftDirection direction) const;
+
+
+    private:
+
+        // one-dimensional transforms along each axis:
+        FastFourierTransform fftX_;
+        FastFourierTransform fftY_;
+        FastFourierTransform fftZ_;
+};
+
+#endif
+
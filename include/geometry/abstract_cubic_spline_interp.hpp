@@ -142,7 +142,9 @@ enum eSplineInterpDerivEstimate {eSplineInterpDerivSimple,
  * AbstractCubicSplineInterp provides the utilities for correctly assembling 
  * the system matrix and right hand side, the routines for solving the system 
  * are implemented in the derived classes CubicSplineInterp1D and 
- * CubicSplineInterp3D.
+ * CubicSplineInterp3D. Both use solveTridiagonal(), which calls the LAPACK
+ * routine matching the precision of real, so that interpolation works in both
+ * mixed and double precision builds of GROMACS.
  */
 class AbstractCubicSplineInterp
 {
@@ -170,6 +172,12 @@ class AbstractCubicSplineInterp
                          real *rhsVec,
                          eSplineInterpBoundaryCondition bc);
         std::vector<real> prepareKnotVector(std::vector<real> &x);
+        int solveTridiagonal(size_t nSys,
+                             size_t nRhs,
+                             real *subDiag,
+                             real *mainDiag,
+                             real *superDiag,
+                             real *rhs);
         real estimateEndpointDeriv(std::vector<real> &x,
                                    std::vector<real> &f,
                                    eSplineInterpEndpoint endpoint,
@@ -62,8 +62,8 @@ class AbstractSplineCurve
         int degree() const;
         int nCtrlPoints() const;
         int nKnots() const;
-        std::vector<real> knotVector() const;
-        std::vector<real> uniqueKnots() const;
+        const std::vector<real>& knotVector() const;
+        const std::vector<real>& uniqueKnots() const;
 
         // method to shift the internal coordinate system:
         void shift(const gmx::RVec &shift);
@@ -76,12 +76,14 @@ class AbstractSplineCurve
         int nCtrlPoints_;
         int nKnots_;
         std::vector<real> knots_;
+        std::vector<real> uniqueKnots_;
 
         // basis spline (derivative) functor:
         BSplineBasisSet B_;
 
         // internal utility functions:
         int findInterval(const real &evalPoint);
+        void updateUniqueKnots();
 };
 
 
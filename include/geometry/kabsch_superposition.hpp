@@ -0,0 +1,106 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef KABSCH_SUPERPOSITION_HPP
+#define KABSCH_SUPERPOSITION_HPP
+
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Rotation and translation of a structure onto a reference.
+ *
+ * A position \f$ \mathbf{x} \f$ is mapped onto 
+ * \f$ \mathbf{R}(\mathbf{x} - \mathbf{c}) + \mathbf{c}_{\text{ref}} \f$, where
+ * \f$ \mathbf{R} \f$ is a rotation matrix and \f$ \mathbf{c} \f$ and 
+ * \f$ \mathbf{c}_{\text{ref}} \f$ are the centres of the structure and the 
+ * reference. The default constructed transform is the identity.
+ */
+class RigidBodyTransform
+{
+    public:
+
+        // constructors:
+        RigidBodyTransform();
+        RigidBodyTransform(
+                const matrix rotation,
+                const gmx::RVec &centre,
+                const gmx::RVec &refCentre);
+
+        // interface for transforming positions and directions:
+        gmx::RVec apply(const gmx::RVec &pos) const;
+        gmx::RVec applyInverse(const gmx::RVec &pos) const;
+        gmx::RVec rotate(const gmx::RVec &vec) const;
+
+    private:
+
+        matrix rotation_;
+        gmx::RVec centre_;
+        gmx::RVec refCentre_;
+};
+
+
+/*!
+ * \brief Functor for the least squares superposition of a structure onto a
+ * fixed reference structure.
+ *
+ * The optimal rotation is found with the Kabsch algorithm from the singular
+ * value decomposition of the weighted \f$ 3 \times 3 \f$ covariance matrix 
+ * between structure and reference. The reference is centred and multiplied 
+ * by the weights once on construction and stored as separate coordinate 
+ * arrays. As the weighted centred reference sums to zero, the covariance 
+ * matrix does not depend on the centre of the structure, so that it can be
+ * accumulated together with this centre in a single streaming pass over the
+ * structure coordinates.
+ */
+class KabschSuperposition
+{
+    public:
+
+        // constructor:
+        KabschSuperposition(
+                const std::vector<gmx::RVec> &reference,
+                const std::vector<real> &weights);
+
+        // interface for superposition:
+        RigidBodyTransform operator()(
+                const std::vector<gmx::RVec> &positions) const;
+
+    private:
+
+        // normalised weights:
+        std::vector<real> weights_;
+
+        // weighted and centred reference coordinates:
+        std::vector<real> refX_;
+        std::vector<real> refY_;
+        std::vector<real> refZ_;
+        gmx::RVec refCentre_;
+};
+
+#endif
+
@@ -64,7 +64,7 @@ class SplineCurve1D : public AbstractSplineCurve
                 unsigned int deriv);
 
         // getter function for control points:
-        std::vector<real> ctrlPoints() const;
+        const std::vector<real>& ctrlPoints() const;
 
         // compute spline properties:
         real length() const;
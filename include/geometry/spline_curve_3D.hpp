@@ -25,6 +25,7 @@
 #ifndef SPLINE_CURVE_3D_HPP
 #define SPLINE_CURVE_3D_HPP
 
+#include <memory>
 #include <vector>
 
 #include <gtest/gtest_prod.h>   
@@ -52,6 +53,16 @@
  *
  * The method arcLengthParam() can be used to change the internal
  * representation of the curve such that it is parameterised by arc length. 
+ *
+ * If the curve is used to map many points over a long time (e.g. when all 
+ * frames of a trajectory are mapped onto the same curve), 
+ * prepareMappingGrid() can be used to precompute a voxel lookup table in a
+ * tube around the curve, which stores the spline interval and an estimate 
+ * of the arc length of the closest curve point for each voxel. Points inside
+ * this tube are then mapped by a few Newton iterations started from this 
+ * estimate rather than by a search over the entire curve. Similarly, points
+ * known to lie close to an already mapped point can be mapped by Newton 
+ * iterations started from this point's arc length.
  */
 class SplineCurve3D : public AbstractSplineCurve
 {
@@ -68,9 +79,15 @@ class SplineCurve3D : public AbstractSplineCurve
 
         // re-parameterisation methods:
         void arcLengthParam();
+        void arcLengthParam(real tolerance);
         // map points onto curve:
         double pointSqDist(gmx::RVec point, double eval);
         gmx::RVec cartesianToCurvilinear(const gmx::RVec &cartPoint);
+        gmx::RVec cartesianToCurvilinear(
+                const gmx::RVec &cartPoint, 
+                real evalHint);
+        void prepareMappingGrid(real tubeRadius, real voxelSize);
+        bool mappingGridAvailable() const;
 
         // calculate differential properties of curve:
         real length(const real &lo, const real &hi);
@@ -78,6 +95,7 @@ class SplineCurve3D : public AbstractSplineCurve
         gmx::RVec tangentVec(const real &eval);
         gmx::RVec normalVec(const real &eval);        
         real speed(const real &eval);
+        real curvature(const real &eval);
 
         // utilities for accessing arc length at the control points:
         std::vector<real> ctrlPointArcLength();
@@ -85,7 +103,7 @@ class SplineCurve3D : public AbstractSplineCurve
         real lastPointArcLength();
  
         // getter functions:
-        std::vector<gmx::RVec> ctrlPoints() const;
+        const std::vector<gmx::RVec>& ctrlPoints() const;
         
     private:
 
@@ -97,6 +115,18 @@ class SplineCurve3D : public AbstractSplineCurve
         bool arcLengthTableAvailable_;
         std::vector<real> arcLengthTable_;
 
+        // voxel lookup table for mapping:
+        // (shared between copies, as it does not change with the curve)
+        struct MappingGrid
+        {
+            gmx::RVec origin_;
+            real voxelSize_;
+            int numVoxels_[DIM];
+            std::vector<int> interval_;
+            std::vector<real> paramOffset_;
+        };
+        std::shared_ptr<const MappingGrid> mappingGrid_;
+
         // curve evaluation utilities:
         inline gmx::RVec evaluateInternal(const real &eval, unsigned int deriv);
         inline gmx::RVec evaluateExternal(const real &eval, unsigned int deriv);
@@ -110,8 +140,21 @@ class SplineCurve3D : public AbstractSplineCurve
         inline real arcLengthToParam(real &arcLength);
         inline bool arcLengthToParamTerm(real lo, real hi, real tol);
         inline real arcLengthToParamObj(real lo, real hi, real target);
+        real arcLengthStep(
+                real curvature, 
+                real curvFactor, 
+                real minStep, 
+                real maxStep);
 
         // spline mapping methods:
+        gmx::RVec cartesianToCurvilinearExact(const gmx::RVec &cartPoint);
+        bool cartesianToCurvilinearGrid(
+                const gmx::RVec &cartPoint,
+                gmx::RVec &curvPoint);
+        bool cartesianToCurvilinearNewton(
+                const gmx::RVec &cartPoint,
+                real eval,
+                gmx::RVec &curvPoint);
         unsigned int closestSplinePoint(const gmx::RVec &point);
         gmx::RVec projectionInInterval(
                 const gmx::RVec &point,
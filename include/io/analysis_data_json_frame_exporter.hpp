@@ -105,6 +105,7 @@ class AnalysisDataJsonFrameExporter : public gmx::AnalysisDataModuleSerial
         rapidjson::Document json_;
         std::string fileName_ = "stream.json";
         std::fstream file_;
+        bool frameHasPoints_ = false;
 };
 
 
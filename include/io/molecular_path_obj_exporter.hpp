@@ -47,6 +47,11 @@
  * which can be exploited to generate triangular faces. These faces can be used
  * to subsequently generate vertex normals. 
  *
+ * The geometry of the grid is shared between all scalar properties mapped 
+ * onto the surface, so that vertices and normals are stored only once and 
+ * only the vertex weights (which determine the face colours) are stored per
+ * property.
+ *
  * This is all used by MolcularPathObjExporter.
  */
 class RegularVertexGrid
@@ -60,12 +65,15 @@ class RegularVertexGrid
                 std::vector<real> s,
                 std::vector<real> phi);
 
-        // interface for adding vertices to the grid:
+        // interface for adding vertices and weights to the grid:
         void addVertex(
                 size_t i, 
                 size_t j,
+                gmx::RVec vertex);
+        void addWeight(
+                size_t i,
+                size_t j,
                 std::string p,
-                gmx::RVec vertex, 
                 real weight);
 
 
@@ -82,12 +90,8 @@ class RegularVertexGrid
         void normalsFromFaces();
     
         // getter methods:
-        std::vector<gmx::RVec> vertices(
-                std::string p);
-        std::vector<std::pair<gmx::RVec, real>> weightedVertices(
-                std::string p);
-        std::vector<gmx::RVec> normals(
-                std::string p);
+        std::vector<gmx::RVec> vertices();
+        std::vector<gmx::RVec> normals();
         std::vector<WavefrontObjFace> faces(
                 std::string p);
         ColourScale colourScale(
@@ -104,9 +108,9 @@ class RegularVertexGrid
 
         std::map<std::string, ColourScale> colourScales_;
 
-        std::map<std::tuple<size_t, size_t, std::string>, gmx::RVec> vertices_;
+        std::map<std::pair<size_t, size_t>, gmx::RVec> vertices_;
         std::map<std::tuple<size_t, size_t, std::string>, real> weights_;
-        std::map<std::tuple<size_t, size_t, std::string>, gmx::RVec> normals_;
+        std::map<std::pair<size_t, size_t>, gmx::RVec> normals_;
 
 
 
@@ -121,7 +125,8 @@ class RegularVertexGrid
  * \brief Writes the surface of a MolecularPathway to an OBJ and MTL file.
  *
  * The resulting OBJ file contains different groups of faces, each representing
- * a different scalar property mapped to the pathway surface. The colour 
+ * a different scalar property mapped to the pathway surface. All groups 
+ * reference the same list of vertices and vertex normals. The colour 
  * associated with this property is written to an MTL file, which is referenced
  * at the beginning of the OBJ file.
  */
@@ -134,6 +139,9 @@ class MolecularPathObjExporter
     FRIEND_TEST(
             MolecularPathObjExporterTest, 
             MolecularPathObjExporterAxisRotationTest);
+    FRIEND_TEST(
+            MolecularPathObjExporterTest, 
+            MolecularPathObjExporterTessellationTest);
 
 
     public:
@@ -146,6 +154,7 @@ class MolecularPathObjExporter
         void setGridSampleDist(real gridSampleDist);
         void setCorrectionThreshold(real correctionThreshold);
         void setPermitClashes(bool permitClashes);
+        void setTessellationTolerance(real tessellationTolerance);
 
         // interface for exporting:
         void operator()(
@@ -161,6 +170,28 @@ class MolecularPathObjExporter
         real extrapDist_;
         real gridSampleDist_;
         real correctionThreshold_;
+        real tessellationTolerance_;
+
+        // functions for choosing the grid resolution:
+        std::vector<real> tessellateArcLength(
+                SplineCurve3D &centreLine,
+                SplineCurve1D &radius,
+                std::pair<real, real> range);
+        void refineInterval(
+                SplineCurve3D &centreLine,
+                SplineCurve1D &radius,
+                real lo,
+                real hi,
+                int depth,
+                std::vector<real> &s);
+        real tessellationError(
+                SplineCurve3D &centreLine,
+                SplineCurve1D &radius,
+                real lo,
+                real hi);
+        size_t tessellateAngle(
+                SplineCurve1D &radius,
+                const std::vector<real> &s);
 
         // functions for generating the pathway surface grid:
         std::vector<gmx::RVec> generateNormals(
@@ -169,11 +200,13 @@ class MolecularPathObjExporter
                 SplineCurve3D &centreLine,
                 SplineCurve1D &radius,
                 std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
-                std::pair<size_t, size_t> resolution,
-                std::pair<real, real> range);
-        void generatePropertyGrid(
+                const std::vector<real> &s,
+                size_t numPhi);
+        void generateVertexGrid(
                 SplineCurve3D &centreLine,
                 SplineCurve1D &radius,
+                RegularVertexGrid &grid);
+        void generatePropertyGrid(
                 std::pair<std::string, std::pair<SplineCurve1D, bool>> property,
                 RegularVertexGrid &grid);
 
@@ -48,8 +48,9 @@ class PdbStructure
         // create PDB file from topology:
         void fromTopology(const gmx::TopologyInformation &top);
 
-        // 
+        // assign pore-lining and pore-facing to occupancy and B-factor:
         void setPoreFacing(
+                const std::vector<int> &resIds,
                 const std::vector<SummaryStatistics> &poreLining,
                 const std::vector<SummaryStatistics> &poreFacing);
 
@@ -29,7 +29,10 @@
 
 #include "external/rapidjson/document.h"
 
+#include "aggregation/dewetting_event_detector.hpp"
+#include "aggregation/time_resolved_profile_aggregator.hpp"
 #include "analysis-setup/residue_information_provider.hpp"
+#include "statistics/covariance_statistics.hpp"
 #include "statistics/summary_statistics.hpp"
 
 
@@ -69,6 +72,21 @@ class ResultsJsonExporter
         void addResidueSummary(
                 std::string name,
                 const std::vector<SummaryStatistics> &resSummary);
+        void addResidueCorrelation(
+                std::string name,
+                const std::vector<CovarianceStatistics> &resCorrelation);
+        void addDiffusionProfile(
+                const std::vector<real> &binCentres,
+                const std::vector<real> &diffCoef,
+                const std::vector<int> &numSamples);
+        void addDewettingEvents(
+                const DewettingEventDetector &detector);
+        void addTimeResolvedGridPoints(
+                const std::vector<real> &timeStamps,
+                const std::vector<real> &supportPoints);
+        void addTimeResolvedProfile(
+                std::string name,
+                const TimeResolvedProfileAggregator &profile);
 
         // interface for writing to file:
         void write(std::string filename);
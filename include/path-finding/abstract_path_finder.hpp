@@ -39,6 +39,14 @@ typedef enum {ePathFindingMethodNaiveCylindrical,
               ePathFindingMethodInplaneOptimised} ePathFindingMethod;
 
 
+/*!
+ * \brief Enum for determining whether the pathway is found anew in each frame
+ * or whether all frames use the centre line of a fixed reference pathway.
+ */
+typedef enum {ePathFindingModeFrame,
+              ePathFindingModeReference} ePathFindingMode;
+
+
 /*!
  * \brief Helper class for specifying parameters in the classes derived from
  * AbstractPathFinder.
@@ -59,6 +67,8 @@ class PathFindingParameters
         void setProbeStepLength(real probeStepLength);
         void setMaxProbeRadius(real maxProbeRadius);
         void setMaxProbeSteps(int maxProbeSteps);
+        void setHullMargin(real hullMargin);
+        void setPredictorTolerance(real predictorTolerance);
 
         // getter methods:
         real nbhCutoff() const;
@@ -73,6 +83,12 @@ class PathFindingParameters
         int maxProbeSteps() const;
         bool maxProbeStepsIsSet() const;
 
+        real hullMargin() const;
+        bool hullMarginIsSet() const;
+
+        real predictorTolerance() const;
+        bool predictorToleranceIsSet() const;
+
     private:
 
         real nbhCutoff_;
@@ -86,6 +102,12 @@ class PathFindingParameters
 
         int maxProbeSteps_;
         bool maxProbeStepsIsSet_;
+
+        real hullMargin_;
+        bool hullMarginIsSet_;
+
+        real predictorTolerance_;
+        bool predictorToleranceIsSet_;
 };
 
 
@@ -105,6 +127,9 @@ class AbstractPathFinder
         // interface for path finding method:
         virtual void findPath() = 0;
 
+        // interface for radius calculation along a fixed centre line:
+        virtual void findPathRadii(const std::vector<gmx::RVec> &pathPoints);
+
         // public interface for path retrieval:
         virtual MolecularPath getMolecularPath();
 
@@ -112,8 +137,8 @@ class AbstractPathFinder
         virtual void setParameters(const PathFindingParameters& /* &params*/);
 
         // convenience functions for retrieving path points and radii directly:
-        std::vector<gmx::RVec> pathPoints(){return path_;};
-        std::vector<real> pathRadii(){return radii_;};
+        const std::vector<gmx::RVec>& pathPoints() const {return path_;};
+        const std::vector<real>& pathRadii() const {return radii_;};
 
 
     protected:
@@ -0,0 +1,113 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef CHANNEL_AXIS_ESTIMATOR_HPP
+#define CHANNEL_AXIS_ESTIMATOR_HPP
+
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Estimates the channel direction vector and initial probe position 
+ * from the pore forming atoms in each frame.
+ *
+ * The channel direction is taken to be one of the principal axes of the pore
+ * forming atoms, i.e. one of the eigenvectors of their covariance matrix. If 
+ * the positions of a membrane group are given, the axis most closely aligned
+ * with the membrane normal (the principal axis of the membrane group with 
+ * the smallest variance) is chosen. Otherwise the axis whose variance is most
+ * distinct from the other two is chosen, as the remaining two are nearly 
+ * degenerate for the ring-like arrangement of subunits in most channels. The
+ * sign of the axis is chosen to agree with the previous estimate or, in the
+ * first frame, with the initial direction given on construction.
+ *
+ * The initial probe position is found by a coarse scan for the point of 
+ * largest free distance (i.e. distance to the nearest van der Waals surface)
+ * on a cylindrical grid around the axis through the centre of geometry of 
+ * the pore forming atoms. The grid extends by one standard deviation of the 
+ * atom positions along the axis and by half the root mean square distance of 
+ * the atoms from the axis in the radial direction, which keeps it within the
+ * protein.
+ *
+ * Both estimates are smoothed over time by exponential smoothing with the 
+ * given weight of the current frame. The probe position is smoothed relative
+ * to the centre of geometry of the pore forming atoms, so that the estimate 
+ * follows a drift of the entire group without lag.
+ */
+class ChannelAxisEstimator
+{
+    public:
+
+        // constructor:
+        ChannelAxisEstimator(
+                const gmx::RVec &initDirection,
+                bool estimateDirection,
+                real smoothingFactor);
+
+        // interface for updating estimates:
+        void update(
+                const std::vector<gmx::RVec> &porePositions,
+                const std::vector<real> &vdwRadii,
+                const std::vector<gmx::RVec> &membranePositions);
+
+        // getter methods:
+        gmx::RVec direction() const;
+        gmx::RVec initProbePos() const;
+
+        // utilities:
+        static void principalAxes(
+                const std::vector<gmx::RVec> &positions,
+                gmx::RVec &centre,
+                std::vector<real> &variances,
+                std::vector<gmx::RVec> &axes);
+
+    private:
+
+        // parameters:
+        bool estimateDirection_;
+        real smoothingFactor_;
+
+        // smoothed estimates:
+        bool isInitialised_;
+        gmx::RVec direction_;
+        gmx::RVec probeOffset_;
+        gmx::RVec centre_;
+
+        // auxiliary functions:
+        gmx::RVec estimateDirection(
+                const std::vector<real> &variances,
+                const std::vector<gmx::RVec> &axes,
+                const std::vector<gmx::RVec> &membranePositions) const;
+        gmx::RVec scanFreeDistance(
+                const std::vector<gmx::RVec> &porePositions,
+                const std::vector<real> &vdwRadii,
+                const gmx::RVec &centre,
+                const gmx::RVec &direction) const;
+};
+
+#endif
+
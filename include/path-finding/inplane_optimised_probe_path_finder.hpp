@@ -29,16 +29,46 @@
 #include <string>
 #include <vector>
 
+#include <gtest/gtest.h>
+
 #include <gromacs/trajectoryanalysis.h>
 
+#include "optim/optimisation.hpp"
 #include "path-finding/abstract_probe_path_finder.hpp"
 
 
 /*!
  * \brief Probe-based path-finder based on the HOLE algorithm.
+ *
+ * If a hull margin is set in the PathFindingParameters and the positions of 
+ * the pathway forming atoms are passed to setHullPoints(), a coarse hull is 
+ * formed from the extent of these atoms along the channel direction vector. 
+ * Once the probe has left this hull by more than the hull margin, the costly
+ * in-plane optimisation is skipped and the probe is simply advanced along 
+ * the channel direction vector, with the free distance evaluated at the
+ * unoptimised position, until one of the usual termination criteria is met.
+ *
+ * If a predictor tolerance is set in the PathFindingParameters, the probe 
+ * position in each new plane is predicted by extrapolating a quadratic fit to
+ * the most recent path points. The optimisation is then started from this 
+ * prediction with a shorter annealing schedule and a smaller initial simplex.
+ * Only if the optimum lies further than the tolerance from the prediction is
+ * the full optimisation from the straight-line position carried out. A 
+ * negative tolerance disables the prediction.
+ *
+ * Alternatively, findPathRadii() can be used to only determine the radius 
+ * profile along the support points of a fixed reference pathway.
  */
 class InplaneOptimisedProbePathFinder : public AbstractProbePathFinder
 {
+    friend class InplaneOptimisedProbePathFinderTest;
+    FRIEND_TEST(
+            InplaneOptimisedProbePathFinderTest, 
+            InplaneOptimisedProbePathFinderPredictionTest);
+    FRIEND_TEST(
+            InplaneOptimisedProbePathFinderTest, 
+            InplaneOptimisedProbePathFinderCorrectorTest);
+
     public:
 
         // constructor
@@ -54,6 +84,10 @@ class InplaneOptimisedProbePathFinder : public AbstractProbePathFinder
 
         // public interface for path finding:
         void findPath();
+        void findPathRadii(const std::vector<gmx::RVec> &pathPoints);
+
+        // coarse hull for early termination:
+        void setHullPoints(const std::vector<gmx::RVec> &hullPoints);
 
     private:
 
@@ -64,8 +98,23 @@ class InplaneOptimisedProbePathFinder : public AbstractProbePathFinder
         gmx::RVec orthVecU_;
         gmx::RVec orthVecW_;
 
+        bool useHull_;
+        real hullMargin_;
+        real hullLo_;
+        real hullHi_;
+
+        bool usePredictor_;
+        real predictorTolerance_;
+
         void optimiseInitialPos();
         void advanceAndOptimise(bool forward);
+        bool isOutsideHull(bool forward);
+        std::vector<real> predictInplanePos();
+        OptimSpacePoint predictAndOptimise(ObjectiveFunction objFun);
+        OptimSpacePoint optimiseInPlane(
+                ObjectiveFunction objFun,
+                std::vector<real> initGuess,
+                bool shortSchedule);
 
         gmx::RVec optimToConfig(std::vector<real> optimSpacePos);
 };
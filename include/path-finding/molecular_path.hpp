@@ -44,7 +44,8 @@
  * Enum for different methods for aligning molecular pathways between frames.
  */
 enum ePathAlignmentMethod {ePathAlignmentMethodNone, 
-                           ePathAlignmentMethodIpp};
+                           ePathAlignmentMethodIpp,
+                           ePathAlignmentMethodRadius};
 
 
 /*! 
@@ -100,10 +101,16 @@ class MolecularPath
         ~MolecularPath();
 
         // interface for mapping particles onto pathway:
+        gmx::RVec mapPosition(
+                const gmx::RVec &position);
+        gmx::RVec mapPosition(
+                const gmx::RVec &position,
+                real sHint);
         std::vector<gmx::RVec> mapPositions(
                 const std::vector<gmx::RVec> &positions);
         std::map<int, gmx::RVec> mapSelection(
                 const gmx::Selection &mapSel); 
+        void prepareMappingGrid(real tubeRadius, real voxelSize);
         
         // check if points lie inside pore:
         std::map<int, bool> checkIfInside(
@@ -123,12 +130,15 @@ class MolecularPath
         std::map<std::string, std::pair<SplineCurve1D, bool>> scalarProperties() const;
 
         // access original points:
-        std::vector<gmx::RVec> pathPoints();
-        std::vector<real> pathRadii();
+        const std::vector<gmx::RVec>& pathPoints() const;
+        const std::vector<real>& pathRadii() const;
+
+        // update radii while keeping centre line fixed:
+        void setPathRadii(const std::vector<real> &pathRadii);
 
         // access internal spline curves:
-        SplineCurve1D pathRadius();
-        SplineCurve3D centreLine();
+        const SplineCurve1D& pathRadius() const;
+        const SplineCurve3D& centreLine() const;
 
         // access aggregate properties of path:
         real length() const;
@@ -139,12 +149,12 @@ class MolecularPath
         real sHi();
 
         // access properties of splines
-        std::vector<real> poreRadiusKnots() const;
+        const std::vector<real>& poreRadiusKnots() const;
         std::vector<real> poreRadiusUniqueKnots() const;
-        std::vector<real> poreRadiusCtrlPoints() const;
-        std::vector<real> centreLineKnots() const;
+        const std::vector<real>& poreRadiusCtrlPoints() const;
+        const std::vector<real>& centreLineKnots() const;
         std::vector<real> centreLineUniqueKnots() const;
-        std::vector<gmx::RVec> centreLineCtrlPoints() const;
+        const std::vector<gmx::RVec>& centreLineCtrlPoints() const;
 
         // sample points from centreline:
         std::vector<real> sampleArcLength(
@@ -200,6 +210,7 @@ class MolecularPath
         // original path points and corresponding radii:
         std::vector<gmx::RVec> pathPoints_;
         std::vector<real> pathRadii_;
+        std::vector<real> pathArcLen_;
 
         // pore centre line and corresponding radius:
         SplineCurve3D centreLine_;
@@ -0,0 +1,107 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef PORE_RESIDUE_MAPPER_HPP
+#define PORE_RESIDUE_MAPPER_HPP
+
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/pbcutil/pbc.h>
+#include <gromacs/utility/real.h>
+
+#include "geometry/spline_curve_1D.hpp"
+#include "path-finding/molecular_path.hpp"
+
+
+/*!
+ * \brief Data container for a pore residue mapped onto a MolecularPath.
+ *
+ * The mapped coordinates are given as \f$ (s, \rho^2, \phi) \f$ as returned
+ * by MolecularPath::mapPosition(), i.e. the radial coordinate is squared. 
+ * If no C-alpha positions were available, mappedCal_ is zero and the residue
+ * is never pore-facing.
+ */
+struct MappedResidue
+{
+    gmx::RVec cog_;
+    gmx::RVec mappedCog_;
+    gmx::RVec mappedCal_;
+    bool poreLining_;
+    bool poreFacing_;
+    real poreRadius_;
+    real solventDensity_;
+};
+
+
+/*!
+ * \brief Functor for mapping pore-forming residues onto a pathway and 
+ * evaluating the pathway properties at each residue.
+ *
+ * Atom coordinates are passed in contiguously, grouped by residue, together
+ * with a vector of offsets such that the atoms of residue \f$ i \f$ are 
+ * found in the half-open range given by elements \f$ i \f$ and \f$ i+1 \f$
+ * of the offset vector. In a single pass over all residues, the centre of
+ * geometry (COG) of each residue is computed and mapped onto the pathway 
+ * centre line. The C-alpha position is then mapped using the arc length of 
+ * the COG as a starting point, which avoids a second search over the centre
+ * line. At the mapped arc length, the pore radius and solvent density are
+ * evaluated and the residue is classified as pore-lining if its COG lies 
+ * within the pore radius plus a margin and as pore-facing if it is 
+ * pore-lining and its COG is closer to the centre line than its C-alpha atom.
+ */
+class PoreResidueMapper
+{
+    public:
+
+        // constructor:
+        PoreResidueMapper(
+                const real margin);
+
+        // interface for mapping residues:
+        std::vector<MappedResidue> operator()(
+                const std::vector<gmx::RVec> &cogAtoms,
+                const std::vector<size_t> &cogOffsets,
+                const std::vector<gmx::RVec> &calAtoms,
+                const std::vector<size_t> &calOffsets,
+                MolecularPath &molPath,
+                SplineCurve1D &solventDensity,
+                const t_pbc *pbc);
+
+    private:
+
+        // parameters:
+        real margin_;
+
+        // centre of geometry of a residue:
+        gmx::RVec centreOfGeometry(
+                const std::vector<gmx::RVec> &atoms,
+                size_t begin,
+                size_t end,
+                const t_pbc *pbc);
+};
+
+#endif
+
@@ -0,0 +1,84 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef RADIUS_PROFILE_REGISTRATION_HPP
+#define RADIUS_PROFILE_REGISTRATION_HPP
+
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Aligns pathway radius profiles between frames by maximising their 
+ * cross-correlation with a running reference profile.
+ *
+ * Profiles are given as radii sampled at equidistant arc length values 
+ * \f$ s_i = s_{\text{lo}} + i h \f$, where the spacing \f$ h \f$ is fixed on
+ * construction. The first profile passed to update() defines the support grid
+ * of the reference, and each subsequent (aligned) profile is linearly 
+ * interpolated onto this grid and added to a running mean.
+ *
+ * The shift of a new profile is the lag that maximises the cross-correlation
+ * of the mean-free profile and reference, normalised by the number of 
+ * overlapping grid points. All lags are evaluated at once by fast Fourier 
+ * transform of the zero-padded profiles, so the cost per frame is 
+ * \f$ \mathcal{O}(n \log n) \f$ in the number of grid points. Only lags for
+ * which the profiles overlap by at least half the length of the shorter 
+ * profile are considered, and the best lag is refined to below the grid 
+ * spacing by parabolic interpolation. 
+ */
+class RadiusProfileRegistration
+{
+    public:
+
+        // constructor:
+        RadiusProfileRegistration(real resolution);
+
+        // interface for registration:
+        real operator()(
+                const std::vector<real> &profile,
+                real sLo) const;
+        void update(
+                const std::vector<real> &profile,
+                real sLo);
+
+        // getter methods:
+        bool hasReference() const;
+        real resolution() const;
+        std::vector<real> reference() const;
+
+    private:
+
+        // grid spacing:
+        real resolution_;
+
+        // running sum and count of profiles on reference grid:
+        real refLo_;
+        std::vector<real> refSum_;
+        std::vector<int> refCount_;
+};
+
+#endif
+
@@ -0,0 +1,98 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef COVARIANCE_STATISTICS_HPP
+#define COVARIANCE_STATISTICS_HPP
+
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+
+/*!
+ * \brief Collects the covariance and correlation of two scalar variables 
+ * without having to hold the dataset in memory.
+ *
+ * This is the bivariate analogue of SummaryStatistics. The means of both 
+ * variables and the sum of products of differences from the mean
+ *
+ * \f[
+ *      C_n = \sum_{i=1}^n (x_i - \bar{x}_n)(y_i - \bar{y}_n)
+ * \f]
+ *
+ * are updated incrementally using the algorithm of Welford (1962), which only
+ * requires constant memory per pair of variables. Partial statistics 
+ * accumulated over disjoint sets of samples can be combined with merge(). 
+ * Internally all quantities are accumulated in double precision.
+ *
+ * The Pearson correlation coefficient is returned as zero if fewer than two 
+ * samples are available or if either variable has zero variance. Pairs in 
+ * which either value is infinite are skipped. Statistics with fewer than two
+ * samples are left unranked by rankByCorrelation().
+ */
+class CovarianceStatistics
+{
+    public:
+
+        // constructor:
+        CovarianceStatistics();
+
+        // getter methods:
+        real meanX() const;
+        real meanY() const;
+        real cov() const;
+        real corr() const;
+        int num() const;
+
+        // updating method:
+        void update(
+                const real x, 
+                const real y);
+        static void updateMultiple(
+                std::vector<CovarianceStatistics> &stat,
+                const std::vector<real> &x,
+                const real y,
+                const std::vector<bool> &include);
+
+        // ranking by strength of correlation:
+        static std::vector<int> rankByCorrelation(
+                const std::vector<CovarianceStatistics> &stat);
+
+        // merging partial statistics:
+        void merge(
+                const CovarianceStatistics &other);
+
+    private:
+
+        // statistics updated by this class:
+        double meanX_;
+        double meanY_;
+        double sumSqX_;
+        double sumSqY_;
+        double sumXY_;
+        int num_;
+};
+
+#endif
+
@@ -57,6 +57,8 @@ class HistogramDensityEstimator : public AbstractDensityEstimator
                 HistogramDensityEstimatorDensityTest);
     FRIEND_TEST(HistogramDensityEstimatorTest,
                 HistogramDensityEstimatorEstimateTest);
+    FRIEND_TEST(HistogramDensityEstimatorTest,
+                HistogramDensityEstimatorDirectBinningTest);
 
     public:
        
@@ -42,6 +42,10 @@
  * For the minimum and maximum this is accomplished by a trivial comparison to
  * the currently stored minimum and maximum. For mean, variance, and standard
  * deviation a numerically stable algorithm due to Welford (1962) is used. 
+ * The running mean and sum of squared differences from the mean are always
+ * accumulated in double precision, as in mixed precision builds the 
+ * rounding error of the incremental update would otherwise become noticeable
+ * for long trajectories with \f$ 10^5 \f$ or more frames.
  *
  * Note that while standard deviation and variance are strictly speaking 
  * undefined for less then two data points, this class will return a value of
@@ -76,6 +80,10 @@ class SummaryStatistics
                 std::vector<SummaryStatistics> &stat,
                 const std::vector<real> &newValues);
 
+        // merging partial statistics:
+        void merge(
+                const SummaryStatistics &other);
+
         // manipulation methods:
         void shift(
                 const real shift);
@@ -85,12 +93,12 @@ class SummaryStatistics
         // summary statistics updated by this class:
         real min_;
         real max_;
-        real mean_;
-        real sumSquaredMeanDiff_;
+        double mean_;
+        double sumSquaredMeanDiff_;
         int num_;
 
         // internal auxiliary functions:
-        inline real varFromSumSquaredMeanDiff() const;
+        inline double varFromSumSquaredMeanDiff() const;
         inline real mendInfinity(real value) const;
 };
 
@@ -26,18 +26,31 @@
 #define TRAJECTORYANALYSIS_HPP
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <sys/types.h>
+
 #include <gromacs/trajectoryanalysis.h>
 
+#include "aggregation/diffusion_profile_calculator.hpp"
+
+#include "analysis-setup/molecule_unwrapper.hpp"
 #include "analysis-setup/residue_information_provider.hpp"
 
+#include "electrostatics/pme_potential_calculator.hpp"
+
+#include "geometry/kabsch_superposition.hpp"
+
+#include "io/analysis_data_json_frame_exporter.hpp"
 #include "io/pdb_io.hpp"
 
 #include "path-finding/abstract_path_finder.hpp"
+#include "path-finding/channel_axis_estimator.hpp"
 #include "path-finding/molecular_path.hpp"
+#include "path-finding/radius_profile_registration.hpp"
 #include "path-finding/vdw_radius_provider.hpp"
 
 #include "statistics/abstract_density_estimator.hpp"
@@ -45,6 +58,50 @@
 using namespace gmx;
 
 
+/*!
+ * \brief Per-channel state of the CHAP workflow.
+ *
+ * One of these is created for each pathway selection. Each channel is analysed
+ * independently and has its own pathway, per-frame data stream and output 
+ * files, while trajectory reading, topology setup and the evaluation of 
+ * solvent and pore mapping selections are shared between all channels.
+ */
+struct PoreChannel
+{
+    // pathway forming group and names of output files:
+    Selection pathwaySel_;
+    std::string outputBaseFileName_;
+    std::string outputJsonFileName_;
+    std::string outputPdbFileName_;
+
+    // initial probe position and channel direction in current frame:
+    Selection ippSel_;
+    gmx::RVec initProbePos_;
+    gmx::RVec chanDirVec_;
+    std::unique_ptr<ChannelAxisEstimator> axisEstimator_;
+
+    // periodic boundary handling and superposition onto reference:
+    std::unique_ptr<MoleculeUnwrapper> poreUnwrapper_;
+    std::unique_ptr<MoleculeUnwrapper> fitUnwrapper_;
+    std::unique_ptr<KabschSuperposition> fitSuperposition_;
+
+    // internal selections for pore mapping:
+    Selection poreMappingSelCal_;
+    Selection poreMappingSelCog_;
+    bool findPfResidues_;
+
+    // pathway alignment and fixed reference pathway:
+    std::unique_ptr<RadiusProfileRegistration> profileRegistration_;
+    std::unique_ptr<MolecularPath> refPath_;
+
+    // per-frame data and time averaged pathway:
+    AnalysisData frameStreamData_;
+    AnalysisDataJsonFrameExporterPointer frameStreamExporter_;
+    std::unique_ptr<DiffusionProfileCalculator> diffProfileCalc_;
+    std::unique_ptr<MolecularPath> molPathAvg_;
+};
+
+
 /*!
  * \brief Trajectory analysis module implementing the CHAP workflow.
  */
@@ -85,32 +142,69 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         virtual void checkParameters();
 
         
-        // names of output files:
+        // base name of output files:
         std::string outputBaseFileName_;
-        std::string outputJsonFileName_;
-        std::string outputPdbFileName_;
 
         
         // user specified selections:
         SelectionList solventSel_;
-        Selection pathwaySel_;
-        Selection ippSel_;
+        SelectionList pathwaySel_;
+        SelectionList ippSel_;
         bool ippSelIsSet_;
+        Selection membraneSel_;
+        bool membraneSelIsSet_;
+
+        // independently analysed channels, one per pathway selection:
+        std::vector<std::unique_ptr<PoreChannel>> channels_;
+        void analyzeChannel(
+                PoreChannel &channel,
+                int frnr,
+                const t_trxframe &fr,
+                t_pbc *pbc,
+                TrajectoryAnalysisModuleData *pdata);
+        void finishChannel(
+                PoreChannel &channel,
+                int numFrames);
+
+        // superposition onto reference structure:
+        bool pfFit_;
+        Selection fitSel_;
+        bool fitSelIsSet_;
 
         
         // internal selections for pore mapping:
         std::string pfSelString_;
         SelectionCollection poreMappingSelCol_;
         SelectionCollection solvMappingSelCol_;
-        Selection poreMappingSelCal_;
-        Selection poreMappingSelCog_;
         Selection solvMappingSelCog_;
         real poreMappingMargin_;
-        bool findPfResidues_;
-
-
-        // data containers:
-        AnalysisData frameStreamData_;
+        real pmGridDist_;
+        void gatherResidueAtoms(
+                const t_trxframe &fr,
+                const Selection &sel,
+                const t_pbc *pbc,
+                const gmx::RVec &centre,
+                std::vector<gmx::RVec> &atoms,
+                std::vector<size_t> &offsets) const;
+
+
+        // per-frame data stream:
+        void addSplineToFrameStream(
+                AnalysisDataHandle &dh,
+                int dataSet,
+                const SplineCurve1D &spline) const;
+
+
+        // worker pool for multi-process analysis:
+        int numProcesses_;
+        int workerRank_;
+        std::vector<pid_t> workerPids_;
+        std::string frameStreamFileName(
+                const PoreChannel &channel,
+                int rank) const;
+        void spawnWorkers();
+        void joinWorkers();
+        void mergeFrameStreams(const PoreChannel &channel);
 
 
         // pore residue chemical and physical information:
@@ -128,6 +222,7 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         real outputExtrapDist_;
         real outputGridSampleDist_;
         real outputCorrectionThreshold_;
+        real outputTessellationTolerance_;
         bool outputDetailed_;
         PdbStructure outputStructure_;
 
@@ -141,14 +236,20 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         std::string pfVdwRadiusJson_;
         bool pfVdwRadiusJsonIsSet_;
         ePathFindingMethod pfMethod_;
+        ePathFindingMode pfMode_;
+        std::string pfRefPathJson_;
+        bool pfRefPathJsonIsSet_;
         real pfProbeStepLength_;
         real pfProbeRadius_;
         real pfMaxProbeRadius_;
         int pfMaxProbeSteps_;
+        real pfHullMargin_;
+        real pfPredTol_;
         std::vector<real> pfInitProbePos_;
         bool pfInitProbePosIsSet_;
         std::vector<real> pfChanDirVec_;
         bool pfChanDirVecIsSet_;
+        real pfAutoSmooth_;
         ePathAlignmentMethod pfPathAlignmentMethod_;
         PathFindingParameters pfParams_;
         std::map<std::string, real> pfPar_;
@@ -185,10 +286,41 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         real hpEvalRangeCutoff_;
         real hpResolution_;
         DensityEstimationParameters hydrophobKernelParams_;
+
+
+        // electrostatic potential parameters:
+        Selection esSel_;
+        bool esSelIsSet_;
+        real esGridSpacing_;
+        int esSplineOrder_;
+        real esCutoff_;
+        real esEwaldTolerance_;
+        real esResolution_;
+        PmeParameters esParams_;
+
+
+        // diffusion profile parameters:
+        int diffMaxLag_;
+        real diffBinWidth_;
+
+
+        // dewetting event parameters:
+        real dewetThresholdLo_;
+        real dewetThresholdHi_;
+        real dewetMinDuration_;
+
+        // water wire parameters:
+        real wwCutoff_;
+
+
+        // time-resolved profile parameters:
+        int trWindow_;
+        int trStride_;
+        real trEmaTime_;
         
         
-        // molecular pathway for first frame:
-        std::unique_ptr<MolecularPath> molPathAvg_;
+        // fixed reference pathway:
+        void prepareRefPathMappingGrid(PoreChannel &channel);
 };
 
 #endif
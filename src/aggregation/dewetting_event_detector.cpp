@@ -0,0 +1,213 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <stdexcept>
+
+#include "aggregation/dewetting_event_detector.hpp"
+
+
+/*!
+ * Constructor sets the density thresholds for the hysteresis and the minimum
+ * duration an event needs to have to be recorded.
+ *
+ * \throws std::logic_error if the upper threshold is smaller than the lower 
+ * threshold or if the minimum duration is negative.
+ */
+DewettingEventDetector::DewettingEventDetector(
+        const real lowThreshold,
+        const real highThreshold,
+        const real minDuration)
+    : lowThreshold_(lowThreshold)
+    , highThreshold_(highThreshold)
+    , minDuration_(minDuration)
+    , isDewetted_(false)
+    , hasFrames_(false)
+    , firstTime_(0.0)
+    , lastTime_(0.0)
+    , current_()
+{
+    // sanity checks:
+    if( highThreshold_ < lowThreshold_ )
+    {
+        throw std::logic_error("Upper dewetting threshold must not be smaller "
+                               "than lower dewetting threshold.");
+    }
+    if( minDuration_ < 0.0 )
+    {
+        throw std::logic_error("Minimum duration of dewetting events must not "
+                               "be negative.");
+    }
+}
+
+
+/*!
+ * Updates the detector with the minimum solvent density in the pathway in a 
+ * new frame, the location of this minimum, and the number of solvent 
+ * particles in the pathway.
+ */
+void
+DewettingEventDetector::update(
+        const real time,
+        const real minDensity,
+        const real argMinDensity,
+        const real numPathway)
+{
+    // keep track of time range:
+    if( !hasFrames_ )
+    {
+        firstTime_ = time;
+        hasFrames_ = true;
+    }
+    lastTime_ = time;
+
+    if( !isDewetted_ )
+    {
+        // start of a new event?
+        if( minDensity < lowThreshold_ )
+        {
+            isDewetted_ = true;
+            current_.start_ = time;
+            current_.location_ = argMinDensity;
+            current_.minDensity_ = minDensity;
+            current_.minNumPathway_ = numPathway;
+        }
+    }
+    else
+    {
+        // end of current event?
+        if( minDensity > highThreshold_ )
+        {
+            closeEvent(time, true);
+            return;
+        }
+
+        // track constriction during event:
+        if( minDensity < current_.minDensity_ )
+        {
+            current_.minDensity_ = minDensity;
+            current_.location_ = argMinDensity;
+        }
+        if( numPathway < current_.minNumPathway_ )
+        {
+            current_.minNumPathway_ = numPathway;
+        }
+    }
+}
+
+
+/*!
+ * Closes an event that is still open at the end of the trajectory. Such an 
+ * event ends at the last time stamp and is flagged as incomplete.
+ */
+void
+DewettingEventDetector::finish()
+{
+    if( isDewetted_ )
+    {
+        closeEvent(lastTime_, false);
+    }
+}
+
+
+/*!
+ * Returns all recorded events in chronological order.
+ */
+const std::vector<DewettingEvent>&
+DewettingEventDetector::events() const
+{
+    return events_;
+}
+
+
+/*!
+ * Returns summary statistics of the duration of all recorded events.
+ */
+SummaryStatistics
+DewettingEventDetector::durationSummary() const
+{
+    SummaryStatistics summary;
+    for(auto &event : events_)
+    {
+        summary.update(event.duration());
+    }
+    return summary;
+}
+
+
+/*!
+ * Returns summary statistics of the constriction location of all recorded 
+ * events.
+ */
+SummaryStatistics
+DewettingEventDetector::locationSummary() const
+{
+    SummaryStatistics summary;
+    for(auto &event : events_)
+    {
+        summary.update(event.location_);
+    }
+    return summary;
+}
+
+
+/*!
+ * Returns the fraction of the time covered by the trajectory during which the
+ * pathway was dewetted according to the recorded events.
+ */
+real
+DewettingEventDetector::dewettedFraction() const
+{
+    real totalTime = lastTime_ - firstTime_;
+    if( totalTime <= 0.0 )
+    {
+        return 0.0;
+    }
+
+    real dewettedTime = 0.0;
+    for(auto &event : events_)
+    {
+        dewettedTime += event.duration();
+    }
+    return dewettedTime/totalTime;
+}
+
+
+/*!
+ * Ends the current event at the given time and records it if it lasted at 
+ * least for the minimum duration.
+ */
+void
+DewettingEventDetector::closeEvent(
+        const real time,
+        const bool isComplete)
+{
+    current_.end_ = time;
+    current_.isComplete_ = isComplete;
+    if( current_.duration() >= minDuration_ )
+    {
+        events_.push_back(current_);
+    }
+    isDewetted_ = false;
+}
+
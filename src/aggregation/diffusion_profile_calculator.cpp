@@ -0,0 +1,266 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+
+#include "aggregation/diffusion_profile_calculator.hpp"
+
+
+/*!
+ * Constructor sets the maximum lag (in frames) over which displacements are 
+ * accumulated and the width of the arc length bins.
+ *
+ * \throws std::logic_error if maximum lag or bin width are not positive.
+ */
+DiffusionProfileCalculator::DiffusionProfileCalculator(
+        const int maxLag,
+        const real binWidth)
+    : maxLag_(maxLag)
+    , binWidth_(binWidth)
+    , frameCount_(0)
+{
+    // sanity checks:
+    if( maxLag_ < 1 )
+    {
+        throw std::logic_error("Maximum lag for diffusion profile must be at "
+                               "least one frame.");
+    }
+    if( binWidth_ <= 0.0 )
+    {
+        throw std::logic_error("Bin width for diffusion profile must be "
+                               "positive.");
+    }
+}
+
+
+/*!
+ * Updates the accumulated squared displacements with the arc length 
+ * coordinates of all particles in a new frame. Particles are identified by 
+ * the keys of arcLength, which must be stable across frames (e.g. residue 
+ * IDs). A particle missing from isInsideSample is considered to be outside 
+ * the sample region.
+ */
+void
+DiffusionProfileCalculator::update(
+        const std::map<int, real> &arcLength,
+        const std::map<int, bool> &isInsideSample,
+        const real time)
+{
+    // number of buffered frames per particle:
+    const size_t bufSize = maxLag_;
+
+    // loop over all particles in this frame:
+    for(auto it = arcLength.begin(); it != arcLength.end(); it++)
+    {
+        // retrieve history of this particle:
+        ParticleHistory &hist = history_[it -> first];
+        if( hist.s_.empty() )
+        {
+            hist.s_.resize(bufSize);
+            hist.t_.resize(bufSize);
+            hist.inside_.resize(bufSize);
+            hist.head_ = 0;
+            hist.count_ = 0;
+            hist.lastFrame_ = frameCount_ - 1;
+        }
+
+        // reset history if particle was missing in previous frame:
+        if( hist.lastFrame_ != frameCount_ - 1 )
+        {
+            hist.count_ = 0;
+        }
+
+        // accumulate displacements w.r.t. all buffered frames:
+        for(size_t lag = 1; lag <= hist.count_; lag++)
+        {
+            size_t idx = (hist.head_ + bufSize - lag) % bufSize;
+
+            // only lag windows starting inside the sample contribute:
+            if( !hist.inside_[idx] )
+            {
+                continue;
+            }
+
+            std::vector<LagAccumulator> &lagAcc = acc_[binIndex(hist.s_[idx])];
+            if( lagAcc.empty() )
+            {
+                lagAcc.resize(maxLag_);
+            }
+
+            real ds = it -> second - hist.s_[idx];
+            lagAcc[lag - 1].sqDisp_.update(ds*ds);
+            lagAcc[lag - 1].lagTime_.update(time - hist.t_[idx]);
+        }
+
+        // is particle currently inside sample region?
+        auto jt = isInsideSample.find(it -> first);
+        bool inside = ( jt != isInsideSample.end() && jt -> second );
+
+        // push current position into ring buffer:
+        hist.s_[hist.head_] = it -> second;
+        hist.t_[hist.head_] = time;
+        hist.inside_[hist.head_] = inside;
+        hist.head_ = (hist.head_ + 1) % bufSize;
+        if( hist.count_ < bufSize )
+        {
+            hist.count_++;
+        }
+        hist.lastFrame_ = frameCount_;
+    }
+
+    // forget particles that were not present in this frame:
+    for(auto it = history_.begin(); it != history_.end(); )
+    {
+        if( it -> second.lastFrame_ != frameCount_ )
+        {
+            it = history_.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    // increment frame counter:
+    frameCount_++;
+}
+
+
+/*!
+ * Returns the centres of all bins in which at least one displacement has 
+ * been recorded in ascending order.
+ */
+std::vector<real>
+DiffusionProfileCalculator::binCentres() const
+{
+    std::vector<real> centres;
+    centres.reserve(acc_.size());
+    for(auto it = acc_.begin(); it != acc_.end(); it++)
+    {
+        centres.push_back( (it -> first + 0.5)*binWidth_ );
+    }
+    return centres;
+}
+
+
+/*!
+ * Returns the diffusion coefficient estimated for each bin in the same order
+ * as binCentres(). Units are length squared over time in whatever units the 
+ * arc length and time stamps were given in (i.e. nm^2/ps in CHAP).
+ */
+std::vector<real>
+DiffusionProfileCalculator::diffusionCoefficients() const
+{
+    std::vector<real> diffCoef;
+    diffCoef.reserve(acc_.size());
+    for(auto it = acc_.begin(); it != acc_.end(); it++)
+    {
+        diffCoef.push_back( fitDiffusionCoefficient(it -> second) );
+    }
+    return diffCoef;
+}
+
+
+/*!
+ * Returns the number of lag one displacements recorded in each bin in the 
+ * same order as binCentres().
+ */
+std::vector<int>
+DiffusionProfileCalculator::numSamples() const
+{
+    std::vector<int> num;
+    num.reserve(acc_.size());
+    for(auto it = acc_.begin(); it != acc_.end(); it++)
+    {
+        num.push_back( it -> second.front().sqDisp_.num() );
+    }
+    return num;
+}
+
+
+/*!
+ * Returns index of the bin containing the given arc length coordinate.
+ */
+inline int
+DiffusionProfileCalculator::binIndex(const real s) const
+{
+    return static_cast<int>(std::floor(s/binWidth_));
+}
+
+
+/*!
+ * Fits a straight line to mean squared displacement as a function of lag 
+ * time using weighted least squares and returns half its slope. Returns zero
+ * if the fit is underdetermined.
+ */
+real
+DiffusionProfileCalculator::fitDiffusionCoefficient(
+        const std::vector<LagAccumulator> &lagAcc) const
+{
+    // accumulate weighted sums over lags (in double to avoid cancellation):
+    double sumW = 0.0;
+    double sumWT = 0.0;
+    double sumWM = 0.0;
+    double sumWTT = 0.0;
+    double sumWTM = 0.0;
+    int numLags = 0;
+    for(auto it = lagAcc.begin(); it != lagAcc.end(); it++)
+    {
+        if( it -> sqDisp_.num() == 0 )
+        {
+            continue;
+        }
+        double w = it -> sqDisp_.num();
+        double t = it -> lagTime_.mean();
+        double m = it -> sqDisp_.mean();
+        sumW += w;
+        sumWT += w*t;
+        sumWM += w*m;
+        sumWTT += w*t*t;
+        sumWTM += w*t*m;
+        numLags++;
+    }
+
+    // no data available:
+    if( numLags == 0 || sumWTT <= 0.0 )
+    {
+        return 0.0;
+    }
+
+    // single lag, fit line through origin:
+    if( numLags == 1 )
+    {
+        return 0.5*sumWTM/sumWTT;
+    }
+
+    // weighted least squares slope with intercept:
+    double denom = sumW*sumWTT - sumWT*sumWT;
+    if( denom <= 0.0 )
+    {
+        return 0.0;
+    }
+    return 0.5*(sumW*sumWTM - sumWT*sumWM)/denom;
+}
+
@@ -0,0 +1,237 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+
+#include "aggregation/time_resolved_profile_aggregator.hpp"
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * Constructor sets window size and stride (both in frames) as well as the 
+ * time constant of the exponential moving average.
+ *
+ * \throws std::logic_error if any parameter is negative, if the stride is 
+ * not positive, or if both window statistics and EMA are disabled.
+ */
+TimeResolvedProfileAggregator::TimeResolvedProfileAggregator(
+        int windowSize,
+        int stride,
+        real emaTimeConstant)
+    : windowSize_(windowSize)
+    , stride_(stride)
+    , emaTimeConstant_(emaTimeConstant)
+    , windowHead_(0)
+    , numFrames_(0)
+    , lastTime_(0.0)
+{
+    // sanity checks:
+    if( windowSize_ < 0 || emaTimeConstant_ < 0.0 )
+    {
+        throw std::logic_error("Window size and EMA time constant must not "
+                               "be negative.");
+    }
+    if( stride_ <= 0 )
+    {
+        throw std::logic_error("Stride of time-resolved profile must be "
+                               "positive.");
+    }
+    if( windowSize_ == 0 && emaTimeConstant_ == 0.0 )
+    {
+        throw std::logic_error("Time-resolved profile requires a window size "
+                               "or EMA time constant.");
+    }
+
+    // allocate ring buffer:
+    window_.resize(windowSize_);
+}
+
+
+/*!
+ * Adds the profile of a new frame. Profiles must be passed in chronological
+ * order and must all have the same number of support points.
+ *
+ * \throws std::logic_error if the number of support points changes.
+ */
+void
+TimeResolvedProfileAggregator::update(
+        real time, 
+        const std::vector<real> &profile)
+{
+    // sanity check:
+    if( numFrames_ > 0 && 
+        ( (hasEma() && profile.size() != currentEma_.size()) ||
+          (hasWindow() && profile.size() != window_[0].size()) ) )
+    {
+        throw std::logic_error("Number of support points in time-resolved "
+                               "profile must not change.");
+    }
+
+    // add to ring buffer:
+    if( hasWindow() )
+    {
+        window_[windowHead_] = profile;
+        windowHead_ = (windowHead_ + 1) % windowSize_;
+    }
+
+    // update exponential moving average:
+    if( hasEma() )
+    {
+        if( numFrames_ == 0 )
+        {
+            currentEma_ = profile;
+        }
+        else
+        {
+            real alpha = 1.0 - std::exp(-(time - lastTime_)/emaTimeConstant_);
+            for(size_t i = 0; i < profile.size(); i++)
+            {
+                currentEma_[i] += alpha*(profile[i] - currentEma_[i]);
+            }
+        }
+        lastTime_ = time;
+    }
+    numFrames_++;
+
+    // only record output every stride frames once window is full:
+    if( numFrames_ < windowSize_ || numFrames_ % stride_ != 0 )
+    {
+        return;
+    }
+    timeStamps_.push_back(time);
+
+    // statistics over window:
+    if( hasWindow() )
+    {
+        std::vector<SummaryStatistics> stats(profile.size());
+        for(auto &p : window_)
+        {
+            SummaryStatistics::updateMultiple(stats, p);
+        }
+
+        std::vector<real> mean(profile.size());
+        std::vector<real> sd(profile.size());
+        for(size_t i = 0; i < stats.size(); i++)
+        {
+            mean[i] = stats[i].mean();
+            sd[i] = stats[i].sd();
+        }
+        mean_.push_back(mean);
+        sd_.push_back(sd);
+    }
+
+    // current moving average:
+    if( hasEma() )
+    {
+        ema_.push_back(currentEma_);
+    }
+}
+
+
+/*!
+ * Shifts all recorded mean and EMA profiles by a constant. This is used to
+ * apply the same reference to the time-resolved energy profile as to the 
+ * time-averaged one.
+ */
+void
+TimeResolvedProfileAggregator::shift(real shift)
+{
+    for(auto &p : mean_)
+    {
+        for(auto &v : p)
+        {
+            v += shift;
+        }
+    }
+    for(auto &p : ema_)
+    {
+        for(auto &v : p)
+        {
+            v += shift;
+        }
+    }
+}
+
+
+/*!
+ * Returns the time stamp of the last frame in each recorded window.
+ */
+const std::vector<real>&
+TimeResolvedProfileAggregator::timeStamps() const
+{
+    return timeStamps_;
+}
+
+
+/*!
+ * Returns the mean profile over each recorded window.
+ */
+const std::vector<std::vector<real>>&
+TimeResolvedProfileAggregator::mean() const
+{
+    return mean_;
+}
+
+
+/*!
+ * Returns the standard deviation profile over each recorded window.
+ */
+const std::vector<std::vector<real>>&
+TimeResolvedProfileAggregator::sd() const
+{
+    return sd_;
+}
+
+
+/*!
+ * Returns the exponential moving average profile at the end of each 
+ * recorded window.
+ */
+const std::vector<std::vector<real>>&
+TimeResolvedProfileAggregator::ema() const
+{
+    return ema_;
+}
+
+
+/*!
+ * Returns true if window statistics are calculated.
+ */
+bool
+TimeResolvedProfileAggregator::hasWindow() const
+{
+    return windowSize_ > 0;
+}
+
+
+/*!
+ * Returns true if an exponential moving average is calculated.
+ */
+bool
+TimeResolvedProfileAggregator::hasEma() const
+{
+    return emaTimeConstant_ > 0.0;
+}
+
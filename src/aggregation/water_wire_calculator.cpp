@@ -0,0 +1,303 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "aggregation/water_wire_calculator.hpp"
+
+
+/*!
+ * Constructor sets the contact distance cutoff.
+ *
+ * \throws std::logic_error if the cutoff is not positive.
+ */
+WaterWireCalculator::WaterWireCalculator(
+        const real cutoff)
+    : cutoff_(cutoff)
+{
+    if( cutoff_ <= 0.0 )
+    {
+        throw std::logic_error("Water wire contact cutoff must be positive.");
+    }
+}
+
+
+/*!
+ * Determines whether the particles at the given positions form a continuous 
+ * wire between the pore openings at sLo and sHi. The arc length coordinate of
+ * each particle needs to be given in the same order as its position.
+ *
+ * \throws std::logic_error if the number of positions and arc length 
+ * coordinates differ.
+ */
+WaterWire
+WaterWireCalculator::operator()(
+        const std::vector<gmx::RVec> &positions,
+        const std::vector<real> &arcLength,
+        const real sLo,
+        const real sHi)
+{
+    // sanity check:
+    if( positions.size() != arcLength.size() )
+    {
+        throw std::logic_error("Number of positions and arc length coordinates "
+                               "in water wire calculation must be equal.");
+    }
+
+    // find connected components of contact graph:
+    size_t numParticles = positions.size();
+    parent_.resize(numParticles);
+    size_.assign(numParticles, 1);
+    for(size_t i = 0; i < numParticles; i++)
+    {
+        parent_[i] = i;
+    }
+    connectContacts(positions);
+
+    // arc length range covered by each component and contact with openings:
+    std::vector<real> compLo(numParticles, std::numeric_limits<real>::max());
+    std::vector<real> compHi(numParticles, -std::numeric_limits<real>::max());
+    std::vector<bool> touchesLo(numParticles, false);
+    std::vector<bool> touchesHi(numParticles, false);
+    for(size_t i = 0; i < numParticles; i++)
+    {
+        size_t root = findRoot(i);
+        compLo[root] = std::min(compLo[root], arcLength[i]);
+        compHi[root] = std::max(compHi[root], arcLength[i]);
+        if( arcLength[i] - sLo < cutoff_ )
+        {
+            touchesLo[root] = true;
+        }
+        if( sHi - arcLength[i] < cutoff_ )
+        {
+            touchesHi[root] = true;
+        }
+    }
+
+    // how far into the pore can each opening be reached?
+    WaterWire wire;
+    wire.isConnected_ = false;
+    size_t wireRoot = 0;
+    real reachLo = sLo;
+    real reachHi = sHi;
+    for(size_t i = 0; i < numParticles; i++)
+    {
+        if( parent_[i] != i )
+        {
+            continue;
+        }
+        if( touchesLo[i] && touchesHi[i] )
+        {
+            wire.isConnected_ = true;
+            wireRoot = i;
+            break;
+        }
+        if( touchesLo[i] )
+        {
+            reachLo = std::max(reachLo, compHi[i]);
+        }
+        if( touchesHi[i] )
+        {
+            reachHi = std::min(reachHi, compLo[i]);
+        }
+    }
+
+    // no wire, gap is the stretch not reached from either opening:
+    if( !wire.isConnected_ )
+    {
+        wire.gapLocation_ = 0.5*(reachLo + reachHi);
+        wire.gapWidth_ = std::max(reachHi - reachLo, real(0.0));
+        return wire;
+    }
+
+    // wire exists, locate largest spacing between its particles:
+    std::vector<real> wireArcLength = {sLo, sHi};
+    for(size_t i = 0; i < numParticles; i++)
+    {
+        if( findRoot(i) == wireRoot )
+        {
+            wireArcLength.push_back(arcLength[i]);
+        }
+    }
+    std::sort(wireArcLength.begin(), wireArcLength.end());
+    real maxSpacing = -1.0;
+    for(size_t i = 1; i < wireArcLength.size(); i++)
+    {
+        real spacing = wireArcLength[i] - wireArcLength[i - 1];
+        if( spacing > maxSpacing )
+        {
+            maxSpacing = spacing;
+            wire.gapLocation_ = 0.5*(wireArcLength[i] + wireArcLength[i - 1]);
+        }
+    }
+    wire.gapWidth_ = 0.0;
+
+    return wire;
+}
+
+
+/*!
+ * Joins all pairs of particles closer than the cutoff into the same 
+ * component. Particles are sorted into a cell list with cells no smaller than
+ * the cutoff, so that contacts can only occur between particles in the same
+ * or in adjacent cells. The cell size is increased if necessary to keep the 
+ * number of cells proportional to the number of particles.
+ */
+void
+WaterWireCalculator::connectContacts(
+        const std::vector<gmx::RVec> &positions)
+{
+    size_t numParticles = positions.size();
+    if( numParticles < 2 )
+    {
+        return;
+    }
+
+    // bounding box of particles:
+    gmx::RVec boxLo = positions.front();
+    gmx::RVec boxHi = positions.front();
+    for(auto pos : positions)
+    {
+        for(int d = 0; d < DIM; d++)
+        {
+            boxLo[d] = std::min(boxLo[d], pos[d]);
+            boxHi[d] = std::max(boxHi[d], pos[d]);
+        }
+    }
+
+    // cell size and number of cells:
+    real cellSize = cutoff_;
+    real boxVolume = (boxHi[XX] - boxLo[XX] + cutoff_)*
+                     (boxHi[YY] - boxLo[YY] + cutoff_)*
+                     (boxHi[ZZ] - boxLo[ZZ] + cutoff_);
+    real maxNumCells = 8.0*numParticles;
+    if( boxVolume > maxNumCells*cellSize*cellSize*cellSize )
+    {
+        cellSize = std::cbrt(boxVolume/maxNumCells);
+    }
+    int numCells[DIM];
+    for(int d = 0; d < DIM; d++)
+    {
+        numCells[d] = static_cast<int>((boxHi[d] - boxLo[d])/cellSize) + 1;
+    }
+
+    // sort particles into cells (as linked lists):
+    std::vector<int> cellIdx(numParticles * DIM);
+    std::vector<long> head(
+            static_cast<size_t>(numCells[XX])*numCells[YY]*numCells[ZZ], -1);
+    std::vector<long> next(numParticles, -1);
+    for(size_t i = 0; i < numParticles; i++)
+    {
+        for(int d = 0; d < DIM; d++)
+        {
+            int c = static_cast<int>((positions[i][d] - boxLo[d])/cellSize);
+            cellIdx[i*DIM + d] = std::min(c, numCells[d] - 1);
+        }
+        size_t cell = (static_cast<size_t>(cellIdx[i*DIM + XX])*numCells[YY] 
+                    + cellIdx[i*DIM + YY])*numCells[ZZ] + cellIdx[i*DIM + ZZ];
+        next[i] = head[cell];
+        head[cell] = i;
+    }
+
+    // compare each particle to particles in own and neighbouring cells:
+    real cutoffSq = cutoff_*cutoff_;
+    for(size_t i = 0; i < numParticles; i++)
+    {
+        int ci = cellIdx[i*DIM + XX];
+        int cj = cellIdx[i*DIM + YY];
+        int ck = cellIdx[i*DIM + ZZ];
+        for(int di = std::max(ci - 1, 0); di <= std::min(ci + 1, numCells[XX] - 1); di++)
+        {
+            for(int dj = std::max(cj - 1, 0); dj <= std::min(cj + 1, numCells[YY] - 1); dj++)
+            {
+                for(int dk = std::max(ck - 1, 0); dk <= std::min(ck + 1, numCells[ZZ] - 1); dk++)
+                {
+                    size_t cell = (static_cast<size_t>(di)*numCells[YY] + dj)
+                                * numCells[ZZ] + dk;
+                    for(long j = head[cell]; j != -1; j = next[j])
+                    {
+                        // consider each pair only once:
+                        if( static_cast<size_t>(j) <= i )
+                        {
+                            continue;
+                        }
+
+                        gmx::RVec dist;
+                        rvec_sub(positions[i], positions[j], dist);
+                        if( iprod(dist, dist) < cutoffSq )
+                        {
+                            unite(i, j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/*!
+ * Returns the representative element of the component containing element i.
+ * Paths are halved along the way to keep the trees shallow.
+ */
+size_t
+WaterWireCalculator::findRoot(
+        size_t i)
+{
+    while( parent_[i] != i )
+    {
+        parent_[i] = parent_[parent_[i]];
+        i = parent_[i];
+    }
+    return i;
+}
+
+
+/*!
+ * Merges the components containing elements i and j, attaching the smaller 
+ * tree to the root of the larger one.
+ */
+void
+WaterWireCalculator::unite(
+        size_t i,
+        size_t j)
+{
+    size_t rootI = findRoot(i);
+    size_t rootJ = findRoot(j);
+    if( rootI == rootJ )
+    {
+        return;
+    }
+    if( size_[rootI] < size_[rootJ] )
+    {
+        std::swap(rootI, rootJ);
+    }
+    parent_[rootJ] = rootI;
+    size_[rootI] += size_[rootJ];
+}
+
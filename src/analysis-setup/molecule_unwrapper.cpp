@@ -0,0 +1,324 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <gromacs/topology/ifunc.h>
+
+#include "analysis-setup/molecule_unwrapper.hpp"
+
+
+/*!
+ * Constructor builds a spanning tree of the bond graph restricted to the 
+ * given atoms by breadth-first search. Bonds involving atoms outside the 
+ * group are ignored. Connected components are stored in order of decreasing
+ * size.
+ *
+ * \throws std::logic_error if the group contains no atoms or an atom twice.
+ */
+MoleculeUnwrapper::MoleculeUnwrapper(
+        const std::vector<int> &atomIndices,
+        const std::vector<std::pair<int, int>> &bonds)
+    : atomIndices_(atomIndices)
+    , hasReferenceCentre_(false)
+    , referenceCentre_(0.0, 0.0, 0.0)
+{
+    // sanity checks:
+    if( atomIndices_.empty() )
+    {
+        throw std::logic_error("Cannot unwrap empty group of atoms.");
+    }
+    std::unordered_map<int, size_t> localIndex;
+    for(size_t i = 0; i < atomIndices_.size(); i++)
+    {
+        if( !localIndex.insert(std::make_pair(atomIndices_[i], i)).second )
+        {
+            throw std::logic_error("Atom indices of unwrapped group must be "
+                                   "unique.");
+        }
+    }
+
+    // adjacency lists of bonds within group:
+    std::vector<std::vector<size_t>> neighbours(atomIndices_.size());
+    for(auto bond : bonds)
+    {
+        auto it = localIndex.find(bond.first);
+        auto jt = localIndex.find(bond.second);
+        if( it != localIndex.end() && jt != localIndex.end() )
+        {
+            neighbours[it -> second].push_back(jt -> second);
+            neighbours[jt -> second].push_back(it -> second);
+        }
+    }
+
+    // breadth-first search from lowest unvisited atom gives each component:
+    std::vector<bool> visited(atomIndices_.size(), false);
+    std::vector<std::vector<std::pair<size_t, int>>> components;
+    for(size_t root = 0; root < atomIndices_.size(); root++)
+    {
+        if( visited[root] )
+        {
+            continue;
+        }
+
+        std::vector<std::pair<size_t, int>> component;
+        std::queue<size_t> queue;
+        queue.push(root);
+        visited[root] = true;
+        component.push_back(std::make_pair(root, -1));
+        while( !queue.empty() )
+        {
+            size_t crnt = queue.front();
+            queue.pop();
+            for(size_t next : neighbours[crnt])
+            {
+                if( !visited[next] )
+                {
+                    visited[next] = true;
+                    queue.push(next);
+                    component.push_back(std::make_pair(next, crnt));
+                }
+            }
+        }
+        components.push_back(component);
+    }
+
+    // largest components are placed first:
+    std::stable_sort(
+            components.begin(), 
+            components.end(),
+            [](const std::vector<std::pair<size_t, int>> &a,
+               const std::vector<std::pair<size_t, int>> &b)
+            {
+                return a.size() > b.size();
+            });
+
+    // flatten into traversal order:
+    order_.reserve(atomIndices_.size());
+    parent_.reserve(atomIndices_.size());
+    componentOffsets_.push_back(0);
+    for(auto &component : components)
+    {
+        for(auto &node : component)
+        {
+            order_.push_back(node.first);
+            parent_.push_back(node.second);
+        }
+        componentOffsets_.push_back(order_.size());
+    }
+}
+
+
+/*!
+ * Extracts all chemical bonds and constraints from the interaction lists of a
+ * topology as pairs of global atom indices. Interactions involving more than
+ * two atoms (such as SETTLE) are represented as bonds between the first and
+ * each of the other atoms.
+ */
+std::vector<std::pair<int, int>>
+MoleculeUnwrapper::bondsFromTopology(
+        const t_topology &top)
+{
+    std::vector<std::pair<int, int>> bonds;
+    for(int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        // only bonds and constraints connect atoms:
+        if( !(interaction_function[ftype].flags & (IF_CHEMBOND | IF_CONSTRAINT)) )
+        {
+            continue;
+        }
+        int numAtoms = NRAL(ftype);
+        if( numAtoms < 2 )
+        {
+            continue;
+        }
+
+        // interaction list has type followed by atoms for each entry:
+        const t_ilist &il = top.idef.il[ftype];
+        for(int i = 0; i < il.nr; i += numAtoms + 1)
+        {
+            for(int j = 2; j <= numAtoms; j++)
+            {
+                bonds.push_back(
+                        std::make_pair(il.iatoms[i + 1], il.iatoms[i + j]));
+            }
+        }
+    }
+
+    return bonds;
+}
+
+
+/*!
+ * Sets the position close to which the centre of geometry of the group is 
+ * placed.
+ */
+void
+MoleculeUnwrapper::setReferenceCentre(
+        const gmx::RVec &centre)
+{
+    referenceCentre_ = centre;
+    hasReferenceCentre_ = true;
+}
+
+
+/*!
+ * Returns the coordinates of the group atoms, in the order in which their 
+ * indices were given to the constructor, with the group made whole. The 
+ * input is the coordinate array of the entire system. If no periodic 
+ * boundary condition object is given, coordinates are returned unchanged.
+ */
+std::vector<gmx::RVec>
+MoleculeUnwrapper::operator()(
+        const rvec *x,
+        const t_pbc *pbc) const
+{
+    // gather group coordinates:
+    std::vector<gmx::RVec> positions;
+    positions.reserve(atomIndices_.size());
+    for(int idx : atomIndices_)
+    {
+        positions.push_back(x[idx]);
+    }
+    if( pbc == nullptr )
+    {
+        return positions;
+    }
+
+    // make each component whole by following the spanning tree:
+    for(size_t i = 0; i < order_.size(); i++)
+    {
+        if( parent_[i] >= 0 )
+        {
+            positions[order_[i]] = nearestImage(
+                    positions[order_[i]],
+                    positions[parent_[i]],
+                    pbc);
+        }
+    }
+
+    // place components close to each other:
+    gmx::RVec sum(0.0, 0.0, 0.0);
+    for(size_t c = 0; c + 1 < componentOffsets_.size(); c++)
+    {
+        size_t begin = componentOffsets_[c];
+        size_t end = componentOffsets_[c + 1];
+
+        // centre of geometry of this component:
+        gmx::RVec cog(0.0, 0.0, 0.0);
+        for(size_t i = begin; i < end; i++)
+        {
+            rvec_inc(cog, positions[order_[i]]);
+        }
+        svmul(1.0/(end - begin), cog, cog);
+
+        // shift to image closest to components placed so far:
+        if( c > 0 )
+        {
+            gmx::RVec centre;
+            svmul(1.0/begin, sum, centre);
+            gmx::RVec shift;
+            rvec_sub(nearestImage(cog, centre, pbc), cog, shift);
+            for(size_t i = begin; i < end; i++)
+            {
+                rvec_inc(positions[order_[i]], shift);
+            }
+            rvec_inc(cog, shift);
+        }
+
+        // update weighted sum of placed positions:
+        gmx::RVec tmp;
+        svmul(end - begin, cog, tmp);
+        rvec_inc(sum, tmp);
+    }
+
+    // shift entire group to image closest to reference:
+    if( hasReferenceCentre_ )
+    {
+        gmx::RVec cog;
+        svmul(1.0/order_.size(), sum, cog);
+        gmx::RVec shift;
+        rvec_sub(nearestImage(cog, referenceCentre_, pbc), cog, shift);
+        for(auto &pos : positions)
+        {
+            rvec_inc(pos, shift);
+        }
+    }
+
+    return positions;
+}
+
+
+/*!
+ * Returns the centre of geometry of the given positions.
+ *
+ * \throws std::logic_error if no positions are given.
+ */
+gmx::RVec
+MoleculeUnwrapper::centreOfGeometry(
+        const std::vector<gmx::RVec> &positions)
+{
+    if( positions.empty() )
+    {
+        throw std::logic_error("Cannot compute centre of geometry of empty "
+                               "set of positions.");
+    }
+
+    gmx::RVec cog(0.0, 0.0, 0.0);
+    for(auto &pos : positions)
+    {
+        rvec_inc(cog, pos);
+    }
+    svmul(1.0/positions.size(), cog, cog);
+    return cog;
+}
+
+
+/*!
+ * Returns the periodic image of a position that lies closest to the given 
+ * centre. If no periodic boundary condition object is given, the position is
+ * returned unchanged.
+ */
+gmx::RVec
+MoleculeUnwrapper::nearestImage(
+        const gmx::RVec &position,
+        const gmx::RVec &centre,
+        const t_pbc *pbc)
+{
+    if( pbc == nullptr )
+    {
+        return position;
+    }
+
+    gmx::RVec dx;
+    pbc_dx_aiuc(pbc, position, centre, dx);
+    rvec_inc(dx, centre);
+    return dx;
+}
+
@@ -0,0 +1,767 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "electrostatics/pme_potential_calculator.hpp"
+#include "fourier/fast_fourier_transform.hpp"
+
+
+/*!
+ * Constructor sets all flags to false.
+ */
+PmeParameters::PmeParameters()
+    : gridSpacingIsSet_(false)
+    , splineOrderIsSet_(false)
+    , realSpaceCutoffIsSet_(false)
+    , ewaldToleranceIsSet_(false)
+{
+
+}
+
+
+/*!
+ * Sets the maximum spacing of the reciprocal space grid.
+ */
+void
+PmeParameters::setGridSpacing(real gridSpacing)
+{
+    gridSpacing_ = gridSpacing;
+    gridSpacingIsSet_ = true;
+}
+
+
+/*!
+ * Sets the order of the cardinal B-splines used for charge spreading and
+ * potential interpolation.
+ */
+void
+PmeParameters::setSplineOrder(int splineOrder)
+{
+    splineOrder_ = splineOrder;
+    splineOrderIsSet_ = true;
+}
+
+
+/*!
+ * Sets the cutoff for the real space part of the Ewald sum.
+ */
+void
+PmeParameters::setRealSpaceCutoff(real realSpaceCutoff)
+{
+    realSpaceCutoff_ = realSpaceCutoff;
+    realSpaceCutoffIsSet_ = true;
+}
+
+
+/*!
+ * Sets the relative strength of the real space potential at the cutoff, 
+ * which determines the Ewald splitting coefficient.
+ */
+void
+PmeParameters::setEwaldTolerance(real ewaldTolerance)
+{
+    ewaldTolerance_ = ewaldTolerance;
+    ewaldToleranceIsSet_ = true;
+}
+
+
+/*!
+ * Returns grid spacing.
+ */
+real
+PmeParameters::gridSpacing() const
+{
+    return gridSpacing_;
+}
+
+
+/*!
+ * Returns flag indicating whether grid spacing has been set.
+ */
+bool
+PmeParameters::gridSpacingIsSet() const
+{
+    return gridSpacingIsSet_;
+}
+
+
+/*!
+ * Returns B-spline order.
+ */
+int
+PmeParameters::splineOrder() const
+{
+    return splineOrder_;
+}
+
+
+/*!
+ * Returns flag indicating whether B-spline order has been set.
+ */
+bool
+PmeParameters::splineOrderIsSet() const
+{
+    return splineOrderIsSet_;
+}
+
+
+/*!
+ * Returns real space cutoff.
+ */
+real
+PmeParameters::realSpaceCutoff() const
+{
+    return realSpaceCutoff_;
+}
+
+
+/*!
+ * Returns flag indicating whether real space cutoff has been set.
+ */
+bool
+PmeParameters::realSpaceCutoffIsSet() const
+{
+    return realSpaceCutoffIsSet_;
+}
+
+
+/*!
+ * Returns Ewald tolerance.
+ */
+real
+PmeParameters::ewaldTolerance() const
+{
+    return ewaldTolerance_;
+}
+
+
+/*!
+ * Returns flag indicating whether Ewald tolerance has been set.
+ */
+bool
+PmeParameters::ewaldToleranceIsSet() const
+{
+    return ewaldToleranceIsSet_;
+}
+
+
+/*!
+ * Constructor.
+ */
+PmePotentialCalculator::PmePotentialCalculator()
+    : parametersSet_(false)
+{
+
+}
+
+
+/*!
+ * Sets the parameters of the SPME method and determines the Ewald splitting
+ * coefficient. Throws an exception if any parameter is missing or has an 
+ * invalid value.
+ */
+void
+PmePotentialCalculator::setParameters(const PmeParameters &params)
+{
+    // grid spacing:
+    if( !params.gridSpacingIsSet() )
+    {
+        throw std::logic_error("PME grid spacing is not set.");
+    }
+    if( params.gridSpacing() <= 0.0 )
+    {
+        throw std::logic_error("PME grid spacing must be positive.");
+    }
+    gridSpacing_ = params.gridSpacing();
+
+    // spline order:
+    if( !params.splineOrderIsSet() )
+    {
+        throw std::logic_error("PME spline order is not set.");
+    }
+    if( params.splineOrder() < 3 || params.splineOrder() > 12 )
+    {
+        throw std::logic_error("PME spline order must be between 3 and 12.");
+    }
+    splineOrder_ = params.splineOrder();
+
+    // real space cutoff:
+    if( !params.realSpaceCutoffIsSet() )
+    {
+        throw std::logic_error("PME real space cutoff is not set.");
+    }
+    if( params.realSpaceCutoff() <= 0.0 )
+    {
+        throw std::logic_error("PME real space cutoff must be positive.");
+    }
+    realSpaceCutoff_ = params.realSpaceCutoff();
+
+    // Ewald tolerance:
+    if( !params.ewaldToleranceIsSet() )
+    {
+        throw std::logic_error("Ewald tolerance is not set.");
+    }
+    if( params.ewaldTolerance() <= 0.0 || params.ewaldTolerance() >= 1.0 )
+    {
+        throw std::logic_error("Ewald tolerance must be in interval (0, 1).");
+    }
+    ewaldTolerance_ = params.ewaldTolerance();
+
+    // splitting coefficient follows from cutoff and tolerance:
+    ewaldCoef_ = calcEwaldCoefficient(realSpaceCutoff_, ewaldTolerance_);
+
+    // set parameter flag:
+    parametersSet_ = true;
+}
+
+
+/*!
+ * Returns the electrostatic potential (in kJ/mol/e) due to the given charges
+ * at each of the evaluation points.
+ */
+std::vector<real>
+PmePotentialCalculator::operator()(
+        const std::vector<gmx::RVec> &positions,
+        const std::vector<real> &charges,
+        const matrix box,
+        const std::vector<gmx::RVec> &evalPoints)
+{
+    // sanity checks:
+    if( !parametersSet_ )
+    {
+        throw std::logic_error("PME parameters have not been set.");
+    }
+    if( positions.size() != charges.size() )
+    {
+        throw std::logic_error("Number of charges does not match number of "
+                               "positions.");
+    }
+    if( box[XX][XX]*box[YY][YY]*box[ZZ][ZZ] <= 0.0 )
+    {
+        throw std::runtime_error("Electrostatic potential calculation requires "
+                                 "a valid simulation box.");
+    }
+
+    // short-ranged and long-ranged contributions:
+    std::vector<real> potential = realSpacePotential(
+            positions, 
+            charges, 
+            box, 
+            evalPoints);
+    std::vector<real> recPotential = reciprocalSpacePotential(
+            positions, 
+            charges, 
+            box, 
+            evalPoints);
+
+    // add contributions and convert units:
+    for(size_t i = 0; i < potential.size(); i++)
+    {
+        potential[i] = cOneOverFourPiEpsZero_*(potential[i] + recPotential[i]);
+    }
+
+    return potential;
+}
+
+
+/*!
+ * Returns the Ewald splitting coefficient \f$ \beta \f$ (in inverse nm).
+ */
+real
+PmePotentialCalculator::ewaldCoefficient() const
+{
+    return ewaldCoef_;
+}
+
+
+/*!
+ * Calculates the reciprocal space part of the potential. Charges are spread 
+ * onto a grid whose dimensions are the smallest lengths with prime factors 2,
+ * 3, and 5 that resolve the box vectors at the requested grid spacing. After
+ * a forward Fourier transform, the grid is multiplied with the product of the
+ * Ewald influence function and the B-spline moduli and transformed back. This
+ * yields the potential on the grid points, which is finally interpolated to
+ * the evaluation points.
+ */
+std::vector<real>
+PmePotentialCalculator::reciprocalSpacePotential(
+        const std::vector<gmx::RVec> &positions,
+        const std::vector<real> &charges,
+        const matrix box,
+        const std::vector<gmx::RVec> &evalPoints) const
+{
+    // reciprocal box and volume:
+    matrix recipBox;
+    reciprocalBox(box, recipBox);
+    real volume = box[XX][XX]*box[YY][YY]*box[ZZ][ZZ];
+
+    // determine grid dimensions:
+    int numGridPoints[DIM];
+    for(int d = 0; d < DIM; d++)
+    {
+        size_t n = std::ceil(norm(box[d]) / gridSpacing_);
+        n = std::max(n, static_cast<size_t>(2*splineOrder_));
+        numGridPoints[d] = FastFourierTransform::fastSize(n);
+    }
+    int nx = numGridPoints[XX];
+    int ny = numGridPoints[YY];
+    int nz = numGridPoints[ZZ];
+
+    // workspace for spline weights and base grid index:
+    std::vector<std::vector<real>> weights(DIM, std::vector<real>(splineOrder_));
+    int base[DIM];
+
+    // spreads one position onto grid with B-spline weights:
+    auto splineSupport = [&](const gmx::RVec &pos)
+    {
+        gmx::RVec frac = fractionalCoordinates(pos, recipBox);
+        for(int d = 0; d < DIM; d++)
+        {
+            real u = (frac[d] - std::floor(frac[d]))*numGridPoints[d];
+            int iu = static_cast<int>(std::floor(u));
+            splineWeights(u - iu, weights[d]);
+
+            // offset ensures all indices are non-negative:
+            base[d] = iu + splineOrder_*numGridPoints[d];
+        }
+    };
+
+    // spread charges onto grid:
+    std::vector<std::complex<real>> grid(nx*ny*nz, 0.0);
+    for(size_t i = 0; i < positions.size(); i++)
+    {
+        // neutral particles do not contribute:
+        if( charges[i] == 0.0 )
+        {
+            continue;
+        }
+
+        splineSupport(positions[i]);
+        for(int jx = 0; jx < splineOrder_; jx++)
+        {
+            int ix = (base[XX] - jx) % nx;
+            real qx = charges[i]*weights[XX][jx];
+            for(int jy = 0; jy < splineOrder_; jy++)
+            {
+                int iy = (base[YY] - jy) % ny;
+                real qxy = qx*weights[YY][jy];
+                for(int jz = 0; jz < splineOrder_; jz++)
+                {
+                    int iz = (base[ZZ] - jz) % nz;
+                    grid[(ix*ny + iy)*nz + iz] += qxy*weights[ZZ][jz];
+                }
+            }
+        }
+    }
+
+    // transform charge grid to reciprocal space:
+    FastFourierTransform3D fft(nx, ny, nz);
+    fft(grid, eFftDirectionForward);
+
+    // B-spline moduli along each dimension:
+    std::vector<real> modX = splineModuli(nx);
+    std::vector<real> modY = splineModuli(ny);
+    std::vector<real> modZ = splineModuli(nz);
+
+    // multiply with influence function:
+    real piSqOverBetaSq = M_PI*M_PI/(ewaldCoef_*ewaldCoef_);
+    for(int ix = 0; ix < nx; ix++)
+    {
+        int mx = (ix <= nx/2) ? ix : ix - nx;
+        for(int iy = 0; iy < ny; iy++)
+        {
+            int my = (iy <= ny/2) ? iy : iy - ny;
+            for(int iz = 0; iz < nz; iz++)
+            {
+                int mz = (iz <= nz/2) ? iz : iz - nz;
+                size_t idx = (ix*ny + iy)*nz + iz;
+
+                // omit zero wave vector:
+                if( mx == 0 && my == 0 && mz == 0 )
+                {
+                    grid[idx] = 0.0;
+                    continue;
+                }
+
+                // reciprocal lattice vector:
+                gmx::RVec m;
+                for(int d = 0; d < DIM; d++)
+                {
+                    m[d] = mx*recipBox[d][XX] + my*recipBox[d][YY] + 
+                           mz*recipBox[d][ZZ];
+                }
+                real mSq = iprod(m, m);
+
+                // scale grid point:
+                real fac = std::exp(-piSqOverBetaSq*mSq)/(M_PI*volume*mSq);
+                grid[idx] *= fac*modX[ix]*modY[iy]*modZ[iz];
+            }
+        }
+    }
+
+    // transform back to obtain potential on grid:
+    fft(grid, eFftDirectionBackward);
+
+    // interpolate potential at evaluation points:
+    std::vector<real> potential;
+    potential.reserve(evalPoints.size());
+    for(auto point : evalPoints)
+    {
+        splineSupport(point);
+        double phi = 0.0;
+        for(int jx = 0; jx < splineOrder_; jx++)
+        {
+            int ix = (base[XX] - jx) % nx;
+            for(int jy = 0; jy < splineOrder_; jy++)
+            {
+                int iy = (base[YY] - jy) % ny;
+                real wxy = weights[XX][jx]*weights[YY][jy];
+                for(int jz = 0; jz < splineOrder_; jz++)
+                {
+                    int iz = (base[ZZ] - jz) % nz;
+                    phi += wxy*weights[ZZ][jz]*grid[(ix*ny + iy)*nz + iz].real();
+                }
+            }
+        }
+        potential.push_back(phi);
+    }
+
+    return potential;
+}
+
+
+/*!
+ * Evaluates the cardinal B-spline of the requested order at the points
+ * \f$ t + j \f$ for \f$ j = 0, \dots, n - 1 \f$, where \f$ t \in [0, 1) \f$ 
+ * is the fractional part of the scaled grid coordinate. Uses the recursion
+ *
+ * \f[
+ *      M_n(x) = \frac{x}{n-1} M_{n-1}(x) + \frac{n-x}{n-1} M_{n-1}(x-1)
+ * \f]
+ *
+ * starting from the linear hat function \f$ M_2 \f$.
+ */
+void
+PmePotentialCalculator::splineWeights(
+        real t,
+        std::vector<real> &weights) const
+{
+    // linear B-spline:
+    std::fill(weights.begin(), weights.end(), 0.0);
+    weights[0] = t;
+    weights[1] = 1.0 - t;
+
+    // raise order recursively:
+    for(int k = 3; k <= splineOrder_; k++)
+    {
+        for(int j = k - 1; j >= 0; j--)
+        {
+            real x = t + j;
+            real prev = (j > 0) ? weights[j - 1] : 0.0;
+            weights[j] = (x*weights[j] + (k - x)*prev)/(k - 1);
+        }
+    }
+}
+
+
+/*!
+ * Calculates the squared moduli \f$ |b(m)|^2 \f$ of the Euler exponential 
+ * spline coefficients for a grid dimension with the given number of points.
+ * As in GROMACS, values at which the denominator (nearly) vanishes are 
+ * replaced by the average of their neighbours.
+ */
+std::vector<real>
+PmePotentialCalculator::splineModuli(
+        size_t numGridPoints) const
+{
+    // B-spline values at integer arguments:
+    std::vector<real> intWeights(splineOrder_);
+    splineWeights(0.0, intWeights);
+
+    // squared modulus of denominator:
+    std::vector<double> denomSq(numGridPoints);
+    for(size_t m = 0; m < numGridPoints; m++)
+    {
+        double re = 0.0;
+        double im = 0.0;
+        for(int k = 0; k < splineOrder_ - 1; k++)
+        {
+            double arg = 2.0*M_PI*m*k/numGridPoints;
+            re += intWeights[k + 1]*std::cos(arg);
+            im += intWeights[k + 1]*std::sin(arg);
+        }
+        denomSq[m] = re*re + im*im;
+    }
+
+    // fix vanishing denominators:
+    for(size_t m = 0; m < numGridPoints; m++)
+    {
+        if( denomSq[m] < 1e-7 )
+        {
+            size_t lo = (m + numGridPoints - 1) % numGridPoints;
+            size_t hi = (m + 1) % numGridPoints;
+            denomSq[m] = 0.5*(denomSq[lo] + denomSq[hi]);
+        }
+    }
+
+    // moduli are inverse of squared denominator:
+    std::vector<real> moduli(numGridPoints);
+    for(size_t m = 0; m < numGridPoints; m++)
+    {
+        moduli[m] = 1.0/denomSq[m];
+    }
+
+    return moduli;
+}
+
+
+/*!
+ * Calculates the real space part of the potential. Particles are sorted into
+ * a cell list in fractional coordinates, where the number of cells along each
+ * box vector is chosen such that the cutoff sphere around an evaluation point
+ * is always contained in the 27 cells surrounding it. Periodic images are 
+ * accounted for by shifting particles in wrapped-around cells by the 
+ * corresponding box vectors. Throws an exception if the cutoff is larger 
+ * than the box.
+ */
+std::vector<real>
+PmePotentialCalculator::realSpacePotential(
+        const std::vector<gmx::RVec> &positions,
+        const std::vector<real> &charges,
+        const matrix box,
+        const std::vector<gmx::RVec> &evalPoints) const
+{
+    // reciprocal box:
+    matrix recipBox;
+    reciprocalBox(box, recipBox);
+
+    // number of cells along each box vector:
+    int numCells[DIM];
+    for(int d = 0; d < DIM; d++)
+    {
+        // distance between opposite faces of box:
+        real width = 1.0/std::sqrt(
+                recipBox[XX][d]*recipBox[XX][d] + 
+                recipBox[YY][d]*recipBox[YY][d] + 
+                recipBox[ZZ][d]*recipBox[ZZ][d]);
+        numCells[d] = static_cast<int>(std::floor(width / realSpaceCutoff_));
+        if( numCells[d] < 1 )
+        {
+            throw std::runtime_error("Real space cutoff for electrostatic "
+                                     "potential exceeds size of simulation "
+                                     "box.");
+        }
+    }
+
+    // wraps position into box and finds its cell:
+    auto wrapIntoCell = [&](const gmx::RVec &pos, gmx::RVec &wrapped, int *cell)
+    {
+        gmx::RVec frac = fractionalCoordinates(pos, recipBox);
+        clear_rvec(wrapped);
+        for(int d = 0; d < DIM; d++)
+        {
+            frac[d] -= std::floor(frac[d]);
+            cell[d] = std::min(
+                    static_cast<int>(frac[d]*numCells[d]), 
+                    numCells[d] - 1);
+            for(int e = 0; e < DIM; e++)
+            {
+                wrapped[e] += frac[d]*box[d][e];
+            }
+        }
+        return (cell[XX]*numCells[YY] + cell[YY])*numCells[ZZ] + cell[ZZ];
+    };
+
+    // assign charged particles to cells:
+    std::vector<gmx::RVec> wrappedPos(positions.size());
+    std::vector<int> cellIdx(positions.size(), -1);
+    std::vector<size_t> cellStart(numCells[XX]*numCells[YY]*numCells[ZZ] + 1, 0);
+    for(size_t i = 0; i < positions.size(); i++)
+    {
+        if( charges[i] != 0.0 )
+        {
+            int cell[DIM];
+            cellIdx[i] = wrapIntoCell(positions[i], wrappedPos[i], cell);
+            cellStart[cellIdx[i] + 1]++;
+        }
+    }
+    for(size_t c = 1; c < cellStart.size(); c++)
+    {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    // sort particle indices by cell (counting sort):
+    std::vector<size_t> cellFill(cellStart.begin(), cellStart.end() - 1);
+    std::vector<size_t> sortedIdx(cellStart.back());
+    for(size_t i = 0; i < positions.size(); i++)
+    {
+        if( cellIdx[i] >= 0 )
+        {
+            sortedIdx[cellFill[cellIdx[i]]++] = i;
+        }
+    }
+
+    // loop over evaluation points:
+    real cutoffSq = realSpaceCutoff_*realSpaceCutoff_;
+    std::vector<real> potential;
+    potential.reserve(evalPoints.size());
+    for(auto point : evalPoints)
+    {
+        gmx::RVec wrappedPoint;
+        int cell[DIM];
+        wrapIntoCell(point, wrappedPoint, cell);
+
+        // loop over neighbouring cells:
+        double phi = 0.0;
+        for(int dx = -1; dx <= 1; dx++)
+        {
+            for(int dy = -1; dy <= 1; dy++)
+            {
+                for(int dz = -1; dz <= 1; dz++)
+                {
+                    // neighbour cell index and periodic shift:
+                    int nb[DIM] = {cell[XX] + dx, cell[YY] + dy, cell[ZZ] + dz};
+                    gmx::RVec shift(0.0, 0.0, 0.0);
+                    for(int d = 0; d < DIM; d++)
+                    {
+                        int wrap = static_cast<int>(
+                                std::floor(static_cast<real>(nb[d])/numCells[d]));
+                        nb[d] -= wrap*numCells[d];
+                        for(int e = 0; e < DIM; e++)
+                        {
+                            shift[e] += wrap*box[d][e];
+                        }
+                    }
+                    int c = (nb[XX]*numCells[YY] + nb[YY])*numCells[ZZ] + nb[ZZ];
+
+                    // loop over particles in this cell:
+                    for(size_t k = cellStart[c]; k < cellStart[c + 1]; k++)
+                    {
+                        size_t j = sortedIdx[k];
+                        gmx::RVec dist;
+                        rvec_add(wrappedPos[j], shift, dist);
+                        rvec_dec(dist, wrappedPoint);
+                        real distSq = iprod(dist, dist);
+
+                        // coinciding points have no well-defined potential:
+                        if( distSq < cutoffSq && distSq > 0.0 )
+                        {
+                            real r = std::sqrt(distSq);
+                            phi += charges[j]*std::erfc(ewaldCoef_*r)/r;
+                        }
+                    }
+                }
+            }
+        }
+        potential.push_back(phi);
+    }
+
+    return potential;
+}
+
+
+/*!
+ * Determines the Ewald splitting coefficient \f$ \beta \f$ such that 
+ * \f$ \text{erfc}(\beta r_c) \f$ equals the given tolerance. Uses the same
+ * bisection as GROMACS so that the result is consistent with the simulation
+ * parameters.
+ */
+real
+PmePotentialCalculator::calcEwaldCoefficient(
+        real cutoff,
+        real tolerance) const
+{
+    // find upper bound:
+    double beta = 5.0;
+    int i = 0;
+    do
+    {
+        i++;
+        beta *= 2.0;
+    } while( std::erfc(beta*cutoff) > tolerance );
+
+    // bisection:
+    int n = i + 60;
+    double lo = 0.0;
+    double hi = beta;
+    for(i = 0; i < n; i++)
+    {
+        beta = 0.5*(lo + hi);
+        if( std::erfc(beta*cutoff) > tolerance )
+        {
+            lo = beta;
+        }
+        else
+        {
+            hi = beta;
+        }
+    }
+
+    return beta;
+}
+
+
+/*!
+ * Calculates the reciprocal box for a lower triangular box matrix. The 
+ * columns of the result are the reciprocal lattice vectors.
+ */
+void
+PmePotentialCalculator::reciprocalBox(
+        const matrix box,
+        matrix recipBox) const
+{
+    real fac = 1.0/(box[XX][XX]*box[YY][YY]*box[ZZ][ZZ]);
+    recipBox[XX][XX] = box[YY][YY]*box[ZZ][ZZ]*fac;
+    recipBox[XX][YY] = 0.0;
+    recipBox[XX][ZZ] = 0.0;
+    recipBox[YY][XX] = -box[YY][XX]*box[ZZ][ZZ]*fac;
+    recipBox[YY][YY] = box[XX][XX]*box[ZZ][ZZ]*fac;
+    recipBox[YY][ZZ] = 0.0;
+    recipBox[ZZ][XX] = (box[YY][XX]*box[ZZ][YY] - box[YY][YY]*box[ZZ][XX])*fac;
+    recipBox[ZZ][YY] = -box[ZZ][YY]*box[XX][XX]*fac;
+    recipBox[ZZ][ZZ] = box[XX][XX]*box[YY][YY]*fac;
+}
+
+
+/*!
+ * Converts Cartesian coordinates to fractional coordinates with respect to 
+ * the box vectors.
+ */
+gmx::RVec
+PmePotentialCalculator::fractionalCoordinates(
+        const gmx::RVec &pos,
+        const matrix recipBox) const
+{
+    gmx::RVec frac;
+    for(int d = 0; d < DIM; d++)
+    {
+        frac[d] = pos[XX]*recipBox[XX][d] + pos[YY]*recipBox[YY][d] + 
+                  pos[ZZ]*recipBox[ZZ][d];
+    }
+    return frac;
+}
+
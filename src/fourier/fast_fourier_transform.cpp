@@ -0,0 +1,278 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "fourier/fast_fourier_transform.hpp"
+
+
+/*!
+ * Constructor factorises the transform length into primes and precomputes the
+ * twiddle factors. Throws an exception if the length is zero.
+ */
+FastFourierTransform::FastFourierTransform(size_t n)
+    : n_(n)
+{
+    // sanity check:
+    if( n_ == 0 )
+    {
+        throw std::logic_error("Length of Fourier transform must be positive.");
+    }
+
+    // factorise length, small factors first:
+    size_t rem = n_;
+    for(size_t p = 2; p*p <= rem; p++)
+    {
+        while( rem % p == 0 )
+        {
+            factors_.push_back(p);
+            rem /= p;
+        }
+    }
+    if( rem > 1 )
+    {
+        factors_.push_back(rem);
+    }
+
+    // precompute twiddle factors (in double precision for accuracy):
+    twiddles_.reserve(n_);
+    for(size_t j = 0; j < n_; j++)
+    {
+        double arg = -2.0*M_PI*j/n_;
+        twiddles_.push_back(std::complex<real>(std::cos(arg), std::sin(arg)));
+    }
+}
+
+
+/*!
+ * Transforms the input sequence in place. The length of the input must match
+ * the length given upon construction.
+ */
+void
+FastFourierTransform::operator()(
+        std::vector<std::complex<real>> &data,
+        eFftDirection direction) const
+{
+    // sanity check:
+    if( data.size() != n_ )
+    {
+        throw std::logic_error("Length of data does not match length of "
+                               "Fourier transform.");
+    }
+
+    // recursion is out-of-place, so work on a copy of the input:
+    std::vector<std::complex<real>> in = data;
+    transform(
+            in.data(), 
+            data.data(), 
+            n_, 
+            1, 
+            0, 
+            direction == eFftDirectionForward);
+}
+
+
+/*!
+ * Returns the length of sequences this object can transform.
+ */
+size_t
+FastFourierTransform::size() const
+{
+    return n_;
+}
+
+
+/*!
+ * Returns the smallest number not smaller than \p n that has no prime factors
+ * other than 2, 3, and 5. Such lengths can be transformed efficiently.
+ */
+size_t
+FastFourierTransform::fastSize(size_t n)
+{
+    // zero and one are trivial:
+    if( n <= 1 )
+    {
+        return 1;
+    }
+
+    // increment until number with only small prime factors is found:
+    for(size_t m = n; ; m++)
+    {
+        size_t rem = m;
+        for(size_t p : {2, 3, 5})
+        {
+            while( rem % p == 0 )
+            {
+                rem /= p;
+            }
+        }
+        if( rem == 1 )
+        {
+            return m;
+        }
+    }
+}
+
+
+/*!
+ * Recursive decimation-in-time step. The \p n elements of the input sequence
+ * located at multiples of \p stride are split into \p p interleaved 
+ * subsequences, where \p p is the current prime factor. Each subsequence is 
+ * transformed recursively and the results are combined into the output using
+ * the precomputed twiddle factors.
+ */
+void
+FastFourierTransform::transform(
+        const std::complex<real> *in,
+        std::complex<real> *out,
+        size_t n,
+        size_t stride,
+        size_t factorIdx,
+        bool forward) const
+{
+    // trivial transform of length one:
+    if( n == 1 )
+    {
+        out[0] = in[0];
+        return;
+    }
+
+    // split into subsequences of length m:
+    size_t p = factors_[factorIdx];
+    size_t m = n / p;
+    for(size_t q = 0; q < p; q++)
+    {
+        transform(in + q*stride, out + q*m, m, stride*p, factorIdx + 1, forward);
+    }
+
+    // spacing of twiddle factors for transform of length n:
+    size_t twiddleStep = n_ / n;
+
+    // combine transformed subsequences:
+    std::vector<std::complex<real>> tmp(p);
+    for(size_t k = 0; k < m; k++)
+    {
+        for(size_t q = 0; q < p; q++)
+        {
+            tmp[q] = out[q*m + k];
+        }
+
+        for(size_t r = 0; r < p; r++)
+        {
+            std::complex<real> sum = tmp[0];
+            for(size_t q = 1; q < p; q++)
+            {
+                std::complex<real> w = twiddles_[(q*(k + r*m) % n)*twiddleStep];
+                if( !forward )
+                {
+                    w = std::conj(w);
+                }
+                sum += w*tmp[q];
+            }
+            out[k + r*m] = sum;
+        }
+    }
+}
+
+
+/*!
+ * Constructor sets up one-dimensional transforms along each axis.
+ */
+FastFourierTransform3D::FastFourierTransform3D(
+        size_t nx, 
+        size_t ny, 
+        size_t nz)
+    : fftX_(nx)
+    , fftY_(ny)
+    , fftZ_(nz)
+{
+
+}
+
+
+/*!
+ * Transforms the three-dimensional array in place by successively 
+ * transforming all lines along the z-, y-, and x-axis.
+ */
+void
+FastFourierTransform3D::operator()(
+        std::vector<std::complex<real>> &data,
+        eFftDirection direction) const
+{
+    size_t nx = fftX_.size();
+    size_t ny = fftY_.size();
+    size_t nz = fftZ_.size();
+
+    // sanity check:
+    if( data.size() != nx*ny*nz )
+    {
+        throw std::logic_error("Size of data does not match size of Fourier "
+                               "transform.");
+    }
+
+    // transform along z-axis:
+    std::vector<std::complex<real>> line(nz);
+    for(size_t i = 0; i < nx*ny; i++)
+    {
+        std::copy(data.begin() + i*nz, data.begin() + (i + 1)*nz, line.begin());
+        fftZ_(line, direction);
+        std::copy(line.begin(), line.end(), data.begin() + i*nz);
+    }
+
+    // transform along y-axis:
+    line.resize(ny);
+    for(size_t i = 0; i < nx; i++)
+    {
+        for(size_t k = 0; k < nz; k++)
+        {
+            for(size_t j = 0; j < ny; j++)
+            {
+                line[j] = data[(i*ny + j)*nz + k];
+            }
+            fftY_(line, direction);
+            for(size_t j = 0; j < ny; j++)
+            {
+                data[(i*ny + j)*nz + k] = line[j];
+            }
+        }
+    }
+
+    // transform along x-axis:
+    line.resize(nx);
+    for(size_t j = 0; j < ny*nz; j++)
+    {
+        for(size_t i = 0; i < nx; i++)
+        {
+            line[i] = data[i*ny*nz + j];
+        }
+        fftX_(line, direction);
+        for(size_t i = 0; i < nx; i++)
+        {
+            data[i*ny*nz + j] = line[i];
+        }
+    }
+}
+
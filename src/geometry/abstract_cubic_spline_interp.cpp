@@ -24,6 +24,8 @@
 
 #include <iostream>
 
+#include <lapacke.h>
+
 #include "geometry/abstract_cubic_spline_interp.hpp"
 
 
@@ -168,6 +170,43 @@ AbstractCubicSplineInterp::assembleRhs(std::vector<real> &x,
 }
 
 
+/*!
+ * Solves the tridiagonal system defined by the given diagonals for nRhs right
+ * hand sides stored in column major order. The solution overwrites the right
+ * hand side and the diagonals are overwritten by the factorisation. Depending
+ * on whether GROMACS was compiled in double precision, either the single or 
+ * double precision LAPACK routine is called. Returns the LAPACK status code.
+ */
+int
+AbstractCubicSplineInterp::solveTridiagonal(size_t nSys,
+                                            size_t nRhs,
+                                            real *subDiag,
+                                            real *mainDiag,
+                                            real *superDiag,
+                                            real *rhs)
+{
+#if GMX_DOUBLE
+    return LAPACKE_dgtsv(LAPACK_COL_MAJOR,
+                         nSys,
+                         nRhs,
+                         subDiag,
+                         mainDiag,
+                         superDiag,
+                         rhs,
+                         nSys);
+#else
+    return LAPACKE_sgtsv(LAPACK_COL_MAJOR,
+                         nSys,
+                         nRhs,
+                         subDiag,
+                         mainDiag,
+                         superDiag,
+                         rhs,
+                         nSys);
+#endif
+}
+
+
 /*!
  * Internal helper function for creating a knot vector from a vector of input 
  * data. The knot vector is essentially a copy of the data vector with its 
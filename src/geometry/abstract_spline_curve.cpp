@@ -61,7 +61,7 @@ AbstractSplineCurve::nKnots() const
 /*!
  * Getting method for the knot vector.
  */
-std::vector<real>
+const std::vector<real>&
 AbstractSplineCurve::knotVector() const
 {
     return knots_;
@@ -70,18 +70,13 @@ AbstractSplineCurve::knotVector() const
 
 /*!
  * Getter method that returns that set of unique knots, i.e. the knot vector
- * without the repeated knots at start and end.
+ * without the repeated knots at start and end. These are cached whenever the
+ * knot vector changes, so that repeated calls do not copy.
  */
-std::vector<real>
+const std::vector<real>&
 AbstractSplineCurve::uniqueKnots() const
 {
-    // extract unique knots from knot vector:
-    std::vector<real> uniqueKnots(
-            knots_.begin() + degree_,
-            knots_.end() - degree_);
-
-    // return unique knots:
-    return uniqueKnots;
+    return uniqueKnots_;
 }
 
 
@@ -99,6 +94,7 @@ AbstractSplineCurve::shift(const gmx::RVec &shift)
     {
         *it -= shift[SS];
     }
+    updateUniqueKnots();
 }
 
 
@@ -141,3 +137,19 @@ AbstractSplineCurve::findInterval(const real &evalPoint)
     return idx;
 }
 
+
+/*!
+ * Extracts the unique knots from the knot vector into the cache returned by
+ * uniqueKnots(). Needs to be called whenever the knot vector is changed.
+ */
+void
+AbstractSplineCurve::updateUniqueKnots()
+{
+    if( knots_.size() < 2*static_cast<size_t>(degree_) )
+    {
+        uniqueKnots_.clear();
+        return;
+    }
+    uniqueKnots_.assign(knots_.begin() + degree_, knots_.end() - degree_);
+}
+
@@ -25,8 +25,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
-
-#include <lapacke.h>
+#include <vector>
 
 #include "geometry/basis_spline.hpp"
 #include "geometry/cubic_spline_interp_1D.hpp"
@@ -87,16 +86,17 @@ CubicSplineInterp1D::interpolate(std::vector<real> &x,
     size_t nSys = nDat + 2;
 
     // allocate memory for lhs matrix diagonal entries:
-    real subDiag[nSys - 1];
-    real mainDiag[nSys];
-    real superDiag[nSys - 1];
+    // (on the heap, as the system size grows with the number of data points)
+    std::vector<real> subDiag(nSys - 1);
+    std::vector<real> mainDiag(nSys);
+    std::vector<real> superDiag(nSys - 1);
 
     // assemble the matrix diagonals:
     assembleDiagonals(knotVector,
                       x,
-                      subDiag,
-                      mainDiag,
-                      superDiag,
+                      subDiag.data(),
+                      mainDiag.data(),
+                      superDiag.data(),
                       bc);
 
 
@@ -107,24 +107,22 @@ CubicSplineInterp1D::interpolate(std::vector<real> &x,
     size_t nRhs = 1;
  
     // initialise right hand side:
-    real rhsVec[nSys * nRhs];
+    std::vector<real> rhsVec(nSys * nRhs);
 
     // assemble the rhs vector:
-    assembleRhs(x, f, rhsVec, bc);
+    assembleRhs(x, f, rhsVec.data(), bc);
 
     
     // Solve System
     //-------------------------------------------------------------------------
   
     // solve tridiagonal system by Gaussian elimination:
-    int status = LAPACKE_sgtsv(LAPACK_COL_MAJOR,
-                               nSys, 
-                               nRhs,
-                               subDiag, 
-                               mainDiag, 
-                               superDiag, 
-                               rhsVec,
-                               nSys);
+    int status = solveTridiagonal(nSys, 
+                                  nRhs,
+                                  subDiag.data(), 
+                                  mainDiag.data(), 
+                                  superDiag.data(), 
+                                  rhsVec.data());
 
     // handle solver failure:
     if( status != 0 )
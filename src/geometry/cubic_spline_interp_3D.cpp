@@ -25,8 +25,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
-
-#include <lapacke.h>
+#include <vector>
 
 #include "geometry/basis_spline.hpp"
 #include "geometry/cubic_spline_interp_3D.hpp"
@@ -107,16 +106,17 @@ CubicSplineInterp3D::interpolate(std::vector<real> &param,
     size_t nSys = nDat + 2;
 
     // allocate system matrix:
-    real subDiag[nSys - 1];
-    real mainDiag[nSys];
-    real superDiag[nSys - 1];
+    // (on the heap, as the system size grows with the number of data points)
+    std::vector<real> subDiag(nSys - 1);
+    std::vector<real> mainDiag(nSys);
+    std::vector<real> superDiag(nSys - 1);
 
     // assemble the matrix diagonals:
     assembleDiagonals(knotVector,
                       param,
-                      subDiag,
-                      mainDiag,
-                      superDiag,
+                      subDiag.data(),
+                      mainDiag.data(),
+                      superDiag.data(),
                       bc);
 
 
@@ -127,15 +127,15 @@ CubicSplineInterp3D::interpolate(std::vector<real> &param,
     size_t nRhs = 3;
 
     // allocate right hand side:
-    real rhsMat[nSys * nRhs];
-    real rhsX[nSys];
-    real rhsY[nSys];
-    real rhsZ[nSys];
+    std::vector<real> rhsMat(nSys * nRhs);
+    std::vector<real> rhsX(nSys);
+    std::vector<real> rhsY(nSys);
+    std::vector<real> rhsZ(nSys);
 
     // assemble the rhs vectors:
-    assembleRhs(param, x, rhsX, bc);
-    assembleRhs(param, y, rhsY, bc);
-    assembleRhs(param, z, rhsZ, bc);
+    assembleRhs(param, x, rhsX.data(), bc);
+    assembleRhs(param, y, rhsY.data(), bc);
+    assembleRhs(param, z, rhsZ.data(), bc);
 
     // assemble rhs vectors into matrix:
     for(size_t i = 0; i < nSys; i++)
@@ -150,14 +150,12 @@ CubicSplineInterp3D::interpolate(std::vector<real> &param,
     //-------------------------------------------------------------------------
 
     // solve tridiagonal system by Gaussian elimination:
-    int status = LAPACKE_sgtsv(LAPACK_COL_MAJOR,
-                               nSys, 
-                               nRhs,
-                               subDiag, 
-                               mainDiag, 
-                               superDiag, 
-                               rhsMat,
-                               nSys);
+    int status = solveTridiagonal(nSys, 
+                                  nRhs,
+                                  subDiag.data(), 
+                                  mainDiag.data(), 
+                                  superDiag.data(), 
+                                  rhsMat.data());
 
     // handle solver failure:
     if( status != 0 )
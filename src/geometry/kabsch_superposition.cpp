@@ -0,0 +1,267 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+
+#include <lapacke.h>
+
+#include "geometry/kabsch_superposition.hpp"
+
+
+/******************************************************************************
+ * RigidBodyTransform
+ *****************************************************************************/
+
+/*!
+ * Default constructor creates the identity transform.
+ */
+RigidBodyTransform::RigidBodyTransform()
+    : centre_(0.0, 0.0, 0.0)
+    , refCentre_(0.0, 0.0, 0.0)
+{
+    clear_mat(rotation_);
+    for(int i = 0; i < DIM; i++)
+    {
+        rotation_[i][i] = 1.0;
+    }
+}
+
+
+/*!
+ * Constructs transform from rotation matrix and centres of structure and 
+ * reference.
+ */
+RigidBodyTransform::RigidBodyTransform(
+        const matrix rotation,
+        const gmx::RVec &centre,
+        const gmx::RVec &refCentre)
+    : centre_(centre)
+    , refCentre_(refCentre)
+{
+    for(int i = 0; i < DIM; i++)
+    {
+        for(int j = 0; j < DIM; j++)
+        {
+            rotation_[i][j] = rotation[i][j];
+        }
+    }
+}
+
+
+/*!
+ * Maps a position in the structure's frame onto the reference frame.
+ */
+gmx::RVec
+RigidBodyTransform::apply(const gmx::RVec &pos) const
+{
+    gmx::RVec tmp;
+    rvec_sub(pos, centre_, tmp);
+    gmx::RVec res = rotate(tmp);
+    rvec_inc(res, refCentre_);
+    return res;
+}
+
+
+/*!
+ * Maps a position in the reference frame back onto the structure's frame.
+ */
+gmx::RVec
+RigidBodyTransform::applyInverse(const gmx::RVec &pos) const
+{
+    gmx::RVec tmp;
+    rvec_sub(pos, refCentre_, tmp);
+
+    // inverse of rotation is its transpose:
+    gmx::RVec res(0.0, 0.0, 0.0);
+    for(int i = 0; i < DIM; i++)
+    {
+        for(int j = 0; j < DIM; j++)
+        {
+            res[i] += rotation_[j][i]*tmp[j];
+        }
+    }
+    rvec_inc(res, centre_);
+    return res;
+}
+
+
+/*!
+ * Rotates a direction vector from the structure's frame into the reference 
+ * frame (i.e. no translation is applied).
+ */
+gmx::RVec
+RigidBodyTransform::rotate(const gmx::RVec &vec) const
+{
+    gmx::RVec res;
+    mvmul(rotation_, vec, res);
+    return res;
+}
+
+
+/******************************************************************************
+ * KabschSuperposition
+ *****************************************************************************/
+
+/*!
+ * Constructor stores the centred reference structure. Weights (e.g. atom 
+ * masses) are normalised internally.
+ *
+ * \throws std::logic_error if the reference is empty, if the number of 
+ * weights does not match the number of positions, or if the weights do not
+ * sum to a positive value.
+ */
+KabschSuperposition::KabschSuperposition(
+        const std::vector<gmx::RVec> &reference,
+        const std::vector<real> &weights)
+    : weights_(weights)
+    , refCentre_(0.0, 0.0, 0.0)
+{
+    // sanity checks:
+    if( reference.empty() || reference.size() != weights.size() )
+    {
+        throw std::logic_error("Superposition requires a non-empty reference "
+                               "and one weight per reference position.");
+    }
+    double sumWeights = 0.0;
+    for(auto w : weights_)
+    {
+        sumWeights += w;
+    }
+    if( sumWeights <= 0.0 )
+    {
+        throw std::logic_error("Superposition weights must sum to a positive "
+                               "value.");
+    }
+
+    // normalise weights and find centre of reference:
+    for(size_t i = 0; i < reference.size(); i++)
+    {
+        weights_[i] /= sumWeights;
+        gmx::RVec tmp;
+        svmul(weights_[i], reference[i], tmp);
+        rvec_inc(refCentre_, tmp);
+    }
+
+    // store weighted and centred reference coordinates:
+    refX_.reserve(reference.size());
+    refY_.reserve(reference.size());
+    refZ_.reserve(reference.size());
+    for(size_t i = 0; i < reference.size(); i++)
+    {
+        refX_.push_back(weights_[i]*(reference[i][XX] - refCentre_[XX]));
+        refY_.push_back(weights_[i]*(reference[i][YY] - refCentre_[YY]));
+        refZ_.push_back(weights_[i]*(reference[i][ZZ] - refCentre_[ZZ]));
+    }
+}
+
+
+/*!
+ * Returns the rigid body transform that superimposes the given positions 
+ * onto the reference in the weighted least squares sense. Positions must be 
+ * given in the same order as the reference.
+ *
+ * \throws std::logic_error if the number of positions does not match the 
+ * reference.
+ * \throws std::runtime_error if the singular value decomposition fails.
+ */
+RigidBodyTransform
+KabschSuperposition::operator()(
+        const std::vector<gmx::RVec> &positions) const
+{
+    // sanity check:
+    if( positions.size() != weights_.size() )
+    {
+        throw std::logic_error("Number of positions in superposition must "
+                               "match reference.");
+    }
+
+    // accumulate centre and covariance in one pass:
+    double cx = 0.0, cy = 0.0, cz = 0.0;
+    double hxx = 0.0, hxy = 0.0, hxz = 0.0;
+    double hyx = 0.0, hyy = 0.0, hyz = 0.0;
+    double hzx = 0.0, hzy = 0.0, hzz = 0.0;
+    size_t numPositions = positions.size();
+    for(size_t i = 0; i < numPositions; i++)
+    {
+        const real x = positions[i][XX];
+        const real y = positions[i][YY];
+        const real z = positions[i][ZZ];
+        cx += weights_[i]*x;
+        cy += weights_[i]*y;
+        cz += weights_[i]*z;
+        hxx += x*refX_[i];
+        hxy += x*refY_[i];
+        hxz += x*refZ_[i];
+        hyx += y*refX_[i];
+        hyy += y*refY_[i];
+        hyz += y*refZ_[i];
+        hzx += z*refX_[i];
+        hzy += z*refY_[i];
+        hzz += z*refZ_[i];
+    }
+
+    // singular value decomposition of covariance (column major):
+    double cov[9] = {hxx, hyx, hzx, hxy, hyy, hzy, hxz, hyz, hzz};
+    double sv[3];
+    double u[9];
+    double vt[9];
+    double superb[2];
+    int info = LAPACKE_dgesvd(
+            LAPACK_COL_MAJOR, 'A', 'A', 3, 3, cov, 3, sv, u, 3, vt, 3, superb);
+    if( info != 0 )
+    {
+        throw std::runtime_error("Singular value decomposition failed in "
+                                 "structure superposition.");
+    }
+
+    // correct for reflection:
+    // (U and V are orthogonal, so the sign of det(V U^T) is that of the 
+    // product of their determinants)
+    double detU = u[0]*(u[4]*u[8] - u[7]*u[5]) 
+                - u[3]*(u[1]*u[8] - u[7]*u[2]) 
+                + u[6]*(u[1]*u[5] - u[4]*u[2]);
+    double detVt = vt[0]*(vt[4]*vt[8] - vt[7]*vt[5]) 
+                 - vt[3]*(vt[1]*vt[8] - vt[7]*vt[2]) 
+                 + vt[6]*(vt[1]*vt[5] - vt[4]*vt[2]);
+    double d[3] = {1.0, 1.0, (detU*detVt < 0.0) ? -1.0 : 1.0};
+
+    // optimal rotation R = V D U^T:
+    matrix rotation;
+    for(int i = 0; i < DIM; i++)
+    {
+        for(int j = 0; j < DIM; j++)
+        {
+            double r = 0.0;
+            for(int k = 0; k < DIM; k++)
+            {
+                r += vt[k + 3*i]*d[k]*u[j + 3*k];
+            }
+            rotation[i][j] = r;
+        }
+    }
+
+    return RigidBodyTransform(rotation, gmx::RVec(cx, cy, cz), refCentre_);
+}
+
@@ -66,6 +66,7 @@ SplineCurve1D::SplineCurve1D(int degree,
     // assign knot vector and control points:
     knots_ = knotVector;
     ctrlPoints_ = ctrlPoints;
+    updateUniqueKnots();
 }
 
 
@@ -202,7 +203,7 @@ SplineCurve1D::computeLinearCombination(const SparseBasis &basis)
 /*!
  * Getter function for access to the spline curves control points.
  */
-std::vector<real>
+const std::vector<real>&
 SplineCurve1D::ctrlPoints() const
 {
     return ctrlPoints_;
@@ -23,7 +23,9 @@
 
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <stdexcept>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
@@ -75,6 +77,7 @@ SplineCurve3D::SplineCurve3D(
     // assign knot vector and control points:
     knots_ = knotVector;
     ctrlPoints_ = ctrlPoints;
+    updateUniqueKnots();
 }
 
 
@@ -214,37 +217,113 @@ SplineCurve3D::computeLinearCombination(const SparseBasis &basis)
 
 /*!
  * Change the internal representation of the curve such that it is 
- * parameterised in terms of arc length.
+ * parameterised in terms of arc length. Uses a tolerance of 1e-4 on the 
+ * deviation of the curve's speed from unity (see arcLengthParam(real)).
  */
 void
 SplineCurve3D::arcLengthParam()
 {
-    // number of uniformly spaced arc length parameters:
-    int nNew = 10*nCtrlPoints_;
+    arcLengthParam(1e-4);
+}
+
+
+/*!
+ * Change the internal representation of the curve such that it is 
+ * parameterised in terms of arc length. The curve is resampled at points that
+ * are spaced adaptively along its arc and these points are interpolated with
+ * their arc length as parameter.
+ *
+ * Where the curve has curvature \f$ \kappa \f$, the chord between two sample
+ * points a distance \f$ h \f$ apart along the arc is shorter than the arc by 
+ * a relative amount of approximately \f$ \kappa^2 h^2 / 24 \f$, which bounds
+ * the deviation of the new curve's speed from unity. The spacing is chosen 
+ * such that this does not exceed the given tolerance for the largest 
+ * curvature found at the start, middle, and end of each step. It is never
+ * larger than the mean spacing of the current knots, so that no features of 
+ * the curve are lost, and never smaller than a tenth of it. Straight curves 
+ * therefore need few knots, which makes later mapping onto the curve cheaper.
+ * Close to the endpoints, where the interpolation relies on an estimate of
+ * the derivative from the first and last few points, the finest spacing is
+ * always used.
+ *
+ * \throws std::logic_error if the tolerance is not positive.
+ */
+void
+SplineCurve3D::arcLengthParam(real tolerance)
+{
+    // sanity check:
+    if( tolerance <= 0.0 )
+    {
+        throw std::logic_error("Tolerance for arc length parameterisation "
+                               "must be positive.");
+    }
 
     // create lookup table for arc length at knots:
     prepareArcLengthTable();
-   
-    // determine uniform arc length spacing:
-    real arcLenStep = arcLengthTable_.back() / (nNew - 1);
+    real totalLength = arcLengthTable_.back();
+
+    // bounds on arc length spacing:
+    real maxStep = totalLength / (uniqueKnots().size() - 1);
+    real minStep = std::min(totalLength / (10*nCtrlPoints_ - 1), maxStep);
+    real curvFactor = std::sqrt(24.0*tolerance);
+    real endLength = 3.0*minStep;
 
     // initialise new control points and parameters:
     std::vector<real> newParams;
     std::vector<gmx::RVec> newPoints;
 
-
-    // loop over uniformly spaced arc length intervals:
-    for(int i = 0; i < nNew; i++)
+    // march along curve with curvature dependent step size:
+    real newParam = 0.0;
+    real oldParam = knots_.front();
+    while( true )
     {
-        // calculate target arc length:
-        real newParam = i*arcLenStep;
+        // evaluate spline to get new point:
         newParams.push_back(newParam);
+        newPoints.push_back(this -> evaluate(oldParam, 0));
+        if( newParam >= totalLength )
+        {
+            break;
+        }
 
-        // find parameter value corresponding to arc length value:
-        real oldParam = arcLengthToParam(newParam); 
+        // step size from curvature at current point:
+        real kappa = curvature(oldParam);
+        real step = arcLengthStep(kappa, curvFactor, minStep, maxStep);
 
-        //  evaluate spline to get new point:
-        newPoints.push_back(this -> evaluate(oldParam, 0));
+        // make sure curvature does not increase much over step:
+        real midParam = std::min<real>(newParam + 0.5*step, totalLength);
+        real endParam = std::min<real>(newParam + step, totalLength);
+        kappa = std::max(kappa, curvature(arcLengthToParam(midParam)));
+        kappa = std::max(kappa, curvature(arcLengthToParam(endParam)));
+        step = arcLengthStep(kappa, curvFactor, minStep, maxStep);
+
+        // use finest spacing near endpoints where derivative is estimated:
+        real distToEndRegion = totalLength - endLength - newParam;
+        if( newParam < endLength || distToEndRegion <= minStep )
+        {
+            step = minStep;
+        }
+        else
+        {
+            step = std::min(step, distToEndRegion);
+        }
+
+        // advance, avoiding a very short last interval:
+        real remaining = totalLength - newParam;
+        if( remaining <= step )
+        {
+            newParam = totalLength;
+        }
+        else if( remaining - step < minStep )
+        {
+            newParam += 0.5*remaining;
+        }
+        else
+        {
+            newParam += step;
+        }
+
+        // find parameter value corresponding to arc length value:
+        oldParam = arcLengthToParam(newParam);
     }
 
     // interpolate new points to get arc length parameterised curve:
@@ -259,9 +338,11 @@ SplineCurve3D::arcLengthParam()
     this -> nKnots_ = newSpl.nKnots_;
     this -> nCtrlPoints_ = newSpl.nCtrlPoints_;
     this -> arcLengthTableAvailable_ = false;
+    updateUniqueKnots();
 
-    // reset reference points for mapping:
+    // reset reference points and lookup grid for mapping:
     refPoints_.clear();
+    mappingGrid_.reset();
 }
 
 
@@ -342,6 +423,27 @@ SplineCurve3D::normalVec(const real &eval)
 }
 
 
+/*!
+ * Returns the curvature of the curve at the given evaluation point, i.e.
+ *
+ * \f[
+ *      \kappa = \frac{|\mathbf{S}' \times \mathbf{S}''|}{|\mathbf{S}'|^3}
+ * \f]
+ *
+ * which does not depend on the parameterisation of the curve.
+ */
+real
+SplineCurve3D::curvature(const real &eval)
+{
+    gmx::RVec tangent = evaluate(eval, 1);
+    gmx::RVec normal = evaluate(eval, 2);
+    gmx::RVec cross;
+    cprod(tangent, normal, cross);
+    real speed = norm(tangent);
+    return norm(cross)/(speed*speed*speed);
+}
+
+
 /*!
  * Returns the speed of the curve at the given evaluation point, where speed
  * refers to the magnitude of the tangent vector.
@@ -370,6 +472,249 @@ SplineCurve3D::speed(const real &eval)
  */
 gmx::RVec 
 SplineCurve3D::cartesianToCurvilinear(const gmx::RVec &cartPoint)
+{
+    // use lookup grid if available and point lies inside it:
+    gmx::RVec curvPoint;
+    if( mappingGrid_ && cartesianToCurvilinearGrid(cartPoint, curvPoint) )
+    {
+        return curvPoint;
+    }
+
+    // otherwise search the entire curve:
+    return cartesianToCurvilinearExact(cartPoint);
+}
+
+
+/*!
+ * Maps a point onto the curve using an estimate of the curve parameter of its
+ * closest curve point, e.g. that of a nearby point that has already been 
+ * mapped. The estimate is refined by Newton iterations, so that no search over
+ * the curve is required. If the iteration fails, the point is mapped as usual.
+ * Note that for points far from the estimate, the iteration may converge to a 
+ * local rather than the global distance minimum.
+ */
+gmx::RVec
+SplineCurve3D::cartesianToCurvilinear(
+        const gmx::RVec &cartPoint,
+        real evalHint)
+{
+    // refine estimate if possible:
+    gmx::RVec curvPoint;
+    if( cartesianToCurvilinearNewton(cartPoint, evalHint, curvPoint) )
+    {
+        return curvPoint;
+    }
+
+    // otherwise use grid or exhaustive search:
+    return cartesianToCurvilinear(cartPoint);
+}
+
+
+/*!
+ * Precomputes a voxel lookup table for cartesianToCurvilinear(). The grid 
+ * covers the bounding box of the curve (between its first and last knot) 
+ * plus the tube radius. For each voxel whose centre lies within the tube 
+ * radius of the curve, the spline interval containing the closest curve point
+ * to the voxel centre and the offset of this point from the start of the 
+ * interval are stored. Both are invariant under shift() of the curve 
+ * parameter. The table is discarded by arcLengthParam(), so this should be 
+ * called after the curve has been parameterised by arc length.
+ */
+void
+SplineCurve3D::prepareMappingGrid(real tubeRadius, real voxelSize)
+{
+    // sanity checks:
+    if( tubeRadius <= 0.0 || voxelSize <= 0.0 )
+    {
+        throw std::logic_error("Tube radius and voxel size of mapping grid "
+                               "must be positive.");
+    }
+
+    // bounding box of curve sampled at voxel resolution:
+    real lo = knots_.front();
+    real hi = knots_.back();
+    int numSample = std::ceil(2.0*length(lo, hi)/voxelSize) + 1;
+    gmx::RVec boxLo = evaluate(lo, 0);
+    gmx::RVec boxHi = boxLo;
+    for(int i = 1; i < numSample; i++)
+    {
+        gmx::RVec point = evaluate(lo + i*(hi - lo)/(numSample - 1), 0);
+        for(int j = 0; j < DIM; j++)
+        {
+            boxLo[j] = std::min(boxLo[j], point[j]);
+            boxHi[j] = std::max(boxHi[j], point[j]);
+        }
+    }
+
+    // set up grid dimensions:
+    std::shared_ptr<MappingGrid> grid(new MappingGrid());
+    grid -> voxelSize_ = voxelSize;
+    size_t numTotal = 1;
+    for(int j = 0; j < DIM; j++)
+    {
+        grid -> origin_[j] = boxLo[j] - tubeRadius;
+        grid -> numVoxels_[j] = std::ceil(
+                (boxHi[j] - boxLo[j] + 2.0*tubeRadius)/voxelSize);
+        numTotal *= grid -> numVoxels_[j];
+    }
+    grid -> interval_.assign(numTotal, -1);
+    grid -> paramOffset_.assign(numTotal, 0.0);
+
+    // map voxel centres onto curve:
+    const std::vector<real> &uniqueKnots = this -> uniqueKnots();
+    real tubeRadiusSq = tubeRadius*tubeRadius;
+    size_t idx = 0;
+    for(int k = 0; k < grid -> numVoxels_[ZZ]; k++)
+    {
+        for(int j = 0; j < grid -> numVoxels_[YY]; j++)
+        {
+            for(int i = 0; i < grid -> numVoxels_[XX]; i++, idx++)
+            {
+                gmx::RVec centre(
+                        grid -> origin_[XX] + (i + 0.5)*voxelSize,
+                        grid -> origin_[YY] + (j + 0.5)*voxelSize,
+                        grid -> origin_[ZZ] + (k + 0.5)*voxelSize);
+                gmx::RVec proj = cartesianToCurvilinearExact(centre);
+
+                // voxels outside tube or beyond endpoints are not covered:
+                if( proj[RR] > tubeRadiusSq || proj[SS] < lo || proj[SS] > hi )
+                {
+                    continue;
+                }
+
+                // find interval containing closest point:
+                auto it = std::upper_bound(
+                        uniqueKnots.begin(), 
+                        uniqueKnots.end() - 1, 
+                        proj[SS]);
+                int interval = std::max(
+                        0, 
+                        static_cast<int>(it - uniqueKnots.begin()) - 1);
+                grid -> interval_[idx] = interval;
+                grid -> paramOffset_[idx] = proj[SS] - uniqueKnots[interval];
+            }
+        }
+    }
+
+    // grid is shared by copies of this curve:
+    mappingGrid_ = grid;
+}
+
+
+/*!
+ * Returns true if a lookup grid for mapping has been prepared.
+ */
+bool
+SplineCurve3D::mappingGridAvailable() const
+{
+    return mappingGrid_ != nullptr;
+}
+
+
+/*!
+ * Maps a point onto the curve using the lookup grid. The arc length estimate
+ * stored for the voxel containing the point is refined by Newton iterations
+ * on the derivative of the squared distance between point and curve. Returns
+ * false if the point is not covered by the grid or if the Newton iteration 
+ * fails to converge to a minimum inside the knot range, in which case the 
+ * caller must fall back to cartesianToCurvilinearExact().
+ */
+bool
+SplineCurve3D::cartesianToCurvilinearGrid(
+        const gmx::RVec &cartPoint,
+        gmx::RVec &curvPoint)
+{
+    // find voxel containing point:
+    const MappingGrid &grid = *mappingGrid_;
+    int voxel[DIM];
+    for(int j = 0; j < DIM; j++)
+    {
+        real pos = (cartPoint[j] - grid.origin_[j])/grid.voxelSize_;
+        if( pos < 0.0 || pos >= grid.numVoxels_[j] )
+        {
+            return false;
+        }
+        voxel[j] = static_cast<int>(pos);
+    }
+    size_t idx = voxel[XX] + grid.numVoxels_[XX]*(
+                 voxel[YY] + grid.numVoxels_[YY]*static_cast<size_t>(voxel[ZZ]));
+
+    // is voxel covered by grid:
+    int interval = grid.interval_[idx];
+    if( interval < 0 )
+    {
+        return false;
+    }
+
+    // refine arc length estimate:
+    return cartesianToCurvilinearNewton(
+            cartPoint, 
+            knots_[interval + degree_] + grid.paramOffset_[idx], 
+            curvPoint);
+}
+
+
+/*!
+ * Maps a point onto the curve by Newton iterations on the derivative of the
+ * squared distance between point and curve, starting from the given curve
+ * parameter. Returns false if the iteration does not converge to a minimum
+ * inside the knot range within a few steps.
+ */
+bool
+SplineCurve3D::cartesianToCurvilinearNewton(
+        const gmx::RVec &cartPoint,
+        real eval,
+        gmx::RVec &curvPoint)
+{
+    // internal parameters:
+    const int maxIter = 5;
+    const real tol = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // Newton iteration for stationary point of squared distance:
+    for(int iter = 0; iter < maxIter; iter++)
+    {
+        gmx::RVec diff;
+        rvec_sub(evaluate(eval, 0), cartPoint, diff);
+        gmx::RVec deriv = evaluate(eval, 1);
+        real grad = iprod(diff, deriv);
+        real curv = iprod(deriv, deriv) + iprod(diff, evaluate(eval, 2));
+
+        // not a minimum:
+        if( curv <= 0.0 )
+        {
+            return false;
+        }
+
+        real step = grad/curv;
+        eval -= step;
+        if( std::fabs(step) < tol )
+        {
+            // extrapolation range is handled by exact mapping:
+            if( eval < knots_.front() || eval > knots_.back() )
+            {
+                return false;
+            }
+
+            curvPoint[SS] = eval;
+            curvPoint[RR] = pointSqDist(cartPoint, eval);
+            curvPoint[PP] = 0.0;
+            return true;
+        }
+    }
+
+    // not converged:
+    return false;
+}
+
+
+/*!
+ * Maps a point onto the curve by searching the entire curve for the closest
+ * interval and minimising the distance to the curve in this and the 
+ * neighbouring intervals. Used by cartesianToCurvilinear() for points not
+ * covered by the lookup grid.
+ */
+gmx::RVec 
+SplineCurve3D::cartesianToCurvilinearExact(const gmx::RVec &cartPoint)
 {
     // find index of interval containing closest point on spline curve:
     unsigned int idx = closestSplinePoint(cartPoint);
@@ -619,7 +964,7 @@ SplineCurve3D::projectionInExtrapRange(
 /*!
  * Getter function for access to the spline curves control points.
  */
-std::vector<gmx::RVec>
+const std::vector<gmx::RVec>&
 SplineCurve3D::ctrlPoints() const
 {
     return ctrlPoints_;
@@ -808,6 +1153,29 @@ SplineCurve3D::arcLengthToParam(real &arcLength)
 }
 
 
+/*!
+ * Returns the arc length step at which the relative difference between chord
+ * and arc reaches the tolerance for the given curvature, clamped to the given
+ * range. The tolerance is passed in as curvFactor, which is the square root of
+ * 24 times the tolerance.
+ */
+real
+SplineCurve3D::arcLengthStep(
+        real curvature, 
+        real curvFactor, 
+        real minStep, 
+        real maxStep)
+{
+    // straight segments are limited only by maximum step:
+    real step = maxStep;
+    if( curvature*maxStep > curvFactor )
+    {
+        step = curvFactor/curvature;
+    }
+    return std::max(step, minStep);
+}
+
+
 /*!
  * Termination condition for re-parameterisation optimisation. 
  */
@@ -75,6 +75,9 @@ void
 AnalysisDataJsonFrameExporter::frameStarted(
         const gmx::AnalysisDataFrameHeader &frame)
 {   
+    // no points added to this frame yet:
+    frameHasPoints_ = false;
+
     // calling setObject will call destructor and deallocate data:
     json_.SetObject();
     rapidjson::Document::AllocatorType& allocator = json_.GetAllocator();
@@ -127,6 +130,9 @@ AnalysisDataJsonFrameExporter::pointsAdded(
     // create an allocator:
     rapidjson::Document::AllocatorType& allocator = json_.GetAllocator();
 
+    // frame will be written to file:
+    frameHasPoints_ = true;
+
     // obtain name of data set:
     std::string dataSetName = dataSetNames_.at(points.dataSetIndex());    
 
@@ -161,6 +167,10 @@ AnalysisDataJsonFrameExporter::pointsAdded(
  * document prepared by startFrame() and pointsAdded(). Spliiting the 
  * functionality in this way should make clean error handling possible.
  *
+ * Frames to which no points have been added are not written at all. This 
+ * allows several processes to each write a subset of frames to their own file
+ * (see ChapTrajectoryAnalysis).
+ *
  * \todo Check validity of JSON document before writing.
  * \todo Check that file write was successful.
  */
@@ -168,6 +178,12 @@ void
 AnalysisDataJsonFrameExporter::frameFinished(
         const gmx::AnalysisDataFrameHeader& /*frame*/)
 {
+    // skip empty frames:
+    if( !frameHasPoints_ )
+    {
+        return;
+    }
+
     // open output file separately for each frame:
     file_.open(fileName_.c_str(), std::fstream::app);
 
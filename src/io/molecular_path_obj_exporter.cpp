@@ -51,14 +51,27 @@ RegularVertexGrid::RegularVertexGrid(
 
 
 /*!
- * Adds a vertex at the given coordinates for the given property.
+ * Adds a vertex at the given grid coordinates. The vertex is shared between 
+ * all properties.
  */
 void
 RegularVertexGrid::addVertex(
         size_t i, 
         size_t j,
+        gmx::RVec vertex)
+{
+    vertices_[std::make_pair(i, j)] = vertex;
+}
+
+
+/*!
+ * Adds the weight of the given property at the given grid coordinates.
+ */
+void
+RegularVertexGrid::addWeight(
+        size_t i,
+        size_t j,
         std::string p,
-        gmx::RVec vertex, 
         real weight)
 {
     // TODO: this situation should really be handled by a NaN colour
@@ -69,17 +82,15 @@ RegularVertexGrid::addVertex(
 
     p_.insert(p);
     std::tuple<size_t, size_t, std::string> key(i, j, p);
-    vertices_[key] = vertex;
     weights_[key] = weight;
 }
 
 
 /*!
- * Returns a vector of all vertices for a given property.
+ * Returns a vector of all vertices.
  */
 std::vector<gmx::RVec>
-RegularVertexGrid::vertices(
-        std::string p)
+RegularVertexGrid::vertices()
 {
     // build linearly indexed vector from dual indexed map:
     std::vector<gmx::RVec> vert;
@@ -88,10 +99,10 @@ RegularVertexGrid::vertices(
     {
         for(size_t j = 0; j < phi_.size(); j++)
         {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( vertices_.find(key) != vertices_.end() )
+            auto it = vertices_.find(std::make_pair(i, j));
+            if( it != vertices_.end() )
             {
-                vert.push_back(vertices_[key]); 
+                vert.push_back(it -> second); 
             }
             else
             {
@@ -105,11 +116,10 @@ RegularVertexGrid::vertices(
 
 
 /*!
- * Returns vector of vertex normals for a given property.
+ * Returns vector of vertex normals.
  */
 std::vector<gmx::RVec>
-RegularVertexGrid::normals(
-        std::string p)
+RegularVertexGrid::normals()
 {
     std::vector<gmx::RVec> norm;
     norm.reserve(normals_.size());
@@ -117,10 +127,10 @@ RegularVertexGrid::normals(
     {
         for(size_t j = 0; j < phi_.size(); j++)
         {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( normals_.find(key) != normals_.end() )
+            auto it = normals_.find(std::make_pair(i, j));
+            if( it != normals_.end() )
             {
-                norm.push_back(normals_[key]); 
+                norm.push_back(it -> second); 
             }
             else
             {
@@ -144,138 +154,84 @@ RegularVertexGrid::normalsFromFaces()
     int mI = s_.size();
     int mJ = phi_.size();
 
-    for(auto p : p_)
+    for(int i = 0; i < s_.size(); i++)
     {
-        for(int i = 0; i < s_.size(); i++)
+        for(int j = 0; j < phi_.size(); j++)
         {
-            for(int j = 0; j < phi_.size(); j++)
+            // index pairs for neighbouring vertices:
+            std::pair<size_t, size_t> crntKey(i, j);
+            std::pair<size_t, size_t> leftKey(i, (j - 1 + mJ) % mJ);
+            std::pair<size_t, size_t> rghtKey(i, (j + 1 + mJ) % mJ);
+            std::pair<size_t, size_t> upprKey((i + 1 + mI) % mI, j);
+            std::pair<size_t, size_t> lowrKey((i - 1 + mI) % mI, j);
+            std::pair<size_t, size_t> dglrKey((i - 1 + mI) % mI, 
+                                              (j + 1 + mJ) % mJ);
+            std::pair<size_t, size_t> dgulKey((i + 1 + mI) % mI, 
+                                              (j - 1 + mJ) % mJ);
+
+            // handle endpoints in direction along spline:
+            if( i == 0 )
             {
-                // index pairs for neighbouring vertices:
-                std::tuple<size_t, size_t, std::string> crntKey(
-                        i, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> leftKey(
-                        i, 
-                        (j - 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> rghtKey(
-                        i, 
-                        (j + 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> upprKey(
-                        (i + 1 + mI) % mI, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> lowrKey((
-                        i - 1 + mI) % mI, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> dglrKey(
-                        (i - 1 + mI) % mI, 
-                        (j + 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> dgulKey(
-                        (i + 1 + mI) % mI, 
-                        (j - 1 + mJ) % mJ,
-                        p);
-
-                // handle endpoints in direction along spline:
-                if( i == 0 )
-                {
-                    lowrKey = crntKey; 
-                    dglrKey = crntKey;
-                }
-                if( i == s_.size() - 1 )
-                {
-                    upprKey = crntKey;
-                    dgulKey = crntKey;
-                }
-
-                // neighbouring vertices:
-                gmx::RVec crntVert = vertices_.at(crntKey);
-                gmx::RVec leftVert = vertices_.at(leftKey);
-                gmx::RVec rghtVert = vertices_.at(rghtKey);
-                gmx::RVec upprVert = vertices_.at(upprKey);
-                gmx::RVec lowrVert = vertices_.at(lowrKey);
-                gmx::RVec dglrVert = vertices_.at(dglrKey);
-                gmx::RVec dgulVert = vertices_.at(dgulKey);
-
-                // initialise normal as null vector:
-                gmx::RVec norm(0.0, 0.0, 0.0);
-                gmx::RVec sideA;
-                gmx::RVec sideB;
-
-                // North-East triangle:
-                rvec_sub(rghtVert, crntVert, sideA);
-                rvec_sub(upprVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-                
-                // North-North-West triangle:
-                rvec_sub(upprVert, crntVert, sideA);
-                rvec_sub(dgulVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // West-North-West triangle:
-                rvec_sub(dgulVert, crntVert, sideA);
-                rvec_sub(leftVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // South-West triangle:
-                rvec_sub(leftVert, crntVert, sideA);
-                rvec_sub(lowrVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // South-South-East triangle:
-                rvec_sub(lowrVert, crntVert, sideA);
-                rvec_sub(dglrVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-                
-                // East-South-East triangle:
-                rvec_sub(dglrVert, crntVert, sideA);
-                rvec_sub(rghtVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // normalise normal:
-                unitv(norm, norm);
-                
-                // add to container of normals:
-                normals_[crntKey] = norm;
+                lowrKey = crntKey; 
+                dglrKey = crntKey;
             }
-        }
-    }
-}
-
-
-/*!
- * Returns a vector of vertices plus a scalar weight.
- */
-std::vector<std::pair<gmx::RVec, real>>
-RegularVertexGrid::weightedVertices(
-        std::string p)
-{
-    // build linearly indexed vector from dual indexed map:
-    std::vector<std::pair<gmx::RVec, real>> vert;
-    vert.reserve(vertices_.size());
-    for(size_t i = 0; i < s_.size(); i++)
-    {
-        for(size_t j = 0; j < phi_.size(); j++)
-        {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( vertices_.find(key) != vertices_.end() && 
-                weights_.find(key) != weights_.end() )
-            {
-                std::pair<gmx::RVec, real> vertex(vertices_[key], weights_[key]);
-                vert.push_back(vertex); 
-            }
-            else
+            if( i == s_.size() - 1 )
             {
-                throw std::logic_error("Invalid vertex reference encountered.");
+                upprKey = crntKey;
+                dgulKey = crntKey;
             }
+
+            // neighbouring vertices:
+            gmx::RVec crntVert = vertices_.at(crntKey);
+            gmx::RVec leftVert = vertices_.at(leftKey);
+            gmx::RVec rghtVert = vertices_.at(rghtKey);
+            gmx::RVec upprVert = vertices_.at(upprKey);
+            gmx::RVec lowrVert = vertices_.at(lowrKey);
+            gmx::RVec dglrVert = vertices_.at(dglrKey);
+            gmx::RVec dgulVert = vertices_.at(dgulKey);
+
+            // initialise normal as null vector:
+            gmx::RVec norm(0.0, 0.0, 0.0);
+            gmx::RVec sideA;
+            gmx::RVec sideB;
+
+            // North-East triangle:
+            rvec_sub(rghtVert, crntVert, sideA);
+            rvec_sub(upprVert, crntVert, sideB);
+            addTriangleNorm(sideA, sideB, norm);
+            
+            // North-North-West triangle:
+            rvec_sub(upprVert, crntVert, sideA);
+            rvec_sub(dgulVert, crntVert, sideB);
+            addTriangleNorm(sideA, sideB, norm);
+
+            // West-North-West triangle:
+            rvec_sub(dgulVert, crntVert, sideA);
+            rvec_sub(leftVert, crntVert, sideB);
+            addTriangleNorm(sideA, sideB, norm);
+
+            // South-West triangle:
+            rvec_sub(leftVert, crntVert, sideA);
+            rvec_sub(lowrVert, crntVert, sideB);
+            addTriangleNorm(sideA, sideB, norm);
+
+            // South-South-East triangle:
+            rvec_sub(lowrVert, crntVert, sideA);
+            rvec_sub(dglrVert, crntVert, sideB);
+            addTriangleNorm(sideA, sideB, norm);
+            
+            // East-South-East triangle:
+            rvec_sub(dglrVert, crntVert, sideA);
+            rvec_sub(rghtVert, crntVert, sideB);
+            addTriangleNorm(sideA, sideB, norm);
+
+            // normalise normal:
+            unitv(norm, norm);
+            
+            // add to container of normals:
+            normals_[crntKey] = norm;
         }
     }
-
-    return vert;
 }
 
 
@@ -307,13 +263,17 @@ RegularVertexGrid::addTriangleNorm(
 
 /*!
  * Calculates and returns vector of triangular faces for the given property.
+ * As the vertices are shared between all properties, the faces of all 
+ * properties reference the same vertex and normal indices and differ only in
+ * their material.
  */
 std::vector<WavefrontObjFace>
 RegularVertexGrid::faces(
         std::string p)
 {
     // sanity checks:
-    if( phi_.size() * s_.size() * p_.size() != vertices_.size() )
+    if( phi_.size() * s_.size() != vertices_.size() ||
+        phi_.size() * s_.size() * p_.size() != weights_.size() )
     {
         throw std::logic_error("RegularVertexGrid cannot generate faces "
                                "on incomplete grid.");
@@ -346,10 +306,6 @@ RegularVertexGrid::faces(
     colScale.setResolution(100);   // NOTE: limited by number of MTL materials
     colourScales_.insert(std::pair<std::string, ColourScale>(p, colScale));
 
-    // number of vertices per property grid:
-    size_t propIdx = std::distance(p_.begin(), find(p_.begin(), p_.end(), p));
-    size_t vertOffset = s_.size() * phi_.size() * propIdx;
-
     // preallocate face vector:
     std::vector<WavefrontObjFace> faces;
     faces.reserve(phi_.size()*s_.size());
@@ -360,7 +316,7 @@ RegularVertexGrid::faces(
         for(size_t j = 0; j < phi_.size() - 1; j++)
         {
             // calculate linear indices:
-            int kbl = vertOffset + i * phi_.size() + j; 
+            int kbl = i * phi_.size() + j; 
             int kbr = kbl + 1;
             int ktl = kbl + phi_.size();
             int ktr = kbr + phi_.size();
@@ -413,8 +369,8 @@ RegularVertexGrid::faces(
     for(size_t i = 0; i < s_.size() - 1; i++)
     {
         // calculate linear indices:
-        int kbl = vertOffset + i*phi_.size() + phi_.size() - 1; 
-        int kbr = vertOffset + i*phi_.size();
+        int kbl = i*phi_.size() + phi_.size() - 1; 
+        int kbr = i*phi_.size();
         int ktl = kbl + phi_.size();
         int ktr = kbr + phi_.size();
 
@@ -471,6 +427,7 @@ MolecularPathObjExporter::MolecularPathObjExporter()
     : extrapDist_(0.0)
     , gridSampleDist_(-1.0)
     , correctionThreshold_(0.1)
+    , tessellationTolerance_(0.005)
 {
     
 }
@@ -520,6 +477,27 @@ MolecularPathObjExporter::setCorrectionThreshold(real correctionThreshold)
 }
 
 
+/*!
+ * Sets the maximum deviation (in nm) of the tessellated surface from the 
+ * interpolated pathway surface. This determines how finely the surface is
+ * resolved along and around the centre line.
+ */
+void
+MolecularPathObjExporter::setTessellationTolerance(
+        real tessellationTolerance)
+{
+    // sanity check:
+    if( tessellationTolerance <= 0.0 )
+    {
+        throw std::runtime_error("Tessellation tolerance for "
+                                 "MolecularPathObjExporter must be "
+                                 "positive!");
+    }
+
+    tessellationTolerance_ = tessellationTolerance;
+}
+
+
 /*!
  * High level driver for exporting a MolecularPath object to an OBJ and MTL
  * file.
@@ -535,16 +513,14 @@ MolecularPathObjExporter::operator()(
     std::pair<real, real> range(molPath.sLo() - extrapDist_,
                                 molPath.sHi() + extrapDist_);
 
-    // define resolution:
-    // TODO: make this a parameter?
-    int numPhi = 50;
-    int numLen = std::pow(2, 8) + 1;
-    std::pair<size_t, size_t> resolution(numLen, numPhi);
-    
     // pathway geometry:
     auto centreLine = molPath.centreLine();
     auto pathRadius = molPath.pathRadius();
 
+    // define resolution from tessellation tolerance:
+    std::vector<real> s = tessellateArcLength(centreLine, pathRadius, range);
+    size_t numPhi = tessellateAngle(pathRadius, s);
+
     // pathway properties:
     // (radius is added here to ensure that there is always one property)
     molPath.addScalarProperty("radius", pathRadius, false);
@@ -563,28 +539,28 @@ MolecularPathObjExporter::operator()(
             centreLine,
             pathRadius,
             properties,
-            resolution,
-            range);
+            s,
+            numPhi);
+
+    // vertices and normals are shared by all properties:
+    grid.normalsFromFaces();
+    obj.addVertices(grid.vertices());
+    obj.addVertexNormals(grid.normals());
 
     // loop over properties:
-    for(auto prop : properties)
+    for(auto &prop : properties)
     {
-        // obtain vertices, normals, and faces from grid:
-        grid.normalsFromFaces();
-        auto vertices = grid.weightedVertices(prop.first);
-        auto vertexNormals = grid.normals(prop.first);
+        // obtain faces from grid:
         auto faces = grid.faces(prop.first);
 
         // add faces to surface:
         WavefrontObjGroup group(prop.first);
-        for(auto face : faces)
+        for(auto &face : faces)
         {
             group.addFace(face);
         }
 
         // add to the overall OBJ object:
-        obj.addVertices(vertices);
-        obj.addVertexNormals(vertexNormals);
         obj.addGroup(group);
 
         // obtain colour scale for this property:
@@ -649,37 +625,168 @@ MolecularPathObjExporter::operator()(
 
 
 /*!
- * Creates a regular vertex grid from a given centre line and radius spline.
- * This function loops over all given properties and for each property calls
- * generatePropertyGrid().
+ * Chooses the arc length coordinates of the vertex rings. The evaluation 
+ * range is first divided into uniform intervals no longer than the distance
+ * at which the surface is sampled, as the interpolated surface can not have 
+ * any features below this scale. Each interval is then recursively bisected 
+ * until the deviation of the linearly interpolated surface from the curved 
+ * one is below the tessellation tolerance (see tessellationError()). This 
+ * places many rings in strongly curved or constricted regions and few rings
+ * along straight sections of the pathway.
  */
-RegularVertexGrid
-MolecularPathObjExporter::generateGrid(
+std::vector<real>
+MolecularPathObjExporter::tessellateArcLength(
         SplineCurve3D &centreLine,
         SplineCurve1D &radius,
-        std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
-        std::pair<size_t, size_t> resolution,
         std::pair<real, real> range)
 {
-    // extract resolution:
-    size_t numLen = resolution.first;
-    size_t numPhi = resolution.second;
+    // initial uniform partition:
+    real length = range.second - range.first;
+    int numInt = std::max(1, static_cast<int>(std::ceil(
+            length/gridSampleDist_)));
+    real ds = length/numInt;
 
-    // check if number of intervals is power of two:
-    int numInt = numLen - 1;
-    if( (numInt & (numInt)) == 0 && numInt > 0 )
+    // refine each interval:
+    std::vector<real> s;
+    for(int i = 0; i < numInt; i++)
     {
-        throw std::logic_error("Number of steps along pore must be power of "
-                               "two.");
+        real lo = range.first + i*ds;
+        s.push_back(lo);
+        refineInterval(centreLine, radius, lo, lo + ds, 0, s);
     }
+    s.push_back(range.second);
 
-    // generate grid coordinates:
-    std::vector<real> s;
-    s.reserve(numLen);
-    for(int i = 0; i < numLen; i++)
+    return s;
+}
+
+
+/*!
+ * Recursively bisects the interval between lo and hi and appends the interior
+ * points (but not the endpoints) to s in ascending order. Recursion stops when
+ * the tessellation error of the interval is below the tolerance or a maximum
+ * depth is reached.
+ */
+void
+MolecularPathObjExporter::refineInterval(
+        SplineCurve3D &centreLine,
+        SplineCurve1D &radius,
+        real lo,
+        real hi,
+        int depth,
+        std::vector<real> &s)
+{
+    // maximum number of bisections per initial interval:
+    const int maxDepth = 6;
+
+    // interval resolved sufficiently well?
+    if( depth >= maxDepth || 
+        tessellationError(centreLine, radius, lo, hi) <= tessellationTolerance_ )
     {
-        s.push_back(i*(range.second - range.first)/numLen + range.first);
+        return;
     }
+
+    // refine both halves:
+    real mid = 0.5*(lo + hi);
+    refineInterval(centreLine, radius, lo, mid, depth + 1, s);
+    s.push_back(mid);
+    refineInterval(centreLine, radius, mid, hi, depth + 1, s);
+}
+
+
+/*!
+ * Estimates the maximum distance between the pathway surface and its 
+ * piecewise linear approximation between the vertex rings at lo and hi. The
+ * estimate is the sum of the deviation of the centre line and the radius 
+ * from their chords at the interval midpoint and the displacement of the 
+ * surface due to the rotation of the ring plane between both ends.
+ */
+real
+MolecularPathObjExporter::tessellationError(
+        SplineCurve3D &centreLine,
+        SplineCurve1D &radius,
+        real lo,
+        real hi)
+{
+    real mid = 0.5*(lo + hi);
+
+    // deviation of centre line from chord:
+    gmx::RVec centreLo = centreLine.evaluate(lo, 0);
+    gmx::RVec centreHi = centreLine.evaluate(hi, 0);
+    gmx::RVec centreMid = centreLine.evaluate(mid, 0);
+    gmx::RVec chordMid;
+    rvec_add(centreLo, centreHi, chordMid);
+    svmul(0.5, chordMid, chordMid);
+    real centreErr = std::sqrt(distance2(centreMid, chordMid));
+
+    // deviation of radius from chord:
+    real radiusMid = radius.evaluate(mid, 0);
+    real radiusErr = std::fabs(
+            radiusMid - 0.5*(radius.evaluate(lo, 0) + radius.evaluate(hi, 0)));
+
+    // displacement due to rotation of ring plane:
+    gmx::RVec tangentLo = centreLine.tangentVec(lo);
+    gmx::RVec tangentHi = centreLine.tangentVec(hi);
+    real angle = gmx_angle(tangentLo, tangentHi);
+    real tiltErr = std::fabs(radiusMid)*(1.0 - std::cos(0.5*angle));
+
+    return centreErr + radiusErr + tiltErr;
+}
+
+
+/*!
+ * Chooses the number of vertices per ring such that the chord between two 
+ * neighbouring vertices deviates from the circular cross section by no more
+ * than the tessellation tolerance. The same number is used for all rings, as
+ * this keeps the grid regular and hence the surface free of cracks, so that 
+ * the number is determined by the largest radius.
+ */
+size_t
+MolecularPathObjExporter::tessellateAngle(
+        SplineCurve1D &radius,
+        const std::vector<real> &s)
+{
+    // bounds on number of vertices per ring:
+    const size_t minNumPhi = 8;
+    const size_t maxNumPhi = 360;
+
+    // find largest radius:
+    real maxRadius = 0.0;
+    for(auto eval : s)
+    {
+        maxRadius = std::max(maxRadius, std::fabs(radius.evaluate(eval, 0)));
+    }
+
+    // tolerance larger than circle can be met by any polygon:
+    if( tessellationTolerance_ >= maxRadius )
+    {
+        return minNumPhi;
+    }
+
+    // sagitta of chord subtending angle dphi is r*(1 - cos(dphi/2)):
+    real dphi = 2.0*std::acos(1.0 - tessellationTolerance_/maxRadius);
+    size_t numPhi = static_cast<size_t>(std::ceil(2.0*M_PI/dphi));
+
+    return std::min(maxNumPhi, std::max(minNumPhi, numPhi));
+}
+
+
+/*!
+ * Creates a regular vertex grid from a given centre line and radius spline 
+ * with vertex rings at the given arc length coordinates and numPhi vertices
+ * per ring. The surface geometry is generated only once by 
+ * generateVertexGrid(), after which this function loops over all given 
+ * properties and for each property calls generatePropertyGrid() to add the 
+ * vertex weights.
+ */
+RegularVertexGrid
+MolecularPathObjExporter::generateGrid(
+        SplineCurve3D &centreLine,
+        SplineCurve1D &radius,
+        std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
+        const std::vector<real> &s,
+        size_t numPhi)
+{
+    // generate angular grid coordinates:
     std::vector<real> phi;
     phi.reserve(numPhi);
     for(size_t i = 0; i < numPhi; i++)
@@ -690,14 +797,13 @@ MolecularPathObjExporter::generateGrid(
     // generate grid from coordinates:
     RegularVertexGrid grid(s, phi);
 
-    // loop over properties and add vertices:
+    // add vertices:
+    generateVertexGrid(centreLine, radius, grid);
+
+    // loop over properties and add weights:
     for(auto &prop : properties)
     {
-        generatePropertyGrid(
-                centreLine,
-                radius,
-                prop,
-                grid);
+        generatePropertyGrid(prop, grid);
     }
 
     // return the overall grid:
@@ -706,15 +812,13 @@ MolecularPathObjExporter::generateGrid(
 
 
 /*!
- * This function creates the actual vertices used in the RegularVertexGrid and
- * calculates the colour property by sampling the given spline curve at the
- * appropriate location.
+ * This function creates the actual vertices used in the RegularVertexGrid by
+ * sampling the pathway surface and interpolating it onto the grid.
  */
 void
-MolecularPathObjExporter::generatePropertyGrid(
+MolecularPathObjExporter::generateVertexGrid(
         SplineCurve3D &centreLine,
         SplineCurve1D &radius,
-        std::pair<std::string, std::pair<SplineCurve1D, bool>> property,
         RegularVertexGrid &grid)
 {   
     // extract grid coordinates:
@@ -890,6 +994,29 @@ MolecularPathObjExporter::generatePropertyGrid(
     // build mesh
     // ------------------------------------------------------------------------
 
+    // loop over target grid coordinates and add vertices:
+    for(size_t i = 0; i < grid.s_.size(); i++)
+    {
+        for(size_t k = 0; k < grid.phi_.size(); k++)
+        {
+            grid.addVertex(
+                    i, 
+                    k, 
+                    curves[k].evaluate(grid.s_[i], 0));
+        }
+    }
+}
+
+
+/*!
+ * Calculates the colour property by sampling the given spline curve at the
+ * grid coordinates and adds it as vertex weights to the RegularVertexGrid.
+ */
+void
+MolecularPathObjExporter::generatePropertyGrid(
+        std::pair<std::string, std::pair<SplineCurve1D, bool>> property,
+        RegularVertexGrid &grid)
+{
     // sample scalar property along the path and rescale to unit interval:
     std::vector<real> prop;
     prop.reserve(grid.s_.size());
@@ -899,17 +1026,12 @@ MolecularPathObjExporter::generatePropertyGrid(
     }
     shiftAndScale(prop, property.second.second);
 
-    // loop over target grid coordinates and add vertices:
+    // add weights for all vertices:
     for(size_t i = 0; i < grid.s_.size(); i++)
     {
         for(size_t k = 0; k < grid.phi_.size(); k++)
         {
-            grid.addVertex(
-                    i, 
-                    k, 
-                    property.first, 
-                    curves[k].evaluate(grid.s_[i], 0),
-                    prop[i]);
+            grid.addWeight(i, k, property.first, prop[i]);
         }
     }
 }
@@ -24,6 +24,8 @@
 
 #include <cstring>
 #include <iomanip>
+#include <map>
+#include <stdexcept>
 
 #include <gromacs/fileio/confio.h>
 #include <gromacs/topology/atoms.h>
@@ -53,13 +55,32 @@ PdbStructure::fromTopology(
 
 /*!
  * Sets the occupancy and bfac fields of the PDB file to the time averaged 
- * pore-lining and pore-facing attributes.
+ * pore-lining and pore-facing attributes. The i-th entry of poreLining and
+ * poreFacing belongs to the residue with topology index resIds[i]. All atoms
+ * of other residues have both fields set to zero, so that the structure can
+ * be reused for several channels.
  */
 void
 PdbStructure::setPoreFacing(
+        const std::vector<int> &resIds,
         const std::vector<SummaryStatistics> &poreLining,
         const std::vector<SummaryStatistics> &poreFacing)
 {
+    // sanity check:
+    if( resIds.size() != poreLining.size() || 
+        resIds.size() != poreFacing.size() )
+    {
+        throw std::logic_error("Number of residue IDs does not match number "
+                               "of pore-lining and pore-facing values.");
+    }
+
+    // position of each residue in attribute vectors:
+    std::map<int, size_t> resIdx;
+    for(size_t i = 0; i < resIds.size(); i++)
+    {
+        resIdx[resIds[i]] = i;
+    }
+
     // if no pdbinfo exists, need to create array manually:
     if( atoms_.pdbinfo == nullptr )
     {    
@@ -83,21 +104,16 @@ PdbStructure::setPoreFacing(
     // assign pore facing/lining to occupancy and bfac:
     for(size_t i = 0; i < atoms_.nr; i++)
     {
-        // find residue of this atom:
-        size_t resind = atoms_.atom[i].resind;
+        // both attributes zero by default (also resets previous channel):
+        atoms_.pdbinfo[i].occup = 0.0;
+        atoms_.pdbinfo[i].bfac = 0.0;
 
         // have we measured pore facing attribute for this residue?
-        if( resind >= poreLining.size() )
-        {
-            // both attributes zero by default:
-            atoms_.pdbinfo[i].occup = 0.0;
-            atoms_.pdbinfo[i].bfac = 0.0;
-        }
-        else
+        auto it = resIdx.find(atoms_.atom[i].resind);
+        if( it != resIdx.end() )
         {
-            // reassign occupancy and bfactor:
-            atoms_.pdbinfo[i].occup = poreLining.at(resind).mean();
-            atoms_.pdbinfo[i].bfac = poreFacing.at(resind).mean();
+            atoms_.pdbinfo[i].occup = poreLining.at(it -> second).mean();
+            atoms_.pdbinfo[i].bfac = poreFacing.at(it -> second).mean();
         }
     }
 }
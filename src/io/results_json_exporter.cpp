@@ -78,6 +78,21 @@ ResultsJsonExporter::ResultsJsonExporter()
     rapidjson::Value residueSummary;
     residueSummary.SetObject();
     doc_.AddMember("residueSummary", residueSummary, alloc);
+
+    // create a diffusion profile object:
+    rapidjson::Value diffusionProfile;
+    diffusionProfile.SetObject();
+    doc_.AddMember("diffusionProfile", diffusionProfile, alloc);
+
+    // create a dewetting events object:
+    rapidjson::Value dewettingEvents;
+    dewettingEvents.SetObject();
+    doc_.AddMember("dewettingEvents", dewettingEvents, alloc);
+
+    // create a time-resolved pathway profile object:
+    rapidjson::Value pathwayProfileTr;
+    pathwayProfileTr.SetObject();
+    doc_.AddMember("pathwayProfileTimeResolved", pathwayProfileTr, alloc);
 }
 
 
@@ -384,6 +399,245 @@ ResultsJsonExporter::addResidueSummary(
 }
 
 
+/*!
+ * Adds the correlation of a residue property with a pathway property to the 
+ * output document. Next to the correlation coefficient itself, the rank of 
+ * each residue by absolute correlation is written, with rank one indicating 
+ * the strongest (positive or negative) correlation. Residues with fewer than
+ * two samples are written as null and are not ranked. Requires that 
+ * addResidueInformation() has been called beforehand and that the number of 
+ * data points equals the number of residues.
+ */
+void
+ResultsJsonExporter::addResidueCorrelation(
+        std::string name,
+        const std::vector<CovarianceStatistics> &resCorrelation)
+{
+    // sanity checks:
+    if( !doc_["residueSummary"].HasMember("id") )
+    {
+        throw std::logic_error("Can not add correlation to residue summary "
+                               "before residue information has been added.");
+    }
+    if( resCorrelation.size() != doc_["residueSummary"]["id"].Size() )
+    {
+        throw std::logic_error("Number of data points in correlation vector "
+                               "must equal number residues.");
+    }
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // rank residues by absolute correlation:
+    std::vector<int> rank = CovarianceStatistics::rankByCorrelation(
+            resCorrelation);
+
+    // build arrays of correlation coefficients and ranks:
+    // (unranked residues have too few samples and are written as null)
+    rapidjson::Value corr(rapidjson::kArrayType);
+    rapidjson::Value rnk(rapidjson::kArrayType);
+    for(size_t i = 0; i < resCorrelation.size(); i++)
+    {
+        if( rank[i] == 0 )
+        {
+            corr.PushBack(rapidjson::Value(rapidjson::kNullType), alloc);
+            rnk.PushBack(rapidjson::Value(rapidjson::kNullType), alloc);
+        }
+        else
+        {
+            corr.PushBack(resCorrelation[i].corr(), alloc);
+            rnk.PushBack(rank[i], alloc);
+        }
+    }
+
+    // add to output document:
+    rapidjson::Value corrObj;
+    corrObj.SetObject();
+    corrObj.AddMember("corr", corr, alloc);
+    corrObj.AddMember("rank", rnk, alloc);
+    doc_["residueSummary"].AddMember(toVal(name), corrObj, alloc);
+}
+
+
+/*!
+ * Adds the position-dependent diffusion coefficient to the output document.
+ * Unlike the pathway profiles, this is not evaluated at the support points,
+ * but given on the bins used for accumulating displacements. Can only be 
+ * called once.
+ */
+void
+ResultsJsonExporter::addDiffusionProfile(
+        const std::vector<real> &binCentres,
+        const std::vector<real> &diffCoef,
+        const std::vector<int> &numSamples)
+{
+    // sanity checks:
+    if( binCentres.size() != diffCoef.size() ||
+        binCentres.size() != numSamples.size() )
+    {
+        throw std::logic_error("Diffusion profile must have as many "
+                               "coefficients and sample counts as there are "
+                               "bins.");
+    }
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create JSON arrays for bins, coefficients, and sample sizes:
+    rapidjson::Value s(rapidjson::kArrayType);
+    rapidjson::Value d(rapidjson::kArrayType);
+    rapidjson::Value n(rapidjson::kArrayType);
+    for(size_t i = 0; i < binCentres.size(); i++)
+    {
+        s.PushBack(binCentres[i], alloc);
+        d.PushBack(diffCoef[i], alloc);
+        n.PushBack(numSamples[i], alloc);
+    }
+
+    // add to output document:
+    doc_["diffusionProfile"].AddMember("s", s, alloc);
+    doc_["diffusionProfile"].AddMember("diffusionCoefficient", d, alloc);
+    doc_["diffusionProfile"].AddMember("numSamples", n, alloc);
+}
+
+
+/*!
+ * Adds the list of dewetting events recorded by the given detector to the 
+ * output document. Each event property is added as an individual column. The
+ * number of events and the fraction of time spent in the dewetted state are 
+ * added as scalars. Can only be called once.
+ */
+void
+ResultsJsonExporter::addDewettingEvents(
+        const DewettingEventDetector &detector)
+{
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create JSON arrays for the event properties:
+    rapidjson::Value start(rapidjson::kArrayType);
+    rapidjson::Value end(rapidjson::kArrayType);
+    rapidjson::Value duration(rapidjson::kArrayType);
+    rapidjson::Value location(rapidjson::kArrayType);
+    rapidjson::Value minDensity(rapidjson::kArrayType);
+    rapidjson::Value minNumPathway(rapidjson::kArrayType);
+    rapidjson::Value isComplete(rapidjson::kArrayType);
+
+    // loop over events and fill JSON arrays:
+    for(auto &event : detector.events())
+    {
+        start.PushBack(event.start_, alloc);
+        end.PushBack(event.end_, alloc);
+        duration.PushBack(event.duration(), alloc);
+        location.PushBack(event.location_, alloc);
+        minDensity.PushBack(event.minDensity_, alloc);
+        minNumPathway.PushBack(event.minNumPathway_, alloc);
+        isComplete.PushBack(event.isComplete_, alloc);
+    }
+
+    // add to output document:
+    rapidjson::Value &obj = doc_["dewettingEvents"];
+    obj.AddMember("numEvents", 
+                  static_cast<int>(detector.events().size()), 
+                  alloc);
+    obj.AddMember("dewettedFraction", detector.dewettedFraction(), alloc);
+    obj.AddMember("start", start, alloc);
+    obj.AddMember("end", end, alloc);
+    obj.AddMember("duration", duration, alloc);
+    obj.AddMember("location", location, alloc);
+    obj.AddMember("minDensity", minDensity, alloc);
+    obj.AddMember("minNumPathway", minNumPathway, alloc);
+    obj.AddMember("isComplete", isComplete, alloc);
+}
+
+
+/*!
+ * Adds temporal and spatial grid points for the time-resolved profiles in the
+ * same long format as used by addPathwayGridPoints(). The time stamps are 
+ * those of the last frame in each window. Should only be called once.
+ */
+void
+ResultsJsonExporter::addTimeResolvedGridPoints(
+        const std::vector<real> &timeStamps,
+        const std::vector<real> &supportPoints)
+{
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create a JSON array to hold long format time stamps and support points:
+    rapidjson::Value time(rapidjson::kArrayType);
+    rapidjson::Value space(rapidjson::kArrayType);
+    for(auto t : timeStamps)
+    {
+        for(auto s : supportPoints)
+        {
+            time.PushBack(t, alloc);
+            space.PushBack(s, alloc);
+        }
+    }
+
+    // add both to output document:
+    doc_["pathwayProfileTimeResolved"].AddMember(toVal("t"), time, alloc);
+    doc_["pathwayProfileTimeResolved"].AddMember(toVal("s"), space, alloc);
+}
+
+
+/*!
+ * Adds a time-resolved profile to the output. Window mean and standard 
+ * deviation as well as the exponential moving average are added as 
+ * individual columns (if they have been calculated). Requires that 
+ * addTimeResolvedGridPoints() has been called before and checks that the
+ * number of data points is equal to the number of grid points.
+ */
+void
+ResultsJsonExporter::addTimeResolvedProfile(
+        std::string name,
+        const TimeResolvedProfileAggregator &profile)
+{
+    // sanity checks:
+    if( !doc_["pathwayProfileTimeResolved"].HasMember("t") )
+    {
+        throw std::logic_error("Can not add time-resolved profile before "
+                               "setting space time grid.");
+    }
+    size_t numGridPoints = doc_["pathwayProfileTimeResolved"]["t"].Size();
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // collect columns to be written:
+    std::vector<std::pair<std::string, const std::vector<std::vector<real>>*>> columns;
+    if( profile.hasWindow() )
+    {
+        columns.push_back(std::make_pair(name + "Mean", &profile.mean()));
+        columns.push_back(std::make_pair(name + "Sd", &profile.sd()));
+    }
+    if( profile.hasEma() )
+    {
+        columns.push_back(std::make_pair(name + "Ema", &profile.ema()));
+    }
+
+    // write each column as linear array:
+    for(auto &col : columns)
+    {
+        rapidjson::Value ts(rapidjson::kArrayType);
+        for(auto &p : *col.second)
+        {
+            for(auto val : p)
+            {
+                ts.PushBack(val, alloc);
+            }
+        }
+        if( ts.Size() != numGridPoints )
+        {
+            throw std::logic_error("Time-resolved profile must have as many "
+                                   "data points as grid points.");
+        }
+        doc_["pathwayProfileTimeResolved"].AddMember(toVal(col.first), ts, alloc);
+    }
+}
+
+
 /*!
  * Writes the JSON document to a file of the given name.
  */
@@ -23,6 +23,7 @@
 
 
 #include <map>
+#include <stdexcept>
 #include <string>
 
 #include "path-finding/abstract_path_finder.hpp"
@@ -32,12 +33,18 @@
  * Constructor sets parameter values to nonsensical values and flags to false.
  */
 PathFindingParameters::PathFindingParameters()
-    : probeStepLength_(-1.0)
+    : nbhCutoff_(-1.0)
+    , nbhCutoffIsSet_(false)
+    , probeStepLength_(-1.0)
     , probeStepLengthIsSet_(false)
     , maxProbeRadius_(-1.0)
     , maxProbeRadiusIsSet_(false)
     , maxProbeSteps_(0)
     , maxProbeStepsIsSet_(false)
+    , hullMargin_(-1.0)
+    , hullMarginIsSet_(false)
+    , predictorTolerance_(-1.0)
+    , predictorToleranceIsSet_(false)
 {
 
 }
@@ -87,6 +94,30 @@ PathFindingParameters::setMaxProbeSteps(int maxProbeSteps)
 }
 
 
+/*!
+ * Sets distance beyond the hull of the pathway forming atoms after which
+ * probe optimisation is terminated.
+ */
+void
+PathFindingParameters::setHullMargin(real hullMargin)
+{
+    hullMargin_ = hullMargin;
+    hullMarginIsSet_ = true;
+}
+
+
+/*!
+ * Sets the distance between predicted and optimised probe position beyond 
+ * which the probe position is optimised again with the full schedule.
+ */
+void
+PathFindingParameters::setPredictorTolerance(real predictorTolerance)
+{
+    predictorTolerance_ = predictorTolerance;
+    predictorToleranceIsSet_ = true;
+}
+
+
 /*!
  * Returns neighbourhood search cutoff.
  *
@@ -203,6 +234,64 @@ PathFindingParameters::maxProbeStepsIsSet() const
 }
 
 
+/*!
+ * Returns hull margin.
+ *
+ * \throws std::logic_error If parameter value unset/
+ */
+real
+PathFindingParameters::hullMargin() const
+{
+    if( hullMarginIsSet_ )
+    {
+        return hullMargin_;
+    }
+    else
+    {
+        throw std::logic_error("Parameter hullMargin is not set.");
+    }
+}
+
+
+/*!
+ * Returns flag indicating if hull margin has been set.
+ */
+bool
+PathFindingParameters::hullMarginIsSet() const
+{
+    return hullMarginIsSet_;
+}
+
+
+/*!
+ * Returns predictor tolerance.
+ *
+ * \throws std::logic_error If parameter value unset/
+ */
+real
+PathFindingParameters::predictorTolerance() const
+{
+    if( predictorToleranceIsSet_ )
+    {
+        return predictorTolerance_;
+    }
+    else
+    {
+        throw std::logic_error("Parameter predictorTolerance is not set.");
+    }
+}
+
+
+/*!
+ * Returns flag indicating if predictor tolerance has been set.
+ */
+bool
+PathFindingParameters::predictorToleranceIsSet() const
+{
+    return predictorToleranceIsSet_;
+}
+
+
 
 /*!
  * \brief Constructor to be used in initialiser list of derived classes. 
@@ -212,6 +301,7 @@ PathFindingParameters::maxProbeStepsIsSet() const
  */
 AbstractPathFinder::AbstractPathFinder(std::map<std::string, real> params)
     : params_(params)
+    , parametersSet_(false)
     , path_()
     , radii_()
 {
@@ -219,6 +309,20 @@ AbstractPathFinder::AbstractPathFinder(std::map<std::string, real> params)
 }
 
 
+/*!
+ * Determines the path radii at a given set of fixed path points rather than 
+ * finding a new path. Not all path finding methods support this, so the base
+ * class implementation throws an exception.
+ */
+void
+AbstractPathFinder::findPathRadii(
+        const std::vector<gmx::RVec>& /*pathPoints*/)
+{
+    throw std::logic_error("Path finding method does not support radius "
+                           "calculation along a fixed reference path.");
+}
+
+
 /*!
  * Returns a MolecularPath object constructed from the path finder's path 
  * points and radii. Basically a wrapper around the constructor of 
@@ -0,0 +1,383 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <lapacke.h>
+
+#include "path-finding/channel_axis_estimator.hpp"
+
+
+/*!
+ * Constructor sets the direction used in the first frame to choose the sign
+ * of the principal axis. If estimateDirection is false, this direction is 
+ * kept fixed and only the initial probe position is estimated. The 
+ * smoothing factor is the weight of the current frame and must lie in 
+ * \f$ (0, 1] \f$, where a value of one disables smoothing.
+ *
+ * \throws std::logic_error if the initial direction is a null vector or the
+ * smoothing factor is out of range.
+ */
+ChannelAxisEstimator::ChannelAxisEstimator(
+        const gmx::RVec &initDirection,
+        bool estimateDirection,
+        real smoothingFactor)
+    : estimateDirection_(estimateDirection)
+    , smoothingFactor_(smoothingFactor)
+    , isInitialised_(false)
+    , direction_(initDirection)
+    , probeOffset_(0.0, 0.0, 0.0)
+    , centre_(0.0, 0.0, 0.0)
+{
+    if( norm2(initDirection) <= 0.0 )
+    {
+        throw std::logic_error("Initial channel direction must not be a null "
+                               "vector.");
+    }
+    if( smoothingFactor <= 0.0 || smoothingFactor > 1.0 )
+    {
+        throw std::logic_error("Smoothing factor must be larger than zero and "
+                               "not larger than one.");
+    }
+    unitv(direction_, direction_);
+}
+
+
+/*!
+ * Updates the estimates of channel direction and initial probe position with
+ * the pore forming atoms in the current frame. The membrane positions may be
+ * empty, in which case the direction is estimated from the pore forming 
+ * atoms alone.
+ *
+ * \throws std::logic_error if no pore forming atoms are given or the number
+ * of radii does not match the number of atoms.
+ */
+void
+ChannelAxisEstimator::update(
+        const std::vector<gmx::RVec> &porePositions,
+        const std::vector<real> &vdwRadii,
+        const std::vector<gmx::RVec> &membranePositions)
+{
+    // sanity checks:
+    if( porePositions.empty() || porePositions.size() != vdwRadii.size() )
+    {
+        throw std::logic_error("Channel axis estimation requires a non-empty "
+                               "set of positions with one radius each.");
+    }
+
+    // principal axes of pore forming group:
+    gmx::RVec centre;
+    std::vector<real> variances;
+    std::vector<gmx::RVec> axes;
+    principalAxes(porePositions, centre, variances, axes);
+
+    // channel direction in this frame:
+    gmx::RVec direction = direction_;
+    if( estimateDirection_ )
+    {
+        direction = estimateDirection(variances, axes, membranePositions);
+        if( iprod(direction, direction_) < 0.0 )
+        {
+            svmul(-1.0, direction, direction);
+        }
+
+        // smooth over time:
+        if( isInitialised_ )
+        {
+            gmx::RVec diff;
+            rvec_sub(direction, direction_, diff);
+            svmul(smoothingFactor_, diff, diff);
+            rvec_add(direction_, diff, direction);
+            unitv(direction, direction);
+        }
+    }
+
+    // probe position relative to centre of pore forming group:
+    gmx::RVec probeOffset;
+    rvec_sub(
+            scanFreeDistance(porePositions, vdwRadii, centre, direction),
+            centre,
+            probeOffset);
+    if( isInitialised_ )
+    {
+        gmx::RVec diff;
+        rvec_sub(probeOffset, probeOffset_, diff);
+        svmul(smoothingFactor_, diff, diff);
+        rvec_add(probeOffset_, diff, probeOffset);
+    }
+
+    // store estimates:
+    direction_ = direction;
+    probeOffset_ = probeOffset;
+    centre_ = centre;
+    isInitialised_ = true;
+}
+
+
+/*!
+ * Returns the current estimate of the (unit) channel direction vector.
+ */
+gmx::RVec
+ChannelAxisEstimator::direction() const
+{
+    return direction_;
+}
+
+
+/*!
+ * Returns the current estimate of the initial probe position.
+ */
+gmx::RVec
+ChannelAxisEstimator::initProbePos() const
+{
+    gmx::RVec pos;
+    rvec_add(centre_, probeOffset_, pos);
+    return pos;
+}
+
+
+/*!
+ * Calculates the centre of geometry of the given positions as well as the 
+ * eigenvalues (i.e. variances along each axis) and eigenvectors of their 
+ * covariance matrix. Variances are returned in ascending order and the axes 
+ * are normalised.
+ *
+ * \throws std::logic_error if no positions are given.
+ * \throws std::runtime_error if the eigenvalue decomposition fails.
+ */
+void
+ChannelAxisEstimator::principalAxes(
+        const std::vector<gmx::RVec> &positions,
+        gmx::RVec &centre,
+        std::vector<real> &variances,
+        std::vector<gmx::RVec> &axes)
+{
+    if( positions.empty() )
+    {
+        throw std::logic_error("Principal axes require at least one "
+                               "position.");
+    }
+
+    // centre of geometry:
+    double c[DIM] = {0.0, 0.0, 0.0};
+    for(auto pos : positions)
+    {
+        for(int i = 0; i < DIM; i++)
+        {
+            c[i] += pos[i];
+        }
+    }
+    for(int i = 0; i < DIM; i++)
+    {
+        c[i] /= positions.size();
+        centre[i] = c[i];
+    }
+
+    // covariance matrix (column major, only upper triangle is used):
+    double cov[9] = {0.0};
+    for(auto pos : positions)
+    {
+        double d[DIM] = {pos[XX] - c[XX], pos[YY] - c[YY], pos[ZZ] - c[ZZ]};
+        for(int i = 0; i < DIM; i++)
+        {
+            for(int j = i; j < DIM; j++)
+            {
+                cov[i + 3*j] += d[i]*d[j];
+            }
+        }
+    }
+    for(auto &v : cov)
+    {
+        v /= positions.size();
+    }
+
+    // eigenvalue decomposition:
+    double eval[3];
+    int info = LAPACKE_dsyev(LAPACK_COL_MAJOR, 'V', 'U', 3, cov, 3, eval);
+    if( info != 0 )
+    {
+        throw std::runtime_error("Eigenvalue decomposition failed in "
+                                 "principal axis calculation.");
+    }
+
+    // eigenvectors are stored in columns:
+    variances.resize(DIM);
+    axes.resize(DIM);
+    for(int k = 0; k < DIM; k++)
+    {
+        variances[k] = eval[k];
+        axes[k] = gmx::RVec(cov[3*k], cov[3*k + 1], cov[3*k + 2]);
+        unitv(axes[k], axes[k]);
+    }
+}
+
+
+/*!
+ * Chooses the principal axis of the pore forming group that represents the
+ * channel direction in the current frame (without fixing its sign).
+ */
+gmx::RVec
+ChannelAxisEstimator::estimateDirection(
+        const std::vector<real> &variances,
+        const std::vector<gmx::RVec> &axes,
+        const std::vector<gmx::RVec> &membranePositions) const
+{
+    // membrane normal has smallest variance of membrane group:
+    if( membranePositions.size() >= DIM )
+    {
+        gmx::RVec membCentre;
+        std::vector<real> membVariances;
+        std::vector<gmx::RVec> membAxes;
+        principalAxes(membranePositions, membCentre, membVariances, membAxes);
+
+        // use pore axis closest to membrane normal:
+        int best = 0;
+        for(int k = 1; k < DIM; k++)
+        {
+            if( std::fabs(iprod(axes[k], membAxes[0])) > 
+                std::fabs(iprod(axes[best], membAxes[0])) )
+            {
+                best = k;
+            }
+        }
+        return axes[best];
+    }
+
+    // otherwise use axis with most distinct variance:
+    if( variances[1] - variances[0] > variances[2] - variances[1] )
+    {
+        return axes[0];
+    }
+    return axes[2];
+}
+
+
+/*!
+ * Scans a coarse cylindrical grid around the given axis for the point with 
+ * the largest free distance. Grid points are rejected as soon as their free 
+ * distance drops below the best value found so far, and atoms that can not 
+ * be closer than the current minimum are skipped without calculating the 
+ * square root of their distance.
+ */
+gmx::RVec
+ChannelAxisEstimator::scanFreeDistance(
+        const std::vector<gmx::RVec> &porePositions,
+        const std::vector<real> &vdwRadii,
+        const gmx::RVec &centre,
+        const gmx::RVec &direction) const
+{
+    // grid resolution:
+    const int numAxialSteps = 2;
+    const int numRadialSteps = 3;
+
+    // orthonormal vectors spanning plane perpendicular to axis:
+    int minDim = XX;
+    for(int i = YY; i < DIM; i++)
+    {
+        if( std::fabs(direction[i]) < std::fabs(direction[minDim]) )
+        {
+            minDim = i;
+        }
+    }
+    gmx::RVec unitVec(0.0, 0.0, 0.0);
+    unitVec[minDim] = 1.0;
+    gmx::RVec orthVecU;
+    cprod(direction, unitVec, orthVecU);
+    unitv(orthVecU, orthVecU);
+    gmx::RVec orthVecW;
+    cprod(direction, orthVecU, orthVecW);
+
+    // spread of atoms along and around axis:
+    real axialVar = 0.0;
+    real radialVar = 0.0;
+    real maxRadius = 0.0;
+    for(size_t i = 0; i < porePositions.size(); i++)
+    {
+        gmx::RVec d;
+        rvec_sub(porePositions[i], centre, d);
+        real a = iprod(d, direction);
+        axialVar += a*a;
+        radialVar += norm2(d) - a*a;
+        maxRadius = std::max(maxRadius, vdwRadii[i]);
+    }
+    real axialStep = std::sqrt(axialVar/porePositions.size())/numAxialSteps;
+    real radialStep = 0.5*std::sqrt(radialVar/porePositions.size())
+                    /numRadialSteps;
+
+    // find grid point with largest free distance:
+    gmx::RVec bestPoint = centre;
+    real bestDist = -std::numeric_limits<real>::infinity();
+    for(int i = -numAxialSteps; i <= numAxialSteps; i++)
+    {
+        for(int j = -numRadialSteps; j <= numRadialSteps; j++)
+        {
+            for(int k = -numRadialSteps; k <= numRadialSteps; k++)
+            {
+                // restrict grid to cylinder:
+                if( j*j + k*k > numRadialSteps*numRadialSteps )
+                {
+                    continue;
+                }
+                gmx::RVec point = centre;
+                for(int d = 0; d < DIM; d++)
+                {
+                    point[d] += i*axialStep*direction[d] 
+                              + j*radialStep*orthVecU[d] 
+                              + k*radialStep*orthVecW[d];
+                }
+
+                // free distance at this point:
+                real freeDist = std::numeric_limits<real>::infinity();
+                for(size_t a = 0; a < porePositions.size(); a++)
+                {
+                    real dist2 = distance2(point, porePositions[a]);
+                    real bound = freeDist + maxRadius;
+                    if( bound <= 0.0 || dist2 >= bound*bound )
+                    {
+                        continue;
+                    }
+                    freeDist = std::min(
+                            freeDist, 
+                            std::sqrt(dist2) - vdwRadii[a]);
+                    if( freeDist <= bestDist )
+                    {
+                        break;
+                    }
+                }
+
+                if( freeDist > bestDist )
+                {
+                    bestDist = freeDist;
+                    bestPoint = point;
+                }
+            }
+        }
+    }
+
+    return bestPoint;
+}
+
@@ -22,8 +22,11 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <map>
 
 #include <gromacs/math/vec.h>
 
@@ -49,6 +52,12 @@ InplaneOptimisedProbePathFinder::InplaneOptimisedProbePathFinder(
     , chanDirVec_(chanDirVec)
     , orthVecU_(0.0, 0.0, 0.0)
     , orthVecW_(0.0, 0.0, 0.0)
+    , useHull_(false)
+    , hullMargin_(0.0)
+    , hullLo_(-std::numeric_limits<real>::infinity())
+    , hullHi_(std::numeric_limits<real>::infinity())
+    , usePredictor_(false)
+    , predictorTolerance_(0.0)
 {
     // tolerance threshold for norm of vector (which should be unit vectors):
     real nonZeroTol = std::numeric_limits<real>::epsilon();
@@ -129,6 +138,21 @@ InplaneOptimisedProbePathFinder::setParameters(
     maxProbeRadius_ = params.maxProbeRadius();
     maxProbeSteps_ = params.maxProbeSteps();
 
+    // early termination outside hull only if margin is given:
+    if( params.hullMarginIsSet() )
+    {
+        hullMargin_ = params.hullMargin();
+        useHull_ = true;
+    }
+
+    // predictor-corrector optimisation only if tolerance is given:
+    // (a negative tolerance disables the prediction)
+    if( params.predictorToleranceIsSet() && params.predictorTolerance() >= 0.0 )
+    {
+        predictorTolerance_ = params.predictorTolerance();
+        usePredictor_ = true;
+    }
+
     // has cutoff been set by user:
     if( params.nbhCutoffIsSet() )
     {
@@ -147,6 +171,37 @@ InplaneOptimisedProbePathFinder::setParameters(
 }
 
 
+/*!
+ * Sets the points from which the coarse hull used for early termination of
+ * probe optimisation is formed. The hull is simply the interval spanned by 
+ * the projection of all points onto the channel direction vector (relative
+ * to the initial probe position). Should be called before findPath().
+ */
+void
+InplaneOptimisedProbePathFinder::setHullPoints(
+        const std::vector<gmx::RVec> &hullPoints)
+{
+    // find extent of points along channel direction:
+    hullLo_ = std::numeric_limits<real>::infinity();
+    hullHi_ = -std::numeric_limits<real>::infinity();
+    for(auto &point : hullPoints)
+    {
+        gmx::RVec dist;
+        rvec_sub(point, initProbePos_, dist);
+        real proj = iprod(dist, chanDirVec_);
+        hullLo_ = std::min(hullLo_, proj);
+        hullHi_ = std::max(hullHi_, proj);
+    }
+
+    // without points there is no hull:
+    if( hullPoints.empty() )
+    {
+        hullLo_ = -std::numeric_limits<real>::infinity();
+        hullHi_ = std::numeric_limits<real>::infinity();
+    }
+}
+
+
 /*!
  * Execute path-finding algorithm.
  */
@@ -180,6 +235,61 @@ InplaneOptimisedProbePathFinder::findPath()
 }
 
 
+/*!
+ * Determines the radius of the pathway at each of the given (fixed) path 
+ * points. Rather than advancing the probe, it is placed at each path point in
+ * turn and a single Nelder-Mead optimisation is carried out in the plane
+ * orthogonal to the channel direction vector. The optimisation is 
+ * warm-started from the in-plane offset found at the previous point, which is
+ * much cheaper than the simulated annealing used in findPath(). The path 
+ * points themselves remain unchanged and the radii are capped at the maximum
+ * probe radius.
+ */
+void
+InplaneOptimisedProbePathFinder::findPathRadii(
+        const std::vector<gmx::RVec> &pathPoints)
+{
+    // sanity check:
+    if( !parametersSet_ )
+    {
+        throw std::logic_error("Path finding parameters have not been set.");
+    }
+
+    // prepare neighborhood search:
+    prepareNeighborhoodSearch(
+            pbc_,
+            porePos_,
+            nbhCutoff_);
+
+    // cost function is minimal free distance function:
+    ObjectiveFunction objFun;
+    objFun = std::bind(&InplaneOptimisedProbePathFinder::findMinimalFreeDistance, 
+                       this, std::placeholders::_1);
+
+    // path points are kept as they are:
+    path_ = pathPoints;
+    radii_.clear();
+    radii_.reserve(pathPoints.size());
+
+    // optimise in plane at each point:
+    std::vector<real> warmStart = {0.0, 0.0};
+    for(auto &point : pathPoints)
+    {
+        crntProbePos_ = point;
+
+        NelderMeadModule nmm;
+        nmm.setObjFun(objFun);
+        nmm.setParams(params_);
+        nmm.setInitGuess(warmStart);
+        nmm.optimise();
+
+        // next optimisation starts from this offset:
+        warmStart = nmm.getOptimPoint().first;
+        radii_.push_back(std::min(nmm.getOptimPoint().second, maxProbeRadius_));
+    }
+}
+
+
 /*!
  * Optimise initial position of probe.
  */
@@ -267,36 +377,39 @@ InplaneOptimisedProbePathFinder::advanceAndOptimise(bool forward)
         crntProbePos_[YY] = crntProbePos_[YY] + probeStepLength_*direction[YY];
         crntProbePos_[ZZ] = crntProbePos_[ZZ] + probeStepLength_*direction[ZZ]; 
 
-        // optimise in plane through simulated annealing:
-        SimulatedAnnealingModule sam;
-        sam.setObjFun(objFun);
-        sam.setParams(params_);
-        sam.setInitGuess(initState);
-        sam.optimise();
+        // outside hull probe continues along channel direction unoptimised:
+        if( isOutsideHull(forward) )
+        {
+            real freeDist = findMinimalFreeDistance(initState);
+            numProbeSteps++;
+            path_.push_back(crntProbePos_);
+            radii_.push_back(freeDist);
+            if( numProbeSteps >= maxProbeSteps_ || freeDist > maxProbeRadius_ )
+            {
+                break;
+            }
+            continue;
+        }
 
-        // refine with Nelder-Mead optimisation:
-        NelderMeadModule nmm;
-        nmm.setObjFun(objFun);
-        nmm.setParams(params_);
-        nmm.setInitGuess(sam.getOptimPoint().first);
-        nmm.optimise();
+        // optimise in plane, starting from predicted position if possible:
+        OptimSpacePoint optimPoint = predictAndOptimise(objFun);
  
         // current position becomes best position in plane: 
-        crntProbePos_ = optimToConfig(nmm.getOptimPoint().first);
+        crntProbePos_ = optimToConfig(optimPoint.first);
                
         // increment probe step counter:
         numProbeSteps++;      
 
         // add result to path container: 
         path_.push_back(crntProbePos_);
-        radii_.push_back(nmm.getOptimPoint().second);     
+        radii_.push_back(optimPoint.second);     
 
         // check termination conditions:
         if( numProbeSteps >= maxProbeSteps_ )
         {
             break;
         }
-        if( nmm.getOptimPoint().second > maxProbeRadius_ )
+        if( optimPoint.second > maxProbeRadius_ )
         {
             break;
         }
@@ -307,6 +420,162 @@ InplaneOptimisedProbePathFinder::advanceAndOptimise(bool forward)
 }
 
 
+/*!
+ * Checks whether the current probe position lies beyond the coarse hull by
+ * more than the hull margin in the current marching direction. Always 
+ * returns false if no hull margin has been set.
+ */
+bool
+InplaneOptimisedProbePathFinder::isOutsideHull(bool forward)
+{
+    // early termination not requested:
+    if( !useHull_ )
+    {
+        return false;
+    }
+
+    // position of probe along channel direction:
+    gmx::RVec dist;
+    rvec_sub(crntProbePos_, initProbePos_, dist);
+    real proj = iprod(dist, chanDirVec_);
+
+    // compare to hull extent in marching direction:
+    if( forward )
+    {
+        return proj > hullHi_ + hullMargin_;
+    }
+    else
+    {
+        return proj < hullLo_ - hullMargin_;
+    }
+}
+
+
+/*!
+ * Predicts the optimal probe position in the current plane from the most 
+ * recent path points, which lie in planes spaced by the probe step length. 
+ * With five or more points, a least squares quadratic is fitted to the last 
+ * five points and extrapolated by one step, which smoothes out noise from the
+ * optimisation. With three or four points, the quadratic through the last 
+ * three points is used and with two points the prediction is linear. As the
+ * weights of these extrapolations sum to one, the prediction lies in the 
+ * current plane and is returned in terms of the in-plane basis vectors.
+ */
+std::vector<real>
+InplaneOptimisedProbePathFinder::predictInplanePos()
+{
+    // extrapolation weights, oldest point first:
+    std::vector<real> weights;
+    if( path_.size() >= 5 )
+    {
+        weights = {0.6, -0.6, -0.8, 0.0, 1.8};
+    }
+    else if( path_.size() >= 3 )
+    {
+        weights = {1.0, -3.0, 3.0};
+    }
+    else if( path_.size() == 2 )
+    {
+        weights = {-1.0, 2.0};
+    }
+    else
+    {
+        return std::vector<real>({0.0, 0.0});
+    }
+
+    // extrapolate from most recent points:
+    gmx::RVec pred(0.0, 0.0, 0.0);
+    size_t offset = path_.size() - weights.size();
+    for(size_t i = 0; i < weights.size(); i++)
+    {
+        gmx::RVec tmp;
+        svmul(weights[i], path_[offset + i], tmp);
+        rvec_inc(pred, tmp);
+    }
+
+    // project onto plane:
+    gmx::RVec dist;
+    rvec_sub(pred, crntProbePos_, dist);
+    return std::vector<real>({iprod(dist, orthVecU_), iprod(dist, orthVecW_)});
+}
+
+
+/*!
+ * Optimises the probe position in the current plane. If the predictor is 
+ * enabled and at least two path points are available, a short optimisation 
+ * is started from the predicted position and its result is accepted if it 
+ * lies within the predictor tolerance of the prediction. Otherwise the full 
+ * optimisation is carried out starting from the straight advance of the 
+ * probe.
+ */
+OptimSpacePoint
+InplaneOptimisedProbePathFinder::predictAndOptimise(ObjectiveFunction objFun)
+{
+    // start from predicted position if possible:
+    if( usePredictor_ && path_.size() > 1 )
+    {
+        std::vector<real> predState = predictInplanePos();
+        OptimSpacePoint optimPoint = optimiseInPlane(objFun, predState, true);
+
+        // accept unless optimum moved far from prediction:
+        OptimSpacePoint predPoint;
+        predPoint.first = predState;
+        real tolSq = predictorTolerance_*predictorTolerance_;
+        if( optimPoint.dist2(predPoint) <= tolSq )
+        {
+            return optimPoint;
+        }
+    }
+
+    // otherwise optimise with full schedule from straight advance:
+    return optimiseInPlane(objFun, std::vector<real>({0.0, 0.0}), false);
+}
+
+
+/*!
+ * Maximises the free distance in the current plane by simulated annealing 
+ * followed by Nelder-Mead refinement, starting from the given initial guess.
+ * If shortSchedule is true, the annealing is carried out for a tenth of the 
+ * usual number of cooling iterations and the initial simplex is no larger
+ * than the predictor tolerance, which confines the search to the vicinity of
+ * the initial guess.
+ */
+OptimSpacePoint
+InplaneOptimisedProbePathFinder::optimiseInPlane(
+        ObjectiveFunction objFun,
+        std::vector<real> initGuess,
+        bool shortSchedule)
+{
+    // reduce search effort and radius for short schedule:
+    std::map<std::string, real> params = params_;
+    if( shortSchedule )
+    {
+        params["saMaxCoolingIter"] = std::ceil(0.1*params["saMaxCoolingIter"]);
+        if( params.find("nmInitShift") == params.end() || 
+            params["nmInitShift"] > predictorTolerance_ )
+        {
+            params["nmInitShift"] = predictorTolerance_;
+        }
+    }
+
+    // optimise in plane through simulated annealing:
+    SimulatedAnnealingModule sam;
+    sam.setObjFun(objFun);
+    sam.setParams(params);
+    sam.setInitGuess(initGuess);
+    sam.optimise();
+
+    // refine with Nelder-Mead optimisation:
+    NelderMeadModule nmm;
+    nmm.setObjFun(objFun);
+    nmm.setParams(params);
+    nmm.setInitGuess(sam.getOptimPoint().first);
+    nmm.optimise();
+
+    return nmm.getOptimPoint();
+}
+
+
 /*!
  * Converts between the two-dimensional optimisation space representation to 
  * the three-dimensional configuration space representation. A point in 
@@ -73,6 +73,7 @@ MolecularPath::MolecularPath(std::vector<gmx::RVec> &pathPoints,
 
     // get arc length at original control points:
     std::vector<real> arcLen = centreLine_.ctrlPointArcLength();
+    pathArcLen_ = arcLen;
     openingLo_ = arcLen.front();
     openingHi_ = arcLen.back();
     length_ = std::abs(openingHi_ - openingLo_);
@@ -183,6 +184,9 @@ MolecularPath::MolecularPath(
                 doc["molPathRadiusSpline"]["ctrl"][i].GetDouble() );
     } 
 
+    // unique radius knots are arc length at original points:
+    pathArcLen_ = poreRadiusKnots;
+
     // add duplicate knots at endpoints:
     int poreRadiusSplineDegree = 3; // TODO: should not be hardcoded
     poreRadiusKnots.insert(
@@ -252,6 +256,31 @@ MolecularPath::~MolecularPath()
 }
 
 
+/*!
+ * Maps a single Cartesian position onto the centre line spline curve. The 
+ * return value contains the arc length, squared distance from the centre 
+ * line, and angle (currently always zero) of the point.
+ */
+gmx::RVec
+MolecularPath::mapPosition(const gmx::RVec &position)
+{
+    return centreLine_.cartesianToCurvilinear(position);
+}
+
+
+/*!
+ * Maps a single Cartesian position onto the centre line spline curve, given 
+ * an estimate of its arc length coordinate. This is faster than searching the
+ * entire centre line if the estimate is good, e.g. because it is the arc 
+ * length of a nearby point (see SplineCurve3D::cartesianToCurvilinear()).
+ */
+gmx::RVec
+MolecularPath::mapPosition(const gmx::RVec &position, real sHint)
+{
+    return centreLine_.cartesianToCurvilinear(position, sHint);
+}
+
+
 /*!
  * Function for mapping a set of Cartesian positions onto the centre line 
  * spline curve.
@@ -301,6 +330,19 @@ MolecularPath::mapSelection(const gmx::Selection &mapSel)
 }
 
 
+/*!
+ * Precomputes a lookup grid for mapping positions onto the centre line (see
+ * SplineCurve3D::prepareMappingGrid()). This is worthwhile if the pathway is
+ * used to map particles in many frames, as is the case for a fixed reference
+ * pathway. The grid is shared by all copies of this path.
+ */
+void
+MolecularPath::prepareMappingGrid(real tubeRadius, real voxelSize)
+{
+    centreLine_.prepareMappingGrid(tubeRadius, voxelSize);
+}
+
+
 /*!
  * Checks if points described by a set of mapped coordinates lie within the 
  * MolecularPath. 
@@ -409,8 +451,8 @@ MolecularPath::scalarProperties() const
  * Simple getter function for access to original path points used to construct
  * the path.
  */
-std::vector<gmx::RVec>
-MolecularPath::pathPoints()
+const std::vector<gmx::RVec>&
+MolecularPath::pathPoints() const
 {
     return pathPoints_;
 }
@@ -420,28 +462,52 @@ MolecularPath::pathPoints()
  * Simple getter function for access to original radii used to construct the 
  * path.
  */
-std::vector<real>
-MolecularPath::pathRadii()
+const std::vector<real>&
+MolecularPath::pathRadii() const
 {
     return pathRadii_;
 }
 
 
 /*!
- * Returns a copy of the internal pore radius spline.
+ * Replaces the radii at the original path points and re-interpolates the 
+ * radius spline, while the centre line (and hence the arc length coordinate
+ * of the original points and any data used for mapping particles onto the
+ * centre line) remains unchanged. This is used to update the radius profile 
+ * along a fixed reference pathway.
+ */
+void
+MolecularPath::setPathRadii(const std::vector<real> &pathRadii)
+{
+    // sanity check:
+    if( pathRadii.size() != pathArcLen_.size() )
+    {
+        throw std::logic_error("Number of radii passed to MolecularPath does "
+                               "not match number of path points.");
+    }
+
+    // interpolate radius over arc length at original points:
+    pathRadii_ = pathRadii;
+    CubicSplineInterp1D Interp1D;
+    poreRadius_ = Interp1D(pathArcLen_, pathRadii_, eSplineInterpBoundaryHermite);
+}
+
+
+/*!
+ * Returns a reference to the internal pore radius spline.
  */
-SplineCurve1D
-MolecularPath::pathRadius()
+const SplineCurve1D&
+MolecularPath::pathRadius() const
 {
     return poreRadius_;
 }
 
 
 /*!
- * Returns a copy of the internal centre line spline.
+ * Returns a reference to the internal centre line spline.
  */
-SplineCurve3D
-MolecularPath::centreLine()
+const SplineCurve3D&
+MolecularPath::centreLine() const
 {
     return centreLine_;
 }
@@ -493,7 +559,7 @@ MolecularPath::sHi()
  * Getter method for access to the radius spline's knot vector. This returns 
  * the complete knot vector including duplicate points at the ends.
  */
-std::vector<real>
+const std::vector<real>&
 MolecularPath::poreRadiusKnots() const
 {
     return poreRadius_.knotVector();
@@ -508,7 +574,7 @@ MolecularPath::poreRadiusKnots() const
 std::vector<real>
 MolecularPath::poreRadiusUniqueKnots() const
 {           
-    std::vector<real> allKnots = poreRadius_.knotVector();
+    const std::vector<real> &allKnots = poreRadius_.knotVector();
     std::vector<real> uniqueKnots(
         allKnots.begin() + poreRadius_.degree() - 1, 
         allKnots.end() - poreRadius_.degree() + 1);
@@ -519,7 +585,7 @@ MolecularPath::poreRadiusUniqueKnots() const
 /*!
  * Getter method for access to the radius spline's control points.
  */
-std::vector<real>
+const std::vector<real>&
 MolecularPath::poreRadiusCtrlPoints() const
 {
     return poreRadius_.ctrlPoints();
@@ -531,7 +597,7 @@ MolecularPath::poreRadiusCtrlPoints() const
  * This returns  the complete knot vector including duplicate points at the 
  * ends.
  */
-std::vector<real>
+const std::vector<real>&
 MolecularPath::centreLineKnots() const
 {
     return centreLine_.knotVector();
@@ -546,7 +612,7 @@ MolecularPath::centreLineKnots() const
 std::vector<real>
 MolecularPath::centreLineUniqueKnots() const
 {
-    std::vector<real> allKnots = centreLine_.knotVector();
+    const std::vector<real> &allKnots = centreLine_.knotVector();
     std::vector<real> uniqueKnots(
             allKnots.begin() + centreLine_.degree() - 1,
             allKnots.end() - centreLine_.degree() + 1);
@@ -557,7 +623,7 @@ MolecularPath::centreLineUniqueKnots() const
 /*!
  * Getter method for access to the centre line spline's control points.
  */
-std::vector<gmx::RVec>
+const std::vector<gmx::RVec>&
 MolecularPath::centreLineCtrlPoints() const
 {
     return centreLine_.ctrlPoints();
@@ -935,6 +1001,10 @@ MolecularPath::shift(const gmx::RVec &shift)
     // adjust convenience variables defined in MolecularPath itself:
     openingLo_ -= shift[SS];
     openingHi_ -= shift[SS];
+    for(auto &arcLen : pathArcLen_)
+    {
+        arcLen -= shift[SS];
+    }
 }
 
 
@@ -0,0 +1,165 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <stdexcept>
+
+#include "path-finding/pore_residue_mapper.hpp"
+
+
+/*!
+ * Constructor sets the margin added to the pore radius when deciding whether
+ * a residue is pore-lining.
+ */
+PoreResidueMapper::PoreResidueMapper(
+        const real margin)
+    : margin_(margin)
+{
+
+}
+
+
+/*!
+ * Maps all residues onto the given pathway. The C-alpha atom coordinates and 
+ * offsets may be empty, in which case no residue will be considered 
+ * pore-facing. If a periodic boundary condition object is given, residues 
+ * are made whole before computing their centre of geometry.
+ *
+ * \throws std::logic_error if the offset vectors are inconsistent with the 
+ * atom coordinates or with each other.
+ */
+std::vector<MappedResidue>
+PoreResidueMapper::operator()(
+        const std::vector<gmx::RVec> &cogAtoms,
+        const std::vector<size_t> &cogOffsets,
+        const std::vector<gmx::RVec> &calAtoms,
+        const std::vector<size_t> &calOffsets,
+        MolecularPath &molPath,
+        SplineCurve1D &solventDensity,
+        const t_pbc *pbc)
+{
+    // sanity checks:
+    if( cogOffsets.empty() || cogOffsets.back() != cogAtoms.size() )
+    {
+        throw std::logic_error("Residue offsets do not match number of atoms.");
+    }
+    bool haveCal = !calOffsets.empty();
+    if( haveCal && 
+        (calOffsets.size() != cogOffsets.size() || 
+         calOffsets.back() != calAtoms.size()) )
+    {
+        throw std::logic_error("C-alpha offsets do not match residues or "
+                               "number of atoms.");
+    }
+
+    // single pass over all residues:
+    size_t numResidues = cogOffsets.size() - 1;
+    std::vector<MappedResidue> residues(numResidues);
+    for(size_t i = 0; i < numResidues; i++)
+    {
+        MappedResidue &res = residues[i];
+
+        // map centre of geometry onto centre line:
+        res.cog_ = centreOfGeometry(
+                cogAtoms, 
+                cogOffsets[i], 
+                cogOffsets[i + 1], 
+                pbc);
+        res.mappedCog_ = molPath.mapPosition(res.cog_);
+        real s = res.mappedCog_[SS];
+
+        // pathway properties at residue position:
+        res.poreRadius_ = molPath.radius(s);
+        res.solventDensity_ = solventDensity.evaluate(s, 0);
+
+        // radial coordinate is squared, so threshold must be too:
+        real thres = res.poreRadius_ + margin_;
+        res.poreLining_ = res.mappedCog_[RR] < thres*thres;
+
+        // C-alpha is close to COG, so start mapping from there:
+        res.poreFacing_ = false;
+        res.mappedCal_ = gmx::RVec(0.0, 0.0, 0.0);
+        if( haveCal )
+        {
+            gmx::RVec cal = centreOfGeometry(
+                    calAtoms, 
+                    calOffsets[i], 
+                    calOffsets[i + 1], 
+                    pbc);
+            res.mappedCal_ = molPath.mapPosition(cal, s);
+            res.poreFacing_ = res.poreLining_ && 
+                              res.mappedCog_[RR] < res.mappedCal_[RR];
+        }
+    }
+
+    return residues;
+}
+
+
+/*!
+ * Computes the centre of geometry of the atoms in the half-open index range
+ * from begin to end. If a periodic boundary condition object is given, atom
+ * positions are taken relative to the first atom of the range using the 
+ * minimum image convention, so that residues split across the box boundary
+ * are handled correctly.
+ *
+ * \throws std::logic_error if the range is empty.
+ */
+gmx::RVec
+PoreResidueMapper::centreOfGeometry(
+        const std::vector<gmx::RVec> &atoms,
+        size_t begin,
+        size_t end,
+        const t_pbc *pbc)
+{
+    if( end <= begin )
+    {
+        throw std::logic_error("Cannot compute centre of geometry of residue "
+                               "without atoms.");
+    }
+
+    // sum up displacements from first atom:
+    gmx::RVec sum(0.0, 0.0, 0.0);
+    for(size_t j = begin + 1; j < end; j++)
+    {
+        gmx::RVec dx;
+        if( pbc != nullptr )
+        {
+            pbc_dx_aiuc(pbc, atoms[j], atoms[begin], dx);
+        }
+        else
+        {
+            rvec_sub(atoms[j], atoms[begin], dx);
+        }
+        rvec_inc(sum, dx);
+    }
+
+    // average displacement gives centre:
+    gmx::RVec cog;
+    svmul(1.0/(end - begin), sum, cog);
+    rvec_inc(cog, atoms[begin]);
+    return cog;
+}
+
@@ -0,0 +1,230 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+
+#include "fourier/fast_fourier_transform.hpp"
+#include "path-finding/radius_profile_registration.hpp"
+
+
+/*!
+ * Constructor sets the arc length spacing of the sampled profiles.
+ *
+ * \throws std::logic_error if the resolution is not positive.
+ */
+RadiusProfileRegistration::RadiusProfileRegistration(real resolution)
+    : resolution_(resolution)
+    , refLo_(0.0)
+{
+    if( resolution_ <= 0.0 )
+    {
+        throw std::logic_error("Resolution of radius profile registration "
+                               "must be positive.");
+    }
+}
+
+
+/*!
+ * Returns the shift \f$ d \f$ that needs to be subtracted from the arc length
+ * of the given profile to align it with the reference, i.e. the profile value
+ * at \f$ s \f$ corresponds to the reference value at \f$ s - d \f$. If there
+ * is no reference yet, the returned shift is zero.
+ */
+real
+RadiusProfileRegistration::operator()(
+        const std::vector<real> &profile,
+        real sLo) const
+{
+    if( !hasReference() || profile.empty() )
+    {
+        return 0.0;
+    }
+
+    // reference profile:
+    std::vector<real> reference = this -> reference();
+    int numRef = reference.size();
+    int numProf = profile.size();
+
+    // means of profiles:
+    real meanRef = 0.0;
+    for(auto r : reference)
+    {
+        meanRef += r;
+    }
+    meanRef /= numRef;
+    real meanProf = 0.0;
+    for(auto r : profile)
+    {
+        meanProf += r;
+    }
+    meanProf /= numProf;
+
+    // zero-padded mean-free profiles:
+    // (padding to at least the sum of both lengths avoids circular overlap)
+    size_t n = FastFourierTransform::fastSize(numRef + numProf - 1);
+    std::vector<std::complex<real>> refData(n, 0.0);
+    std::vector<std::complex<real>> profData(n, 0.0);
+    for(int i = 0; i < numRef; i++)
+    {
+        refData[i] = reference[i] - meanRef;
+    }
+    for(int i = 0; i < numProf; i++)
+    {
+        profData[i] = profile[i] - meanProf;
+    }
+
+    // cross-correlation for all lags by FFT:
+    FastFourierTransform fft(n);
+    fft(refData, eFftDirectionForward);
+    fft(profData, eFftDirectionForward);
+    for(size_t i = 0; i < n; i++)
+    {
+        profData[i] *= std::conj(refData[i]);
+    }
+    fft(profData, eFftDirectionBackward);
+
+    // correlation at lag l normalised by number of overlapping points:
+    // (the profile at index k + l is compared to the reference at index k)
+    int minOverlap = (std::min(numRef, numProf) + 1)/2;
+    auto correlation = [&](int lag)
+    {
+        int overlap = std::min(numRef - 1, numProf - 1 - lag) 
+                    - std::max(0, -lag) + 1;
+        if( overlap < minOverlap )
+        {
+            return -std::numeric_limits<real>::infinity();
+        }
+        return profData[(lag + n) % n].real()/overlap;
+    };
+
+    // find lag with maximum correlation:
+    int bestLag = 0;
+    real bestCorr = -std::numeric_limits<real>::infinity();
+    for(int lag = -(numRef - 1); lag <= numProf - 1; lag++)
+    {
+        real corr = correlation(lag);
+        if( corr > bestCorr )
+        {
+            bestCorr = corr;
+            bestLag = lag;
+        }
+    }
+
+    // refine by fitting parabola through neighbouring lags:
+    real subLag = 0.0;
+    real corrLo = correlation(bestLag - 1);
+    real corrHi = correlation(bestLag + 1);
+    real curvature = corrLo - 2.0*bestCorr + corrHi;
+    if( std::isfinite(curvature) && curvature < 0.0 )
+    {
+        subLag = 0.5*(corrLo - corrHi)/curvature;
+    }
+
+    return sLo - refLo_ + (bestLag + subLag)*resolution_;
+}
+
+
+/*!
+ * Adds an aligned profile to the running mean reference profile. The first 
+ * profile defines the reference grid, subsequent profiles only contribute 
+ * where they overlap with it.
+ */
+void
+RadiusProfileRegistration::update(
+        const std::vector<real> &profile,
+        real sLo)
+{
+    if( profile.empty() )
+    {
+        return;
+    }
+
+    // first profile defines reference grid:
+    if( !hasReference() )
+    {
+        refLo_ = sLo;
+        refSum_ = profile;
+        refCount_.assign(profile.size(), 1);
+        return;
+    }
+
+    // interpolate profile onto reference grid:
+    for(size_t k = 0; k < refSum_.size(); k++)
+    {
+        real x = (refLo_ + k*resolution_ - sLo)/resolution_;
+        if( x < 0.0 || x > profile.size() - 1 )
+        {
+            continue;
+        }
+        size_t i = std::min<size_t>(std::floor(x), profile.size() - 1);
+        real w = x - i;
+        real value = profile[i];
+        if( i + 1 < profile.size() )
+        {
+            value = (1.0 - w)*profile[i] + w*profile[i + 1];
+        }
+        refSum_[k] += value;
+        refCount_[k] += 1;
+    }
+}
+
+
+/*!
+ * Returns true once a reference profile has been set.
+ */
+bool
+RadiusProfileRegistration::hasReference() const
+{
+    return !refSum_.empty();
+}
+
+
+/*!
+ * Returns the arc length spacing of profiles.
+ */
+real
+RadiusProfileRegistration::resolution() const
+{
+    return resolution_;
+}
+
+
+/*!
+ * Returns the current (mean) reference profile.
+ */
+std::vector<real>
+RadiusProfileRegistration::reference() const
+{
+    std::vector<real> reference(refSum_.size());
+    for(size_t k = 0; k < refSum_.size(); k++)
+    {
+        reference[k] = refSum_[k]/refCount_[k];
+    }
+    return reference;
+}
+
@@ -0,0 +1,247 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "statistics/covariance_statistics.hpp"
+
+
+/*!
+ * Initialises all statistics and the sample counter as zero.
+ */
+CovarianceStatistics::CovarianceStatistics()
+    : meanX_(0.0)
+    , meanY_(0.0)
+    , sumSqX_(0.0)
+    , sumSqY_(0.0)
+    , sumXY_(0.0)
+    , num_(0)
+{
+
+}
+
+
+/*!
+ * Updates the means and sums of (cross) products of differences from the 
+ * mean with a new pair of values.
+ */
+void
+CovarianceStatistics::update(
+        const real x, 
+        const real y)
+{
+    // handle infinities:
+    if( std::isinf(x) || std::isinf(y) )
+    {
+        return;
+    }
+
+    // increment number of samples:
+    num_++;
+
+    // update means:
+    double deltaX = x - meanX_;
+    double deltaY = y - meanY_;
+    meanX_ += deltaX/num_;
+    meanY_ += deltaY/num_;
+
+    // update sums of products of differences from mean:
+    sumSqX_ += deltaX*(x - meanX_);
+    sumSqY_ += deltaY*(y - meanY_);
+    sumXY_ += deltaX*(y - meanY_);
+}
+
+
+/*!
+ * Convenience function to update a vector of CovarianceStatistics with a 
+ * vector of first variables and a common second variable. Only elements for
+ * which the corresponding entry of include is true are updated, e.g. to 
+ * restrict the correlation to frames in which a residue is pore-lining.
+ */
+void
+CovarianceStatistics::updateMultiple(
+        std::vector<CovarianceStatistics> &stat,
+        const std::vector<real> &x,
+        const real y,
+        const std::vector<bool> &include)
+{
+    // sanity check:
+    if( stat.size() != x.size() || stat.size() != include.size() )
+    {
+        throw std::logic_error("Can not update covariance statistics vector "
+                               "with data vector of different size.");
+    }
+
+    // update included values individually:
+    for(size_t i = 0; i < stat.size(); i++)
+    {
+        if( include[i] )
+        {
+            stat[i].update(x[i], y);
+        }
+    }
+}
+
+
+/*!
+ * Ranks a vector of CovarianceStatistics by absolute correlation, starting
+ * from one for the strongest correlation. Elements with fewer than two 
+ * samples have no meaningful correlation and are assigned rank zero, i.e. 
+ * they are left out of the ranking. Ties keep their original order.
+ */
+std::vector<int>
+CovarianceStatistics::rankByCorrelation(
+        const std::vector<CovarianceStatistics> &stat)
+{
+    // indices of elements with a defined correlation:
+    std::vector<size_t> order;
+    order.reserve(stat.size());
+    for(size_t i = 0; i < stat.size(); i++)
+    {
+        if( stat[i].num() >= 2 )
+        {
+            order.push_back(i);
+        }
+    }
+
+    // sort by absolute correlation:
+    std::stable_sort(
+            order.begin(), 
+            order.end(),
+            [&stat](size_t a, size_t b)
+            {
+                return std::fabs(stat[a].corr()) > std::fabs(stat[b].corr());
+            });
+
+    // unranked elements are zero:
+    std::vector<int> rank(stat.size(), 0);
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        rank[order[i]] = i + 1;
+    }
+
+    return rank;
+}
+
+
+/*!
+ * Merges the statistics of another (disjoint) set of samples into this one
+ * using the pairwise update formulae of Chan et al. (1979).
+ */
+void
+CovarianceStatistics::merge(
+        const CovarianceStatistics &other)
+{
+    // nothing to merge:
+    if( other.num_ == 0 )
+    {
+        return;
+    }
+    if( num_ == 0 )
+    {
+        *this = other;
+        return;
+    }
+
+    // combined number of samples:
+    double numA = num_;
+    double numB = other.num_;
+    double numAB = numA + numB;
+
+    // update means and sums of products of differences from mean:
+    double deltaX = other.meanX_ - meanX_;
+    double deltaY = other.meanY_ - meanY_;
+    double factor = numA*numB/numAB;
+    sumSqX_ += other.sumSqX_ + deltaX*deltaX*factor;
+    sumSqY_ += other.sumSqY_ + deltaY*deltaY*factor;
+    sumXY_ += other.sumXY_ + deltaX*deltaY*factor;
+    meanX_ += deltaX*numB/numAB;
+    meanY_ += deltaY*numB/numAB;
+    num_ += other.num_;
+}
+
+
+/*!
+ * Getter method for obtaining the mean of the first variable.
+ */
+real
+CovarianceStatistics::meanX() const
+{
+    return meanX_;
+}
+
+
+/*!
+ * Getter method for obtaining the mean of the second variable.
+ */
+real
+CovarianceStatistics::meanY() const
+{
+    return meanY_;
+}
+
+
+/*!
+ * Getter method for obtaining the (sample) covariance. Returns zero if fewer
+ * than two samples are available.
+ */
+real
+CovarianceStatistics::cov() const
+{
+    if( num_ < 2 )
+    {
+        return 0.0;
+    }
+    return sumXY_/(num_ - 1.0);
+}
+
+
+/*!
+ * Getter method for obtaining the Pearson correlation coefficient. Returns 
+ * zero if fewer than two samples are available or if either variable is 
+ * constant.
+ */
+real
+CovarianceStatistics::corr() const
+{
+    if( num_ < 2 || sumSqX_ <= 0.0 || sumSqY_ <= 0.0 )
+    {
+        return 0.0;
+    }
+    return sumXY_/std::sqrt(sumSqX_*sumSqY_);
+}
+
+
+/*!
+ * Getter method for obtaining the number of samples.
+ */
+int
+CovarianceStatistics::num() const
+{
+    return num_;
+}
+
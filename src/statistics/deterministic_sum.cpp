@@ -0,0 +1,77 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "statistics/deterministic_sum.hpp"
+
+
+/*!
+ * Returns the sum of all values obtained by pairwise summation.
+ */
+real
+DeterministicSum::pairwise(
+        const std::vector<real> &values)
+{
+    return pairwiseRange(values.data(), values.size());
+}
+
+
+/*!
+ * Returns the sum of all values obtained by pairwise summation without 
+ * rounding it to real. Subtree sums obtained in this way can be combined 
+ * exactly as in the summation over the whole range.
+ */
+double
+DeterministicSum::pairwiseDouble(
+        const std::vector<real> &values)
+{
+    return pairwiseRange(values.data(), values.size());
+}
+
+
+/*!
+ * Sums a range of values sequentially if it is short enough and otherwise
+ * splits it into two halves which are summed recursively.
+ */
+double
+DeterministicSum::pairwiseRange(
+        const real *values, 
+        size_t num)
+{
+    // short ranges are summed sequentially:
+    if( num <= cLeafSize_ )
+    {
+        double sum = 0.0;
+        for(size_t i = 0; i < num; i++)
+        {
+            sum += values[i];
+        }
+        return sum;
+    }
+
+    // split longer ranges in half:
+    size_t half = num/2;
+    return pairwiseRange(values, half) + 
+           pairwiseRange(values + half, num - half);
+}
+
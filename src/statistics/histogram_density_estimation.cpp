@@ -23,6 +23,7 @@
 
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <stdexcept>
 #include <string>
@@ -59,26 +60,11 @@ HistogramDensityEstimator::estimate(
         throw std::logic_error("Histogram bin width must be a positive number!");
     }
 
-    // make sure input data is sorted:
-    std::sort(samples.begin(), samples.end());
-
     // set up break points for this data set: 
     std::vector<real> breaks = createBreaks(samples);
 
     // compute midpoints corresponding to these breakpoints:
     std::vector<real> midpoints = createMidpoints(breaks);
-
-    // emergency break for histogram size:
-    // (If number of bins gets too large, the spline interpolation code will
-    // fail with a segfault. This hardcoded limit is supposed to prevent that 
-    // situation, but in practice the reasonable size limit for number of 
-    // histogram bins is probably lower due to performance constraints.)
-    size_t maxBinNumber = 25000;
-    if( midpoints.size() > maxBinNumber )
-    {
-        throw std::runtime_error("Number of bins exceeds limit for spline "
-        "interpolation! Need to increase bin width.");
-    }
     
     // calculate density:
     std::vector<real> density = calculateDensity(samples, breaks);
@@ -153,7 +139,7 @@ HistogramDensityEstimator::setBinWidth(
  * that the entire data range is covered and that the first and last bin are
  * always empty. This convention simplifies the construction of the 
  * SplineCurve1D interpolating the density, which will employs simple constant
- * extrapolation.
+ * extrapolation. The samples need not be sorted.
  */
 std::vector<real>
 HistogramDensityEstimator::createBreaks(
@@ -164,8 +150,9 @@ HistogramDensityEstimator::createBreaks(
     real rangeHi = 0.0;
     if( samples.size() != 0 )
     {
-        rangeLo = samples.front();
-        rangeHi = samples.back();
+        auto range = std::minmax_element(samples.begin(), samples.end());
+        rangeLo = *range.first;
+        rangeHi = *range.second;
     }
 
     // will shift by half a bin width past lower endpoint:
@@ -213,10 +200,11 @@ HistogramDensityEstimator::createMidpoints(
 /*!
  * Auxiliary function for calculating the probability density in each bin 
  * (strictly speaking this is a probability mass function rather than a 
- * probability density function). This function loops over the vector of break
- * points and in each interval counts the number of samples that fall into this
- * interval. The counts are then normalised by the number of samples to obtain
- * density. The function assumes that the set of samples is sorted. 
+ * probability density function). Each sample is assigned to the interval
+ * (breaks[i], breaks[i+1]] directly from its distance to the first break 
+ * point, so that the cost is linear in the number of samples and bins and the
+ * samples need not be sorted. The integer counts are then normalised by the 
+ * number of samples to obtain density. 
  */
 std::vector<real>
 HistogramDensityEstimator::calculateDensity(
@@ -232,25 +220,30 @@ HistogramDensityEstimator::calculateDensity(
         return density;
     }
 
-    // loop over intervals and count samples:
-    std::vector<int> counts;
-    counts.reserve(breaks.size() - 1);
-    auto boundLo = samples.begin();
-    auto boundHi = samples.end();
-    for(size_t i = 0; i < breaks.size() - 1; i++)
+    // loop over samples and count them in their bin:
+    std::vector<size_t> counts(breaks.size() - 1, 0);
+    int maxBin = counts.size() - 1;
+    for(auto sample : samples)
     {
-        // iterator to first element greater equal lower break point:
-        boundLo = std::upper_bound(boundLo, samples.end(), breaks[i]);
-
-        // iterator to first element strictly greater than upper break point:
-        boundHi = std::upper_bound(boundLo, samples.end(), breaks[i+1]);
-
-        // count number of samples in this range:
-        counts.push_back(std::distance(boundLo, boundHi));
+        // estimate of bin index:
+        int bin = std::ceil((sample - breaks.front())/binWidth_) - 1;
+        bin = std::min(std::max(bin, 0), maxBin);
+
+        // correct for rounding in accumulated break points:
+        while( bin > 0 && sample <= breaks[bin] )
+        {
+            bin--;
+        }
+        while( bin < maxBin && sample > breaks[bin + 1] )
+        {
+            bin++;
+        }
+
+        counts[bin]++;
     }
 
     // sum over counts:
-    size_t sum = std::accumulate(counts.begin(), counts.end(), 0.0);
+    size_t sum = std::accumulate(counts.begin(), counts.end(), size_t(0));
 
     // sanity check:
     if( sum != samples.size() )
@@ -271,7 +264,7 @@ HistogramDensityEstimator::calculateDensity(
             counts.begin(),
             counts.end(),
             density.begin(),
-            std::bind2nd(std::divides<real>(), sum));
+            [sum](size_t count){return static_cast<real>(count)/sum;});
 
     // return vector of densities:
     return(density);
@@ -26,6 +26,7 @@
 #include <cmath>
 
 #include "geometry/linear_spline_interp_1D.hpp"
+#include "statistics/deterministic_sum.hpp"
 #include "statistics/kernel_density_estimator.hpp"
 
 
@@ -332,6 +333,9 @@ KernelDensityEstimator::calculateNumEvalPoints(
  * \f$ K(x) \f$ is a kernel function implemented as a class derived from
  * AbstractKernelFunction.
  *
+ * The sum is evaluated with DeterministicSum, so that its result does not 
+ * depend on how the samples would be distributed in a parallel evaluation.
+ *
  * Note that this is relatively costly for large sample sizes or many 
  * evaluation points and should in the future be replaced by a more efficient
  * FFT-based algorithm.
@@ -366,16 +370,22 @@ KernelDensityEstimator::calculateDensity(
     // scaled bandwidth:
     real bw = bandWidth_ * bandWidthScale_;
 
+    // buffer for kernel values at one evaluation point:
+    std::vector<real> kernelValues(samples.size());
+
     // loop over evaluation points:
     for(size_t i = 0; i < evalPoints.size(); i++)
     {
-        // density is sum over kernel distances:
-        for(auto sample : samples)
+        // evaluate kernel at each sample:
+        for(size_t j = 0; j < samples.size(); j++)
         {
-            density[i] += Kernel -> operator()( 
-                    (evalPoints[i] - sample)/bw );
+            kernelValues[j] = Kernel -> operator()( 
+                    (evalPoints[i] - samples[j])/bw );
         }
 
+        // density is sum over kernel distances:
+        density[i] = DeterministicSum::pairwise(kernelValues);
+
         // normalise density at this evaluation point:
         density[i] *= normalisation;
     }
@@ -73,7 +73,7 @@ SummaryStatistics::update(const real newValue)
     }
 
     // update mean:
-    real delta = newValue - mean_;
+    double delta = newValue - mean_;
     mean_ += delta/num_;
 
     // update squared difference from mean:
@@ -105,6 +105,54 @@ SummaryStatistics::updateMultiple(
 }
 
 
+/*!
+ * Merges the summary statistics of another (disjoint) set of samples into 
+ * this one using the pairwise update formulae of Chan et al. (1979). This 
+ * allows partial statistics accumulated by independent workers to be 
+ * combined. Note that the result depends on the order in which partial 
+ * statistics are merged, so for reproducible results these should always be
+ * accumulated over the same blocks of data and merged in the same order, 
+ * independent of the number of workers.
+ */
+void
+SummaryStatistics::merge(
+        const SummaryStatistics &other)
+{
+    // nothing to merge:
+    if( other.num_ == 0 )
+    {
+        return;
+    }
+    if( num_ == 0 )
+    {
+        *this = other;
+        return;
+    }
+
+    // combined number of samples:
+    double numA = num_;
+    double numB = other.num_;
+    double numAB = numA + numB;
+
+    // update mean and squared difference from mean:
+    double delta = other.mean_ - mean_;
+    mean_ += delta*numB/numAB;
+    sumSquaredMeanDiff_ += other.sumSquaredMeanDiff_ + 
+                           delta*delta*numA*numB/numAB;
+
+    // update min, max, and counter:
+    if( other.min_ < min_ )
+    {
+        min_ = other.min_;
+    }
+    if( other.max_ > max_ )
+    {
+        max_ = other.max_;
+    }
+    num_ += other.num_;
+}
+
+
 /*!
  * Shifts the value of minimum, maximum, and mean by the given amount. Standard
  * deviation, variance, and number of samples are unaffected. This is useful if
@@ -218,7 +266,7 @@ SummaryStatistics::num() const
  * standard deviation and variance getter methods and is inline for
  * performance.
  */
-inline real
+inline double
 SummaryStatistics::varFromSumSquaredMeanDiff() const
 {
     return sumSquaredMeanDiff_ / (num_ - 1.0);
@@ -25,6 +25,7 @@
 #include <limits>
 
 #include "geometry/linear_spline_interp_1D.hpp"
+#include "statistics/deterministic_sum.hpp"
 #include "statistics/weighted_kernel_density_estimator.hpp"
 
 
@@ -77,21 +78,25 @@ WeightedKernelDensityEstimator::calculateWeightedDensity(
     std::vector<real> density(evalPoints.size(), 0.0);
     std::vector<real> weightedDensity(evalPoints.size(), 0.0);
 
+    // buffers for kernel values at one evaluation point:
+    std::vector<real> kern(samples.size());
+    std::vector<real> weightedKern(samples.size());
+
     // loop over evaluation points:
     for(size_t i = 0; i < evalPoints.size(); i++)
     {
-        // density is sum over kernel distances:
+        // evaluate kernel function at each sample:
         for(size_t j = 0; j < samples.size(); j++)
         {
-            // evaluate kernel function:
-            real kern =  kernel -> operator()( 
+            kern[j] = kernel -> operator()( 
                     (evalPoints[i] - samples[j])/bandWidth_ );
-
-            // for weighted and unweighted sums:
-            density[i] += kern;
-            weightedDensity[i] += kern*weights[j];
+            weightedKern[j] = kern[j]*weights[j];
         }
 
+        // density is sum over kernel distances (weighted and unweighted):
+        density[i] = DeterministicSum::pairwise(kern);
+        weightedDensity[i] = DeterministicSum::pairwise(weightedKern);
+
         // fend of NaNs occuring if density is too close to zero:
         if( density[i] >= std::numeric_limits<real>::epsilon() )
         {
@@ -23,20 +23,31 @@
 
 
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
 #include <string>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <gromacs/random/threefry.h>
 #include <gromacs/utility/fatalerror.h>
 
 #include "trajectory-analysis/chap_trajectory_analysis.hpp"
 
 #include "aggregation/boltzmann_energy_calculator.hpp"
+#include "aggregation/dewetting_event_detector.hpp"
+#include "aggregation/water_wire_calculator.hpp"
 #include "aggregation/number_density_calculator.hpp"
+#include "aggregation/time_resolved_profile_aggregator.hpp"
 
 #include "config/config.hpp"
 #include "config/dependencies.hpp"
 #include "config/version.hpp"
 
+#include "electrostatics/pme_potential_calculator.hpp"
+
 #include "geometry/cubic_spline_interp_1D.hpp"
 #include "geometry/cubic_spline_interp_3D.hpp"
 #include "geometry/linear_spline_interp_1D.hpp"
@@ -54,11 +65,13 @@
 #include "statistics/amise_optimal_bandwidth_estimator.hpp"
 #include "statistics/histogram_density_estimator.hpp"
 #include "statistics/kernel_density_estimator.hpp"
+#include "statistics/covariance_statistics.hpp"
 #include "statistics/summary_statistics.hpp"
 #include "statistics/weighted_kernel_density_estimator.hpp"
 
 #include "path-finding/inplane_optimised_probe_path_finder.hpp"
 #include "path-finding/optimised_direction_probe_path_finder.hpp"
+#include "path-finding/pore_residue_mapper.hpp"
 #include "path-finding/naive_cylindrical_path_finder.hpp"
 #include "path-finding/vdw_radius_provider.hpp"
 
@@ -69,7 +82,9 @@ using namespace gmx;
  * Constructor for the ChapTrajectoryAnalysis class.
  */
 ChapTrajectoryAnalysis::ChapTrajectoryAnalysis()
-    : pfProbeRadius_(0.0)
+    : numProcesses_(1)
+    , workerRank_(0)
+    , pfProbeRadius_(0.0)
     , pfMaxProbeSteps_(1e3)
     , pfInitProbePos_(3)
     , pfChanDirVec_(3)
@@ -79,10 +94,6 @@ ChapTrajectoryAnalysis::ChapTrajectoryAnalysis()
     , saCoolingFactor_(0.99)
     , saStepLengthFactor_(0.01)
 {
-    // register data containers:
-    registerAnalysisDataset(&frameStreamData_, "frameStreamData");
-    frameStreamData_.setMultipoint(true); 
-
     // default initial probe position and chanell direction:
     pfInitProbePos_ = {std::nan(""), std::nan(""), std::nan("")};
     pfChanDirVec_ = {0.0, 0.0, 1.0};
@@ -116,11 +127,10 @@ ChapTrajectoryAnalysis::initOptions(
     // require the user to provide a topology file input:
     settings -> setFlag(TrajectoryAnalysisSettings::efRequireTop);
 
-    // will not use periodic boundary conditions:
-    settings -> setPBC(false);
-    settings -> setFlag(TrajectoryAnalysisSettings::efNoUserPBC);
+    // periodic boundary conditions are used unless disabled with -nopbc:
+    settings -> setPBC(true);
 
-    // will make molecules whole:
+    // will make only the pore forming molecules whole (see MoleculeUnwrapper):
     settings -> setRmPBC(false);
     settings -> setFlag(TrajectoryAnalysisSettings::efNoUserRmPBC);
 
@@ -132,10 +142,14 @@ ChapTrajectoryAnalysis::initOptions(
     //-------------------------------------------------------------------------
 
     options -> addOption(SelectionOption("sel-pathway")
-                         .store(&pathwaySel_).required()
+                         .storeVector(&pathwaySel_).required()
+                         .multiValue()
                          .description("Reference group that defines the "
                                       "permeation pathway (usually "
-                                      "'Protein') "));
+                                      "'Protein'). If several groups are "
+                                      "given, each defines a separate "
+                                      "channel that is analysed "
+                                      "independently."));
 
     options -> addOption(SelectionOption("sel-solvent")
                          .storeVector(&solventSel_)
@@ -150,7 +164,9 @@ ChapTrajectoryAnalysis::initOptions(
                          .store(&outputBaseFileName_)
                          .defaultValue("output")
                          .description("File name for output files without "
-                                      "file extension."));
+                                      "file extension. With several pathway "
+                                      "selections, the channel number is "
+                                      "appended for each channel."));
 
     options -> addOption(IntegerOption("out-num-points")
                          .store(&outputNumPoints_)
@@ -185,6 +201,15 @@ ChapTrajectoryAnalysis::initOptions(
                                       "Negative values may result in "
                                       "visualisation artifacts."));
 
+    options -> addOption(RealOption("out-vis-tol")
+                         .store(&outputTessellationTolerance_)
+                         .defaultValue(0.005)
+                         .description("Maximum deviation (in nm) of the "
+                                      "triangulated pathway surface in the "
+                                      "OBJ output from the smooth surface. "
+                                      "Smaller values yield a finer mesh and "
+                                      "larger files."));
+
     options -> addOption(BooleanOption("out-detailed")
                          .store(&outputDetailed_)
                          .defaultValue(false)
@@ -195,6 +220,18 @@ ChapTrajectoryAnalysis::initOptions(
                                       "This is mostly useful for debugging."));
 
 
+    // PARALLELISATION OPTIONS
+    // ------------------------------------------------------------------------
+
+    options -> addOption(IntegerOption("np")
+                         .store(&numProcesses_)
+                         .defaultValue(1)
+                         .description("Number of processes used to analyse "
+                                      "the trajectory. Worker processes are "
+                                      "forked after setup and each analyses "
+                                      "an interleaved subset of frames."));
+
+
     // PATH FINDING PARAMETERS
     //-------------------------------------------------------------------------
 
@@ -247,14 +284,42 @@ ChapTrajectoryAnalysis::initOptions(
                                       "ignored unless -pf-vdwr-database is "
                                       "set to 'user'."));
 
+    const char * const allowedPathFindingMode[] = {"frame",
+                                                   "reference"};
+    pfMode_ = ePathFindingModeFrame;
+    options -> addOption(EnumOption<ePathFindingMode>("pf-mode")
+                         .enumValue(allowedPathFindingMode)
+                         .store(&pfMode_)
+                         .description("Path finding mode. In 'frame' mode, "
+                                      "the pathway is found anew in each "
+                                      "frame. In 'reference' mode, all frames "
+                                      "are mapped onto the centre line of a "
+                                      "fixed reference pathway and only the "
+                                      "radius profile along it is updated."));
+
+    options -> addOption(StringOption("pf-ref-path-json")
+                         .store(&pfRefPathJson_)
+                         .storeIsSet(&pfRefPathJsonIsSet_)
+                         .description("JSON file with the reference pathway "
+                                      "in the format of one line of the "
+                                      "per-frame output written with "
+                                      "-out-detailed. If not given in "
+                                      "'reference' mode, the pathway found "
+                                      "in the first frame is used. Ignored "
+                                      "in 'frame' mode."));
+
     const char * const allowedPathAlignmentMethod[] = {"none",
-                                                       "ipp"};
+                                                       "ipp",
+                                                       "radius"};
     pfPathAlignmentMethod_ = ePathAlignmentMethodIpp;
     options -> addOption(EnumOption<ePathAlignmentMethod>("pf-align-method")
                          .enumValue(allowedPathAlignmentMethod)
                          .store(&pfPathAlignmentMethod_)
                          .description("Method for aligning pathway "
-                                      "coordinates across time steps"));
+                                      "coordinates across time steps. "
+                                      "'radius' additionally registers the "
+                                      "radius profile of each frame against "
+                                      "the running mean profile."));
 
     options -> addOption(RealOption("pf-probe-step")
                          .store(&pfProbeStepLength_)
@@ -273,22 +338,27 @@ ChapTrajectoryAnalysis::initOptions(
                                       "moved in either direction."));
 
     options -> addOption(SelectionOption("pf-sel-ipp")
-                         .store(&ippSel_)
+                         .storeVector(&ippSel_)
                          .storeIsSet(&ippSelIsSet_)
+                         .multiValue()
                          .description("Selection of atoms whose COM will be "
-                                      "used as initial probe position. If not "
-                                      "set, the selection specified with "
-                                      "'sel-pathway' will be used."));
+                                      "used as initial probe position. If "
+                                      "neither this nor 'pf-init-probe-pos' "
+                                      "is set, the initial probe position is "
+                                      "determined automatically. Requires "
+                                      "one selection per pathway "
+                                      "selection."));
 
     options -> addOption(RealOption("pf-init-probe-pos")
                          .storeVector(&pfInitProbePos_)
                          .storeIsSet(&pfInitProbePosIsSet_)
-                         .valueCount(3)
+                         .multiValue()
                          .description("Initial position of probe in "
                                       "probe-based pore finding algorithms. "
                                       "If set explicitly, it will overwrite "
                                       "the COM-based initial position set "
-                                      "with the ippSelflag."));
+                                      "with the ippSelflag. Requires three "
+                                      "values per pathway selection."));
 
     std::vector<real> chanDirVec_ = {0.0, 0.0, 1.0};
     options -> addOption(RealOption("pf-chan-dir-vec")
@@ -296,7 +366,28 @@ ChapTrajectoryAnalysis::initOptions(
                          .storeIsSet(&pfChanDirVecIsSet_)
                          .valueCount(3)
                          .description("Channel direction vector. Will be "
-                                      "normalised to unit vector internally."));
+                                      "normalised to unit vector internally. "
+                                      "If not set, the principal axis of the "
+                                      "pathway forming group that best "
+                                      "matches the channel is used in each "
+                                      "frame."));
+
+    options -> addOption(SelectionOption("pf-sel-membrane")
+                         .store(&membraneSel_)
+                         .storeIsSet(&membraneSelIsSet_)
+                         .description("Selection of membrane particles (e.g. "
+                                      "lipid headgroups) whose normal is used "
+                                      "to choose the channel direction if "
+                                      "'pf-chan-dir-vec' is not set."));
+
+    options -> addOption(RealOption("pf-auto-smooth")
+                         .store(&pfAutoSmooth_)
+                         .defaultValue(0.3)
+                         .description("Weight of the current frame in the "
+                                      "exponential smoothing of the "
+                                      "automatically determined channel "
+                                      "direction and initial probe position. "
+                                      "A value of one disables smoothing."));
    
     // max-free-dist and largest vdW radius
     options -> addOption(DoubleOption("pf-cutoff")
@@ -308,6 +399,45 @@ ChapTrajectoryAnalysis::initOptions(
                                       "or less means no cutoff is applied. "
                                       "If unset, an appropriate cutoff is "
                                       "determined automatically."));
+
+    options -> addOption(RealOption("pf-hull-margin")
+                         .store(&pfHullMargin_)
+                         .defaultValue(0.5)
+                         .description("Distance beyond the extent of the "
+                                      "pathway forming atoms along the "
+                                      "channel direction after which the "
+                                      "probe position is no longer "
+                                      "optimised. A negative value disables "
+                                      "early termination."));
+
+    options -> addOption(RealOption("pf-pred-tol")
+                         .store(&pfPredTol_)
+                         .defaultValue(0.1)
+                         .description("Maximum distance between the "
+                                      "extrapolated and optimised probe "
+                                      "position for which a shortened "
+                                      "optimisation is accepted. A negative "
+                                      "value disables the prediction."));
+
+    options -> addOption(BooleanOption("pf-fit")
+                         .store(&pfFit_)
+                         .defaultValue(false)
+                         .description("If true, the fit group is superimposed "
+                                      "onto its conformation in the topology "
+                                      "file in every frame before the "
+                                      "pathway is found, so that all output "
+                                      "coordinates refer to the frame of the "
+                                      "topology."));
+
+    options -> addOption(SelectionOption("pf-sel-fit")
+                         .store(&fitSel_)
+                         .storeIsSet(&fitSelIsSet_)
+                         .onlyAtoms()
+                         .description("Static group of atoms used for the "
+                                      "superposition with '-pf-fit'. If not "
+                                      "set, the selection specified with "
+                                      "'sel-pathway' will be used for each "
+                                      "channel."));
  
 
 
@@ -380,6 +510,14 @@ ChapTrajectoryAnalysis::initOptions(
                                       "centre line is used to determine if "
                                       "a residue is pore-facing."));
 
+    options -> addOption(RealOption("pm-grid-dist")
+                         .store(&pmGridDist_)
+                         .defaultValue(0.1)
+                         .description("Voxel size of the lookup grid used to "
+                                      "map particles onto a fixed reference "
+                                      "pathway (see -pf-mode). A value of "
+                                      "zero disables the lookup grid."));
+
 
     // DENSITY ESTIMATION PARAMETERS
     //-------------------------------------------------------------------------
@@ -471,6 +609,138 @@ ChapTrajectoryAnalysis::initOptions(
                          .store(&hpBandWidth_)
                          .defaultValue(0.35)
                          .description("Bandwidth for hydrophobicity kernel."));
+
+
+    // ELECTROSTATICS PARAMETERS
+    //-------------------------------------------------------------------------
+
+    options -> addOption(SelectionOption("es-sel")
+                         .store(&esSel_)
+                         .storeIsSet(&esSelIsSet_)
+                         .description("Group of charged particles used to "
+                                      "calculate the electrostatic potential "
+                                      "along the pathway (usually 'System'). "
+                                      "Partial charges are taken from the "
+                                      "topology. If not set, no electrostatic "
+                                      "potential is calculated."));
+
+    options -> addOption(RealOption("es-grid-spacing")
+                         .store(&esGridSpacing_)
+                         .defaultValue(0.12)
+                         .description("Maximum spacing of the PME grid used "
+                                      "for the reciprocal space part of the "
+                                      "electrostatic potential."));
+
+    options -> addOption(IntegerOption("es-pme-order")
+                         .store(&esSplineOrder_)
+                         .defaultValue(4)
+                         .description("Order of the B-splines used for charge "
+                                      "spreading and potential interpolation "
+                                      "(between 3 and 12)."));
+
+    options -> addOption(RealOption("es-cutoff")
+                         .store(&esCutoff_)
+                         .defaultValue(1.0)
+                         .description("Cutoff for the real space part of the "
+                                      "electrostatic potential."));
+
+    options -> addOption(RealOption("es-ewald-rtol")
+                         .store(&esEwaldTolerance_)
+                         .defaultValue(1e-5)
+                         .description("Relative strength of the real space "
+                                      "potential at the cutoff. Determines the "
+                                      "Ewald splitting coefficient."));
+
+    options -> addOption(RealOption("es-res")
+                         .store(&esResolution_)
+                         .defaultValue(0.05)
+                         .description("Spacing of the points along the centre "
+                                      "line at which the electrostatic "
+                                      "potential is evaluated."));
+
+
+    // DIFFUSION PARAMETERS
+    //-------------------------------------------------------------------------
+
+    options -> addOption(IntegerOption("diff-max-lag")
+                         .store(&diffMaxLag_)
+                         .defaultValue(5)
+                         .description("Maximum lag (in frames) over which "
+                                      "mean squared displacements of solvent "
+                                      "particles along the pathway are "
+                                      "accumulated. Set to zero to disable the "
+                                      "diffusion profile."));
+
+    options -> addOption(RealOption("diff-bin-width")
+                         .store(&diffBinWidth_)
+                         .defaultValue(0.1)
+                         .description("Width of the arc length bins in which "
+                                      "the diffusion coefficient is "
+                                      "estimated."));
+
+
+    // DEWETTING PARAMETERS
+    //-------------------------------------------------------------------------
+
+    options -> addOption(RealOption("dewet-threshold-lo")
+                         .store(&dewetThresholdLo_)
+                         .defaultValue(1.0)
+                         .description("Minimum solvent number density below "
+                                      "which the pathway is considered "
+                                      "dewetted."));
+
+    options -> addOption(RealOption("dewet-threshold-hi")
+                         .store(&dewetThresholdHi_)
+                         .defaultValue(10.0)
+                         .description("Minimum solvent number density above "
+                                      "which a dewetted pathway is considered "
+                                      "wetted again."));
+
+    options -> addOption(RealOption("dewet-min-duration")
+                         .store(&dewetMinDuration_)
+                         .defaultValue(0.0)
+                         .description("Minimum duration of a dewetting event. "
+                                      "Shorter events are discarded."));
+
+
+    // WATER WIRE PARAMETERS
+    //-------------------------------------------------------------------------
+
+    options -> addOption(RealOption("ww-cutoff")
+                         .store(&wwCutoff_)
+                         .defaultValue(0.35)
+                         .description("Distance cutoff below which two "
+                                      "solvent particles inside the pore are "
+                                      "considered in contact when searching "
+                                      "for a continuous water wire between "
+                                      "the pore openings."));
+
+
+    // TIME-RESOLVED PROFILE PARAMETERS
+    //-------------------------------------------------------------------------
+
+    options -> addOption(IntegerOption("tr-window")
+                         .store(&trWindow_)
+                         .defaultValue(0)
+                         .description("Number of frames over which mean and "
+                                      "standard deviation of time-resolved "
+                                      "profiles are calculated. Zero disables "
+                                      "window statistics."));
+
+    options -> addOption(IntegerOption("tr-stride")
+                         .store(&trStride_)
+                         .defaultValue(0)
+                         .description("Number of frames between successive "
+                                      "time-resolved profiles. Defaults to the "
+                                      "window size, i.e. non-overlapping "
+                                      "blocks."));
+
+    options -> addOption(RealOption("tr-ema-time")
+                         .store(&trEmaTime_)
+                         .defaultValue(0.0)
+                         .description("Time constant of the exponential moving "
+                                      "average of time-resolved profiles. Zero "
+                                      "disables the moving average."));
 }
 
 
@@ -479,7 +749,7 @@ ChapTrajectoryAnalysis::initOptions(
  */
 void
 ChapTrajectoryAnalysis::initAnalysis(
-        const TrajectoryAnalysisSettings& /*settings*/,
+        const TrajectoryAnalysisSettings &settings,
         const TopologyInformation &top)
 {
     // the following code ensures compatibility across Gromacs versions:
@@ -507,11 +777,47 @@ ChapTrajectoryAnalysis::initAnalysis(
     outputStructure_.fromTopology(top);
 
 
+    // PREPARE CHANNELS
+    //-------------------------------------------------------------------------
+
+    // each pathway selection defines a channel of its own:
+    for(size_t i = 0; i < pathwaySel_.size(); i++)
+    {
+        std::unique_ptr<PoreChannel> channel(new PoreChannel);
+        channel -> pathwaySel_ = pathwaySel_[i];
+
+        // output files are numbered if there is more than one channel:
+        channel -> outputBaseFileName_ = outputBaseFileName_;
+        if( pathwaySel_.size() > 1 )
+        {
+            channel -> outputBaseFileName_ += "_" + std::to_string(i + 1);
+        }
+        channel -> outputJsonFileName_ = channel -> outputBaseFileName_ + ".json";
+        channel -> outputPdbFileName_ = channel -> outputBaseFileName_ + ".pdb";
+
+        // user-given initial probe position and channel direction:
+        if( ippSelIsSet_ )
+        {
+            channel -> ippSel_ = ippSel_.at(i);
+        }
+        size_t ippOffset = pfInitProbePosIsSet_ ? 3*i : 0;
+        channel -> initProbePos_ = gmx::RVec(
+                pfInitProbePos_.at(ippOffset + XX),
+                pfInitProbePos_.at(ippOffset + YY),
+                pfInitProbePos_.at(ippOffset + ZZ));
+        channel -> chanDirVec_ = gmx::RVec(
+                pfChanDirVec_[XX], 
+                pfChanDirVec_[YY], 
+                pfChanDirVec_[ZZ]);
+
+        channels_.push_back(std::move(channel));
+    }
+
+
     // PREPARE DATASETS
     //-------------------------------------------------------------------------
 
     // prepare per frame data stream:
-    frameStreamData_.setDataSetCount(9);
     std::vector<std::string> frameStreamDataSetNames = {
             "pathSummary",
             "molPathOrigPoints",
@@ -521,12 +827,12 @@ ChapTrajectoryAnalysis::initAnalysis(
             "solventPositions",
             "solventDensitySpline",
             "plHydrophobicitySpline",
-            "pfHydrophobicitySpline"};
+            "pfHydrophobicitySpline",
+            "electrostaticPotentialSpline"};
     std::vector<std::vector<std::string>> frameStreamColumnNames;
 
 
     // prepare container for aggregated data:
-    frameStreamData_.setColumnCount(0, 14);
     frameStreamColumnNames.push_back({"timeStamp",
                                       "argMinRadius",
                                       "minRadius",
@@ -540,29 +846,29 @@ ChapTrajectoryAnalysis::initAnalysis(
                                       "minSolventDensity",
                                       "arcLengthLo",
                                       "arcLengthHi",
-                                      "bandWidth"});
+                                      "bandWidth",
+                                      "waterWire",
+                                      "waterWireGap",
+                                      "waterWireGapWidth",
+                                      "alignShift"});
 
     // prepare container for original path points:
-    frameStreamData_.setColumnCount(1, 4);
     frameStreamColumnNames.push_back({"x", 
                                       "y",
                                       "z",
                                       "r"});
 
     // prepare container for path radius:
-    frameStreamData_.setColumnCount(2, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
 
     // prepare container for pathway spline:
-    frameStreamData_.setColumnCount(3, 4);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrlX",
                                       "ctrlY",
                                       "ctrlZ"});
 
     // prepare container for residue mapping results:
-    frameStreamData_.setColumnCount(4, 11);
     frameStreamColumnNames.push_back({"resId",
                                       "s",
                                       "rho",
@@ -576,7 +882,6 @@ ChapTrajectoryAnalysis::initAnalysis(
                                       "z"});
 
     // prepare container for solvent mapping:
-    frameStreamData_.setColumnCount(5, 9);
     frameStreamColumnNames.push_back({"resId", 
                                       "s",
                                       "rho",
@@ -588,25 +893,50 @@ ChapTrajectoryAnalysis::initAnalysis(
                                       "z"});
 
     // prepare container for solvent density:
-    frameStreamData_.setColumnCount(6, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
 
     // prepare container for hydrophobicity splines:
-    frameStreamData_.setColumnCount(7, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
-    frameStreamData_.setColumnCount(8, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
 
-    // add JSON exporter to frame stream data:
-    AnalysisDataJsonFrameExporterPointer jsonFrameExporter(new AnalysisDataJsonFrameExporter);
-    jsonFrameExporter -> setDataSetNames(frameStreamDataSetNames);
-    jsonFrameExporter -> setColumnNames(frameStreamColumnNames);
-    std::string frameStreamFileName = std::string("stream_") + outputJsonFileName_;
-    jsonFrameExporter -> setFileName(frameStreamFileName);
-    frameStreamData_.addModule(jsonFrameExporter);
+    // prepare container for electrostatic potential spline:
+    frameStreamColumnNames.push_back({"knots", 
+                                      "ctrl"});
+
+    // each channel writes its own data stream:
+    // (datasets are registered here rather than in the constructor, as the
+    // number of channels is only known once the selections have been parsed;
+    // this is safe because the runner calls initAnalysis() before 
+    // startFrames(), which is where TrajectoryAnalysisModuleData starts a 
+    // data handle for each registered dataset, and because datasets are not
+    // looked up by name before then)
+    for(size_t i = 0; i < channels_.size(); i++)
+    {
+        PoreChannel &channel = *channels_[i];
+        registerAnalysisDataset(
+                &channel.frameStreamData_, 
+                ("frameStreamData" + std::to_string(i)).c_str());
+        channel.frameStreamData_.setMultipoint(true);
+        channel.frameStreamData_.setDataSetCount(
+                frameStreamDataSetNames.size());
+        for(size_t j = 0; j < frameStreamColumnNames.size(); j++)
+        {
+            channel.frameStreamData_.setColumnCount(
+                    j, 
+                    frameStreamColumnNames[j].size());
+        }
+
+        // add JSON exporter to frame stream data:
+        AnalysisDataJsonFrameExporterPointer jsonFrameExporter(new AnalysisDataJsonFrameExporter);
+        jsonFrameExporter -> setDataSetNames(frameStreamDataSetNames);
+        jsonFrameExporter -> setColumnNames(frameStreamColumnNames);
+        jsonFrameExporter -> setFileName(frameStreamFileName(channel, 0));
+        channel.frameStreamData_.addModule(jsonFrameExporter);
+        channel.frameStreamExporter_ = jsonFrameExporter;
+    }
 
 
     // PREPARE SELECTIONS FOR PORE PARTICLE MAPPING
@@ -616,11 +946,6 @@ ChapTrajectoryAnalysis::initAnalysis(
     poreMappingSelCol_.setReferencePosType("res_cog");
     poreMappingSelCol_.setOutputPosType("res_cog");
   
-    // selection of C-alpha atoms:
-    std::string pathwaySelSelText = pathwaySel_.selectionText();
-    std::string poreMappingSelCalString = pfSelString_;
-    std::string poreMappingSelCogString = pathwaySelSelText;
-
     // create index groups from topology:
     gmx_ana_indexgrps_t *poreIdxGroups;
  
@@ -638,9 +963,21 @@ ChapTrajectoryAnalysis::initAnalysis(
                                NULL); 
     }
 
-    // create selections as defined above:
-    poreMappingSelCal_ = poreMappingSelCol_.parseFromString(poreMappingSelCalString)[0];
-    poreMappingSelCog_ = poreMappingSelCol_.parseFromString(poreMappingSelCogString)[0];
+    // create selections for each channel in one collection:
+    // (with several channels, C-alpha atoms are restricted to each pathway)
+    for(auto &channel : channels_)
+    {
+        std::string pathwaySelSelText = channel -> pathwaySel_.selectionText();
+        std::string poreMappingSelCalString = pfSelString_;
+        std::string poreMappingSelCogString = pathwaySelSelText;
+        if( channels_.size() > 1 )
+        {
+            poreMappingSelCalString = "(" + pfSelString_ + ") and (" + 
+                                      pathwaySelSelText + ")";
+        }
+        channel -> poreMappingSelCal_ = poreMappingSelCol_.parseFromString(poreMappingSelCalString)[0];
+        channel -> poreMappingSelCog_ = poreMappingSelCol_.parseFromString(poreMappingSelCogString)[0];
+    }
     poreMappingSelCol_.setTopology(topologyPointer.get(), 0);
     poreMappingSelCol_.setIndexGroups(poreIdxGroups);
     poreMappingSelCol_.compile();
@@ -649,13 +986,17 @@ ChapTrajectoryAnalysis::initAnalysis(
     gmx_ana_indexgrps_free(poreIdxGroups);
 
     // do we have one C-alpha for each pore-forming residue?
-    if( poreMappingSelCal_.posCount() != poreMappingSelCog_.posCount() )
+    for(auto &channel : channels_)
     {
-        findPfResidues_ = false;  
-    }
-    else
-    {
-        findPfResidues_ = true;
+        if( channel -> poreMappingSelCal_.posCount() != 
+            channel -> poreMappingSelCog_.posCount() )
+        {
+            channel -> findPfResidues_ = false;  
+        }
+        else
+        {
+            channel -> findPfResidues_ = true;
+        }
     }
 
 
@@ -757,11 +1098,16 @@ ChapTrajectoryAnalysis::initAnalysis(
     }
 
 
-    std::vector<int> mappedIds(
-            pathwaySel_.mappedIds().data(),
-            pathwaySel_.mappedIds().data() + pathwaySel_.mappedIds().size());
-
-    
+    // pathway forming atoms of all channels:
+    std::vector<int> mappedIds;
+    for(auto &channel : channels_)
+    {
+        const Selection &sel = channel -> pathwaySel_;
+        mappedIds.insert(
+                mappedIds.end(),
+                sel.mappedIds().data(),
+                sel.mappedIds().data() + sel.mappedIds().size());
+    }
 
     // build vdw radius lookup map:
     vdwRadii_ = vrp.vdwRadiiForTopology(top, mappedIds);
@@ -835,6 +1181,196 @@ ChapTrajectoryAnalysis::initAnalysis(
 
     // free line for nice output:
     std::cout<<std::endl;
+
+
+    // PREPARE PERIODIC BOUNDARY HANDLING
+    //-------------------------------------------------------------------------
+
+    // conformation in topology file serves as reference:
+    rvec *topX;
+    matrix topBox;
+    top.getTopologyConf(&topX, topBox);
+    t_pbc topPbc;
+    t_pbc *topPbcPtr = nullptr;
+    if( settings.hasPBC() && top.ePBC() != epbcNONE &&
+        topBox[XX][XX]*topBox[YY][YY]*topBox[ZZ][ZZ] > 0.0 )
+    {
+        set_pbc(&topPbc, top.ePBC(), topBox);
+        topPbcPtr = &topPbc;
+    }
+
+    // bond graph of the topology is shared by all channels:
+    std::vector<std::pair<int, int>> topBonds = 
+            MoleculeUnwrapper::bondsFromTopology(*top.topology());
+
+    // pore forming atoms are made whole using the bond graph of the topology:
+    // (dynamic selections are only supported without PBC)
+    for(auto &channel : channels_)
+    {
+        const Selection &pathwaySel = channel -> pathwaySel_;
+        if( pathwaySel.isDynamic() && settings.hasPBC() )
+        {
+            throw std::runtime_error("Pathway selection must not be dynamic "
+                                     "if periodic boundary conditions are "
+                                     "used.");
+        }
+        if( !pathwaySel.isDynamic() )
+        {
+            std::vector<int> poreAtomIndices(
+                    pathwaySel.atomIndices().begin(), 
+                    pathwaySel.atomIndices().end());
+            channel -> poreUnwrapper_.reset(new MoleculeUnwrapper(
+                    poreAtomIndices, 
+                    topBonds));
+
+            // pore is kept in the periodic image closest to the input structure:
+            channel -> poreUnwrapper_ -> setReferenceCentre(
+                    MoleculeUnwrapper::centreOfGeometry(
+                            (*channel -> poreUnwrapper_)(topX, topPbcPtr)));
+        }
+    }
+
+
+    // PREPARE SUPERPOSITION ONTO REFERENCE STRUCTURE
+    //-------------------------------------------------------------------------
+
+    // fit group conformation in topology is used as reference:
+    // (each channel is fitted separately, so that it stays in its own image)
+    if( pfFit_ )
+    {
+        for(auto &channel : channels_)
+        {
+            const Selection &fitSel = fitSelIsSet_ ? fitSel_ : channel -> pathwaySel_;
+            if( fitSel.isDynamic() || fitSel.atomCount() == 0 )
+            {
+                throw std::runtime_error("Fit group must be a static and "
+                                         "non-empty selection.");
+            }
+            std::vector<int> fitAtomIndices(
+                    fitSel.atomIndices().begin(), 
+                    fitSel.atomIndices().end());
+
+            // separate fit group needs to be made whole on its own:
+            if( fitSelIsSet_ )
+            {
+                channel -> fitUnwrapper_.reset(new MoleculeUnwrapper(
+                        fitAtomIndices, 
+                        topBonds));
+            }
+
+            // mass weighted fit (equal weights if topology lacks masses):
+            std::vector<real> fitWeights;
+            fitWeights.reserve(fitAtomIndices.size());
+            real totalMass = 0.0;
+            for(auto idx : fitAtomIndices)
+            {
+                fitWeights.push_back(top.topology() -> atoms.atom[idx].m);
+                totalMass += fitWeights.back();
+            }
+            if( totalMass <= 0.0 )
+            {
+                fitWeights.assign(fitAtomIndices.size(), 1.0);
+            }
+
+            // reference conformation is made whole as well:
+            const MoleculeUnwrapper &fitUnwrapper = channel -> fitUnwrapper_ ? 
+                    *channel -> fitUnwrapper_ : *channel -> poreUnwrapper_;
+            channel -> fitSuperposition_.reset(new KabschSuperposition(
+                    fitUnwrapper(topX, topPbcPtr),
+                    fitWeights));
+        }
+    }
+
+
+    // PREPARE AUTOMATIC CHANNEL DIRECTION AND INITIAL PROBE POSITION
+    //-------------------------------------------------------------------------
+
+    // only quantities not given by the user are estimated:
+    bool autoChanDirVec = !pfChanDirVecIsSet_;
+    bool autoInitProbePos = !pfInitProbePosIsSet_ && !ippSelIsSet_;
+    if( autoChanDirVec || autoInitProbePos )
+    {
+        for(auto &channel : channels_)
+        {
+            channel -> axisEstimator_.reset(new ChannelAxisEstimator(
+                    channel -> chanDirVec_,
+                    autoChanDirVec,
+                    pfAutoSmooth_));
+        }
+    }
+
+
+    // PREPARE PATHWAY ALIGNMENT
+    //-------------------------------------------------------------------------
+
+    // radius profiles are registered on the probe step grid:
+    if( pfMode_ == ePathFindingModeFrame && 
+        pfPathAlignmentMethod_ == ePathAlignmentMethodRadius )
+    {
+        for(auto &channel : channels_)
+        {
+            channel -> profileRegistration_.reset(
+                    new RadiusProfileRegistration(pfProbeStepLength_));
+        }
+    }
+
+
+    // PREPARE DIFFUSION PROFILE
+    //-------------------------------------------------------------------------
+
+    // diffusion profile requires solvent:
+    if( diffMaxLag_ > 0 && !solventSel_.empty() )
+    {
+        for(auto &channel : channels_)
+        {
+            channel -> diffProfileCalc_.reset(
+                    new DiffusionProfileCalculator(diffMaxLag_, diffBinWidth_));
+        }
+    }
+
+
+    // LOAD REFERENCE PATHWAY
+    //-------------------------------------------------------------------------
+
+    // user-supplied reference pathway is shared with workers:
+    // (only permitted for a single channel, see checkParameters())
+    if( pfMode_ == ePathFindingModeReference && pfRefPathJsonIsSet_ )
+    {
+        PoreChannel &channel = *channels_.front();
+        JsonDocImporter jdi;
+        rapidjson::Document refPathDoc = jdi(pfRefPathJson_.c_str());
+        channel.refPath_.reset(new MolecularPath(refPathDoc));
+        prepareRefPathMappingGrid(channel);
+    }
+
+
+    // SPAWN WORKER PROCESSES
+    //-------------------------------------------------------------------------
+
+    // quantities depending on all previous frames limit the speedup:
+    // (every process has to update them in every frame, see analyzeChannel())
+    if( numProcesses_ > 1 )
+    {
+        if( autoChanDirVec || autoInitProbePos )
+        {
+            std::cerr<<"WARNING: The channel direction and initial probe "
+                     <<"position are determined automatically, so every "
+                     <<"process unwraps and superimposes the pathway-forming "
+                     <<"group and estimates them in every frame. Set "
+                     <<"-pf-chan-dir-vec and -pf-init-probe-pos or "
+                     <<"-pf-sel-ipp to avoid this."<<std::endl;
+        }
+        if( pfMode_ == ePathFindingModeFrame && 
+            pfPathAlignmentMethod_ == ePathAlignmentMethodRadius )
+        {
+            std::cerr<<"WARNING: With -pf-align-method radius every process "
+                     <<"finds the pathway in every frame, so that -np will "
+                     <<"give little speedup."<<std::endl;
+        }
+
+        // setup is complete and will be shared with workers:
+        spawnWorkers();
+    }
 }
 
 
@@ -859,40 +1395,162 @@ ChapTrajectoryAnalysis::analyzeFrame(
         const t_trxframe &fr, 
         t_pbc *pbc,
         TrajectoryAnalysisModuleData *pdata)
+{
+    // EVALUATE SHARED SELECTIONS
+    //-------------------------------------------------------------------------
+
+    // solvent and pore mapping selections are evaluated once for all channels:
+    // (only needed in frames that are not just used to find a reference)
+    if( frnr % numProcesses_ == workerRank_ )
+    {
+        if( !solventSel_.empty() )
+        {
+            t_trxframe frame = fr;
+            solvMappingSelCol_.evaluate(&frame, pbc);
+        }
+
+        // static selections need not be re-evaluated to obtain atom indices:
+        bool poreMappingIsDynamic = false;
+        for(auto &channel : channels_)
+        {
+            poreMappingIsDynamic = poreMappingIsDynamic ||
+                                   channel -> poreMappingSelCog_.isDynamic() ||
+                                   channel -> poreMappingSelCal_.isDynamic();
+        }
+        if( poreMappingIsDynamic )
+        {
+            t_trxframe frame = fr;
+            poreMappingSelCol_.evaluate(&frame, pbc);
+        }
+    }
+
+
+    // ANALYSE EACH CHANNEL
+    //-------------------------------------------------------------------------
+
+    // channels are independent of one another:
+    for(auto &channel : channels_)
+    {
+        analyzeChannel(*channel, frnr, fr, pbc, pdata);
+    }
+}
+
+
+/*!
+ * Finds the pathway of a single channel in the given frame and evaluates all
+ * properties along it. Results are written to the per-frame data stream of
+ * this channel.
+ */
+void
+ChapTrajectoryAnalysis::analyzeChannel(
+        PoreChannel &channel,
+        int frnr,
+        const t_trxframe &fr,
+        t_pbc *pbc,
+        TrajectoryAnalysisModuleData *pdata)
 {
     // get thread-local selections:
-    const Selection &refSelection = pdata -> parallelSelection(pathwaySel_);
+    const Selection &refSelection = pdata -> parallelSelection(channel.pathwaySel_);
 
     // get data handles for this frame:
-    AnalysisDataHandle dhFrameStream = pdata -> dataHandle(frameStreamData_);
+    AnalysisDataHandle dhFrameStream = pdata -> dataHandle(channel.frameStreamData_);
 
     // get data for frame number frnr into data handle:
     dhFrameStream.startFrame(frnr, fr.time);
 
+    // reference pathway is taken from first frame if not given explicitly:
+    // (every process finds it, so that all processes use the same pathway)
+    bool findRefPath = (pfMode_ == ePathFindingModeReference && !channel.refPath_);
 
-    // UPDATE INITIAL PROBE POSITION FOR THIS FRAME
+    // running mean radius profile depends on all previous frames, so every
+    // process registers the radius profile in every frame:
+    bool registerProfile = (channel.profileRegistration_ && !channel.refPath_);
+
+    // smoothed axis estimate depends on all previous frames, so every 
+    // process updates it in every frame:
+    bool updateAxis = static_cast<bool>(channel.axisEstimator_);
+
+    // frames assigned to other processes are left empty:
+    bool isOwnFrame = (frnr % numProcesses_ == workerRank_);
+    if( !isOwnFrame && !findRefPath && !registerProfile && !updateAxis )
+    {
+        dhFrameStream.finishFrame();
+        return;
+    }
+
+
+    // MAKE PORE FORMING GROUP WHOLE
     //-------------------------------------------------------------------------
 
-    // recalculate initial probe position based on reference group COG:
-    if( pfInitProbePosIsSet_ == false )
-    {  
-        // helper variable for conditional assignment of selection:
-        Selection tmpsel;
-  
-        // has a group for specifying initial probe position been set?
-        if( ippSelIsSet_ == true )
+    // pore forming atoms in selection order, other particles are wrapped 
+    // around their centre (only the pore forming group is unwrapped, so that
+    // the cost does not scale with system size):
+    std::vector<gmx::RVec> porePositions;
+    if( channel.poreUnwrapper_ )
+    {
+        porePositions = (*channel.poreUnwrapper_)(fr.x, pbc);
+    }
+    else
+    {
+        porePositions.reserve(refSelection.atomCount());
+        for(int i = 0; i < refSelection.atomCount(); i++)
+        {
+            porePositions.push_back(refSelection.position(i).x());
+        }
+    }
+    gmx::RVec poreCentre = MoleculeUnwrapper::centreOfGeometry(porePositions);
+
+
+    // SUPERIMPOSE ONTO REFERENCE STRUCTURE
+    //-------------------------------------------------------------------------
+
+    // find transform of frame onto reference:
+    // (other particles are wrapped around the untransformed pore centre first
+    // and transformed afterwards, the box is no longer meaningful in the 
+    // reference frame, so that periodic images are not considered there) 
+    RigidBodyTransform fitTransform;
+    t_pbc *fitPbc = pbc;
+    if( channel.fitSuperposition_ )
+    {
+        if( channel.fitUnwrapper_ )
+        {
+            // fit group is kept in the same image as the pore:
+            std::vector<gmx::RVec> fitPositions = (*channel.fitUnwrapper_)(fr.x, pbc);
+            gmx::RVec fitCentre = MoleculeUnwrapper::centreOfGeometry(
+                    fitPositions);
+            gmx::RVec fitShift;
+            rvec_sub(
+                    MoleculeUnwrapper::nearestImage(fitCentre, poreCentre, pbc),
+                    fitCentre,
+                    fitShift);
+            for(auto &pos : fitPositions)
+            {
+                rvec_inc(pos, fitShift);
+            }
+            fitTransform = (*channel.fitSuperposition_)(fitPositions);
+        }
+        else
         {
-            // use explicitly given selection:
-            tmpsel = ippSel_;
+            fitTransform = (*channel.fitSuperposition_)(porePositions);
         }
-        else 
+
+        for(auto &pos : porePositions)
         {
-            // default to overall group of pore forming particles:
-            tmpsel = pathwaySel_;
+            pos = fitTransform.apply(pos);
         }
-     
+        fitPbc = nullptr;
+    }
+
+
+    // UPDATE INITIAL PROBE POSITION FOR THIS FRAME
+    //-------------------------------------------------------------------------
+
+    // recalculate initial probe position based on user-given group COM:
+    // (otherwise it is determined automatically below)
+    if( pfInitProbePosIsSet_ == false && ippSelIsSet_ == true )
+    {  
         // load data into initial position selection:
-        const gmx::Selection &initPosSelection = pdata -> parallelSelection(tmpsel);
+        const gmx::Selection &initPosSelection = pdata -> parallelSelection(channel.ippSel_);
  
         // initialse total mass and COM vector:
         real totalMass = 0.0;
@@ -901,16 +1559,20 @@ ChapTrajectoryAnalysis::analyzeFrame(
         // loop over all atoms: 
         for(int i = 0; i < initPosSelection.atomCount(); i++)
         {
-            // get i-th atom position:
+            // get i-th atom position (image closest to pore):
             gmx::SelectionPosition atom = initPosSelection.position(i);
+            gmx::RVec pos = MoleculeUnwrapper::nearestImage(
+                    atom.x(), 
+                    poreCentre, 
+                    pbc);
 
             // add to total mass:
             totalMass += atom.mass();
 
             // add to COM vector:
-            centreOfMass[XX] += atom.mass() * atom.x()[XX];
-            centreOfMass[YY] += atom.mass() * atom.x()[YY];
-            centreOfMass[ZZ] += atom.mass() * atom.x()[ZZ];
+            centreOfMass[XX] += atom.mass() * pos[XX];
+            centreOfMass[YY] += atom.mass() * pos[YY];
+            centreOfMass[ZZ] += atom.mass() * pos[ZZ];
         }
 
         // scale COM vector by total MASS:
@@ -918,10 +1580,11 @@ ChapTrajectoryAnalysis::analyzeFrame(
         centreOfMass[YY] /= 1.0 * totalMass;
         centreOfMass[ZZ] /= 1.0 * totalMass; 
 
+        // initial probe position is given in reference frame:
+        centreOfMass = fitTransform.apply(centreOfMass);
+
         // set initial probe position:
-        pfInitProbePos_[XX] = centreOfMass[XX];
-        pfInitProbePos_[YY] = centreOfMass[YY];
-        pfInitProbePos_[ZZ] = centreOfMass[ZZ];
+        channel.initProbePos_ = centreOfMass;
     }
 
 
@@ -944,24 +1607,74 @@ ChapTrajectoryAnalysis::analyzeFrame(
 				}
 
 
+    // ESTIMATE CHANNEL DIRECTION AND INITIAL PROBE POSITION
+    //-------------------------------------------------------------------------
+
+    // only done for quantities that have not been set by the user:
+    if( channel.axisEstimator_ )
+    {
+        // membrane particles in image closest to pore:
+        std::vector<gmx::RVec> membranePositions;
+        if( membraneSelIsSet_ )
+        {
+            const Selection &membSel = pdata -> parallelSelection(membraneSel_);
+            membranePositions.reserve(membSel.posCount());
+            for(int i = 0; i < membSel.posCount(); i++)
+            {
+                membranePositions.push_back(fitTransform.apply(
+                        MoleculeUnwrapper::nearestImage(
+                                membSel.position(i).x(), 
+                                poreCentre, 
+                                pbc)));
+            }
+        }
+
+        // update smoothed estimates:
+        channel.axisEstimator_ -> update(porePositions, selVdwRadii, membranePositions);
+        if( !pfChanDirVecIsSet_ )
+        {
+            channel.chanDirVec_ = channel.axisEstimator_ -> direction();
+        }
+        if( !pfInitProbePosIsSet_ && !ippSelIsSet_ )
+        {
+            channel.initProbePos_ = channel.axisEstimator_ -> initProbePos();
+        }
+    }
+
+    // frame was only needed for updating the axis estimate:
+    if( !isOwnFrame && !findRefPath && !registerProfile )
+    {
+        dhFrameStream.finishFrame();
+        return;
+    }
+
+
 				// PORE FINDING AND RADIUS CALCULATION
 				// ------------------------------------------------------------------------
 
-    // vectors as RVec:
-    RVec initProbePos(pfInitProbePos_[0], pfInitProbePos_[1], pfInitProbePos_[2]);
-    RVec chanDirVec(pfChanDirVec_[0], pfChanDirVec_[1], pfChanDirVec_[2]); 
+    // initial probe position and channel direction of this channel:
+    RVec initProbePos = channel.initProbePos_;
+    RVec chanDirVec = channel.chanDirVec_; 
 
     // create path finding module:
     std::unique_ptr<AbstractPathFinder> pfm;
     if( pfMethod_ == ePathFindingMethodInplaneOptimised )
     {
         // create inplane-optimised path finder:
-        pfm.reset(new InplaneOptimisedProbePathFinder(pfPar_,
-                                                      initProbePos,
-                                                      chanDirVec,
-                                                      pbc,
-                                                      refSelection,
-                                                      selVdwRadii));        
+        std::unique_ptr<InplaneOptimisedProbePathFinder> ippf(
+                new InplaneOptimisedProbePathFinder(pfPar_,
+                                                    initProbePos,
+                                                    chanDirVec,
+                                                    fitPbc,
+                                                    porePositions,
+                                                    selVdwRadii));
+
+        // pathway forming atoms define coarse hull for early termination:
+        if( pfParams_.hullMarginIsSet() )
+        {
+            ippf -> setHullPoints(porePositions);
+        }
+        pfm = std::move(ippf);
     }
     else if( pfMethod_ == ePathFindingMethodNaiveCylindrical )
     {        
@@ -979,23 +1692,38 @@ ChapTrajectoryAnalysis::analyzeFrame(
     //-------------------------------------------------------------------------
 
     // run path finding algorithm on current frame:
+    // (along a fixed reference pathway only the radii need to be found)
     std::cout.flush();
     clock_t tPathFinding = std::clock();
-    pfm -> findPath();
+    if( channel.refPath_ )
+    {
+        pfm -> findPathRadii(channel.refPath_ -> pathPoints());
+    }
+    else
+    {
+        pfm -> findPath();
+    }
     tPathFinding = (std::clock() - tPathFinding)/CLOCKS_PER_SEC;
 
     // retrieve molecular path object:
+    // (copying the reference retains its centre line and mapping data)
     std::cout.flush();
     clock_t tMolPath = std::clock();
-    MolecularPath molPath = pfm -> getMolecularPath();
+    MolecularPath molPath = channel.refPath_ ? *channel.refPath_ : pfm -> getMolecularPath();
+    if( channel.refPath_ )
+    {
+        molPath.setPathRadii(pfm -> pathRadii());
+    }
     tMolPath = (std::clock() - tMolPath)/CLOCKS_PER_SEC;
     
     // which method do we use for path alignment?
-    if( pfPathAlignmentMethod_ == ePathAlignmentMethodNone )
+    // (reference pathway has been aligned already)
+    real alignShift = 0.0;
+    if( channel.refPath_ || pfPathAlignmentMethod_ == ePathAlignmentMethodNone )
     {
         // no need to do anything in this case
     }
-    else if( pfPathAlignmentMethod_ == ePathAlignmentMethodIpp )
+    else
     {
         // map initial probe position onto pathway:
         std::vector<gmx::RVec> ipp;
@@ -1004,15 +1732,59 @@ ChapTrajectoryAnalysis::analyzeFrame(
 
         // shift coordinates of molecular path appropriately:
         molPath.shift(mappedIpp.front());
+        alignShift = mappedIpp.front()[SS];
     }
 
-    // get original path points and radii:
-    std::vector<gmx::RVec> pathPoints = molPath.pathPoints();
-    std::vector<real> pathRadii = molPath.pathRadii();
+    // refine alignment by registering radius profile against reference:
+    if( !channel.refPath_ && channel.profileRegistration_ )
+    {
+        // sample radius profile on registration grid:
+        real resolution = channel.profileRegistration_ -> resolution();
+        size_t numProfilePoints = std::floor(
+                (molPath.sHi() - molPath.sLo())/resolution) + 1;
+        std::vector<real> radiusProfile;
+        radiusProfile.reserve(numProfilePoints);
+        for(size_t i = 0; i < numProfilePoints; i++)
+        {
+            radiusProfile.push_back(
+                    molPath.radius(molPath.sLo() + i*resolution));
+        }
 
-    // add original path points to frame stream dataset:
-    dhFrameStream.selectDataSet(1);
-    for(size_t i = 0; i < pathPoints.size(); i++)
+        // shift pathway by lag of maximum cross-correlation:
+        gmx::RVec profileShift(0.0, 0.0, 0.0);
+        profileShift[SS] = (*channel.profileRegistration_)(
+                radiusProfile, 
+                molPath.sLo());
+        real sLo = molPath.sLo() - profileShift[SS];
+        molPath.shift(profileShift);
+        alignShift += profileShift[SS];
+
+        // aligned profile contributes to running reference:
+        channel.profileRegistration_ -> update(radiusProfile, sLo);
+    }
+
+    // keep aligned pathway as reference for all subsequent frames:
+    if( findRefPath )
+    {
+        channel.refPath_.reset(new MolecularPath(molPath));
+        prepareRefPathMappingGrid(channel);
+    }
+
+    // frame was only needed for finding the reference pathway or for
+    // updating the reference profile:
+    if( !isOwnFrame )
+    {
+        dhFrameStream.finishFrame();
+        return;
+    }
+
+    // get original path points and radii:
+    const std::vector<gmx::RVec> &pathPoints = molPath.pathPoints();
+    const std::vector<real> &pathRadii = molPath.pathRadii();
+
+    // add original path points to frame stream dataset:
+    dhFrameStream.selectDataSet(1);
+    for(size_t i = 0; i < pathPoints.size(); i++)
     {
         dhFrameStream.setPoint(0, pathPoints.at(i)[XX]);
         dhFrameStream.setPoint(1, pathPoints.at(i)[YY]);
@@ -1024,7 +1796,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
     // add radius spline knots and control points to frame stream dataset:
     dhFrameStream.selectDataSet(2);
     std::vector<real> radiusKnots = molPath.poreRadiusUniqueKnots();    
-    std::vector<real> radiusCtrlPoints = molPath.poreRadiusCtrlPoints();
+    const std::vector<real> &radiusCtrlPoints = molPath.poreRadiusCtrlPoints();
     for(size_t i = 0; i < radiusKnots.size(); i++)
     {
         dhFrameStream.setPoint(0, radiusKnots.at(i));
@@ -1035,7 +1807,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
     // add centre line spline knots and control points to frame stream dataset:
     dhFrameStream.selectDataSet(3);
     std::vector<real> centreLineKnots = molPath.centreLineUniqueKnots();    
-    std::vector<gmx::RVec> centreLineCtrlPoints = molPath.centreLineCtrlPoints();
+    const std::vector<gmx::RVec> &centreLineCtrlPoints = molPath.centreLineCtrlPoints();
     for(size_t i = 0; i < centreLineKnots.size(); i++)
     {
         dhFrameStream.setPoint(0, centreLineKnots.at(i));
@@ -1046,155 +1818,68 @@ ChapTrajectoryAnalysis::analyzeFrame(
     }
 
 
-    // MAP PORE PARTICLES ONTO PATHWAY
+    // CALCULATE ELECTROSTATIC POTENTIAL PROFILE
     //-------------------------------------------------------------------------
- 
-    // evaluate pore mapping selection for this frame:
-    t_trxframe frame = fr;
-    poreMappingSelCol_.evaluate(&frame, pbc);
-    const gmx::Selection poreMappingSelCal = pdata -> parallelSelection(poreMappingSelCal_);    
-    const gmx::Selection poreMappingSelCog = pdata -> parallelSelection(poreMappingSelCog_);    
-
-
-    // map pore residue COG onto pathway:
-    clock_t tMapResCog = std::clock();
-    std::map<int, gmx::RVec> poreCogMappedCoords = molPath.mapSelection(
-            poreMappingSelCog);
-    tMapResCog = (std::clock() - tMapResCog)/CLOCKS_PER_SEC;
-
-    // map pore residue C-alpha onto pathway:
-    clock_t tMapResCal = std::clock();
-    std::map<int, gmx::RVec> poreCalMappedCoords = molPath.mapSelection(
-            poreMappingSelCal);
-    tMapResCal = (std::clock() - tMapResCal)/CLOCKS_PER_SEC;
 
-    
-    // check if particles are pore-lining:
-    clock_t tResPoreLining = std::clock();
-    std::map<int, bool> poreLining = molPath.checkIfInside(
-            poreCogMappedCoords, 
-            poreMappingMargin_);
-    int nPoreLining = 0;
-    for(auto jt = poreLining.begin(); jt != poreLining.end(); jt++)
+    // only do this if a group of charged particles was specified:
+    if( esSelIsSet_ )
     {
-        if( jt -> second == true )
+        // PME requires periodic box:
+        if( !fr.bBox )
         {
-            nPoreLining++;
+            throw std::runtime_error("Calculation of the electrostatic "
+                                     "potential requires a simulation box.");
         }
-    }
-    tResPoreLining = (std::clock() - tResPoreLining)/CLOCKS_PER_SEC;
 
-    // check if residues are pore-facing:
-    // TODO: make this conditional on whether C-alphas are available
-    
-    clock_t tResPoreFacing = std::clock();
-    std::map<int, bool> poreFacing;
-    int nPoreFacing = 0;
-    for(auto it = poreCogMappedCoords.begin(); it != poreCogMappedCoords.end(); it++)
-    {
-        // is residue pore lining and has COG closer to centreline than CA?
-        if( it -> second[RR] < poreCalMappedCoords[it->first][RR] &&
-            poreLining[it -> first] == true &&
-            findPfResidues_ == true )
-        {
-            poreFacing[it->first] = true;
-            nPoreFacing++;
-        }
-        else
+        // get positions and charges of charged particles:
+        const Selection &esSelection = pdata -> parallelSelection(esSel_);
+        std::vector<gmx::RVec> chargePositions;
+        std::vector<real> charges;
+        chargePositions.reserve(esSelection.posCount());
+        charges.reserve(esSelection.posCount());
+        for(int i = 0; i < esSelection.posCount(); i++)
         {
-            poreFacing[it->first] = false;            
+            gmx::SelectionPosition pos = esSelection.position(i);
+            chargePositions.push_back(pos.x());
+            charges.push_back(pos.charge());
         }
-    }
-    tResPoreFacing = (std::clock() - tResPoreFacing)/CLOCKS_PER_SEC;
-    
 
-    // ESTIMATE HYDROPHOBICITY PROFILE
-    //-------------------------------------------------------------------------
-   
-    // get vectors of coordinates of pore-facing and -lining residues:
-    std::vector<real> plResidueCoordS;
-    std::vector<real> plResidueHydrophobicity;
-    std::vector<real> pfResidueCoordS;
-    std::vector<real> pfResidueHydrophobicity;
-    real minPoreResS = std::numeric_limits<real>::infinity();
-    real maxPoreResS = -std::numeric_limits<real>::infinity();
-    for(auto res : poreCogMappedCoords)
-    {
-        if( poreLining[res.first] )
-        {
-            plResidueCoordS.push_back(res.second[SS]);
-            plResidueHydrophobicity.push_back(
-                    resInfo_.hydrophobicity(res.first));
-        }
-        if( poreFacing[res.first] )
-        {
-            pfResidueCoordS.push_back(res.second[SS]);
-            pfResidueHydrophobicity.push_back(
-                    resInfo_.hydrophobicity(res.first));
-        }
+        // evaluation points on centre line:
+        size_t numEsPoints = std::ceil(
+                (molPath.length() + 2.0*outputExtrapDist_)/esResolution_) + 1;
+        std::vector<real> esArcLength = molPath.sampleArcLength(
+                numEsPoints, 
+                outputExtrapDist_);
+        std::vector<gmx::RVec> esPoints = molPath.samplePoints(esArcLength);
 
-        // also track the largest and smallest residue positions:
-        if( res.second[SS] < minPoreResS )
+        // evaluation points are mapped back into original frame:
+        if( channel.fitSuperposition_ )
         {
-            minPoreResS = res.second[SS];
+            for(auto &point : esPoints)
+            {
+                point = fitTransform.applyInverse(point);
+            }
         }
-        if( res.second[SS] > maxPoreResS )
+
+        // calculate potential with smooth particle mesh Ewald:
+        PmePotentialCalculator pme;
+        pme.setParameters(esParams_);
+        std::vector<real> esPotential = pme(
+                chargePositions, 
+                charges, 
+                fr.box, 
+                esPoints);
+
+        // add linear spline parameters to data handle:
+        dhFrameStream.selectDataSet(9);
+        for(size_t i = 0; i < esArcLength.size(); i++)
         {
-            maxPoreResS = res.second[SS];
+            dhFrameStream.setPoint(0, esArcLength[i]);
+            dhFrameStream.setPoint(1, esPotential[i]);
+            dhFrameStream.finishPointSet();
         }
     }
 
-    // add mock values at both ends to ensure profile goes to zero smoothly:
-    pfResidueCoordS.push_back(minPoreResS - hpBandWidth_/2.0);
-    pfResidueCoordS.push_back(maxPoreResS + hpBandWidth_/2.0);
-    pfResidueHydrophobicity.push_back(0.0);
-    pfResidueHydrophobicity.push_back(0.0);
-
-    plResidueCoordS.push_back(minPoreResS - hpBandWidth_/2.0);
-    plResidueCoordS.push_back(maxPoreResS + hpBandWidth_/2.0);
-    plResidueHydrophobicity.push_back(0.0);
-    plResidueHydrophobicity.push_back(0.0);
-
-    // set up kernel smoother:
-    WeightedKernelDensityEstimator kernelSmoother;
-    kernelSmoother.setParameters(hydrophobKernelParams_);
-
-    // estimate hydrophobicity profiles due to pore-lining residues:
-    SplineCurve1D plHydrophobicity = kernelSmoother.estimate(
-            plResidueCoordS, 
-            plResidueHydrophobicity);
-
-    // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(7);
-    for(size_t i = 0; i < plHydrophobicity.ctrlPoints().size(); i++)
-    {
-        dhFrameStream.setPoint(
-                0, 
-                plHydrophobicity.uniqueKnots().at(i));
-        dhFrameStream.setPoint(
-                1, 
-                plHydrophobicity.ctrlPoints().at(i));
-        dhFrameStream.finishPointSet();
-    }
-
-    // estimate hydrophobicity profiles due to pore-facing residues:
-    SplineCurve1D pfHydrophobicity = kernelSmoother.estimate(
-            pfResidueCoordS, 
-            pfResidueHydrophobicity);
-
-    // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(8);
-    for(size_t i = 0; i < pfHydrophobicity.ctrlPoints().size(); i++)
-    {
-        dhFrameStream.setPoint(
-                0, 
-                pfHydrophobicity.uniqueKnots().at(i));
-        dhFrameStream.setPoint(
-                1, 
-                pfHydrophobicity.ctrlPoints().at(i));
-        dhFrameStream.finishPointSet();
-    }
-
 
     // MAP SOLVENT PARTICLES ONTO PATHWAY
     //-------------------------------------------------------------------------
@@ -1205,23 +1890,36 @@ ChapTrajectoryAnalysis::analyzeFrame(
     std::map<int, bool> solvInsidePore;
     int numSolvInsideSample = 0;
     int numSolvInsidePore = 0;
+    std::vector<gmx::RVec> solvPorePositions;
+    std::vector<real> solvPoreCoordS;
 
     // only do this if solvent selection is valid:
     if( !solventSel_.empty() )
     {
-        // evaluate solvent mapping selections for this frame:
-        t_trxframe tmpFrame = fr;
-        solvMappingSelCol_.evaluate(&tmpFrame, pbc);
-
         // TODO: make this a parameter:
         real solvMappingMargin_ = 0.0;
             
         // get thread-local selection data:
         const Selection solvMapSel = pdata -> parallelSelection(solvMappingSelCog_);
 
-        // map particles onto pathway:
+        // map particles onto pathway (taking image closest to pore):
         clock_t tMapSol = std::clock();
-        solventMappedCoords = molPath.mapSelection(solvMapSel);
+        std::map<int, gmx::RVec> solventPositions;
+        for(int i = 0; i < solvMapSel.posCount(); i++)
+        {
+            int refId = solvMapSel.position(i).refId();
+            solventPositions[refId] = MoleculeUnwrapper::nearestImage(
+                    solvMapSel.position(i).x(), 
+                    poreCentre, 
+                    pbc);
+            if( channel.fitSuperposition_ )
+            {
+                solventPositions[refId] = fitTransform.apply(
+                        solventPositions[refId]);
+            }
+            solventMappedCoords[refId] = molPath.mapPosition(
+                    solventPositions[refId]);
+        }
         tMapSol = (std::clock() - tMapSol)/CLOCKS_PER_SEC;
 
         // find particles inside path (i.e. pore plus bulk sampling regime):
@@ -1254,6 +1952,20 @@ ChapTrajectoryAnalysis::analyzeFrame(
         }
         tSolInsidePore = (std::clock() - tSolInsidePore)/CLOCKS_PER_SEC;
 
+        // collect particles inside pore for water wire search:
+        solvPorePositions.reserve(numSolvInsidePore);
+        solvPoreCoordS.reserve(numSolvInsidePore);
+        for(auto jt = solvInsidePore.begin(); jt != solvInsidePore.end(); jt++)
+        {
+            if( jt -> second == true )
+            {
+                solvPorePositions.push_back(
+                        solventPositions[jt -> first]);
+                solvPoreCoordS.push_back(
+                        solventMappedCoords[jt -> first][SS]);
+            }
+        }
+
         // now add mapped residue coordinates to data handle:
         dhFrameStream.selectDataSet(5);
         
@@ -1268,9 +1980,9 @@ ChapTrajectoryAnalysis::analyzeFrame(
              dhFrameStream.setPoint(3, 0.0);                 // phi 
              dhFrameStream.setPoint(4, solvInsidePore[it -> first]);        // inside pore
              dhFrameStream.setPoint(5, solvInsideSample[it -> first]);      // inside sample
-             dhFrameStream.setPoint(6, solvMapSel.position(it -> first).x()[XX]);  // x
-             dhFrameStream.setPoint(7, solvMapSel.position(it -> first).x()[YY]);  // y
-             dhFrameStream.setPoint(8, solvMapSel.position(it -> first).x()[ZZ]);  // z
+             dhFrameStream.setPoint(6, solventPositions[it -> first][XX]);  // x
+             dhFrameStream.setPoint(7, solventPositions[it -> first][YY]);  // y
+             dhFrameStream.setPoint(8, solventPositions[it -> first][ZZ]);  // z
              dhFrameStream.finishPointSet();
         }
     }
@@ -1332,17 +2044,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
             solventSampleCoordS);
 
     // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(6);
-    for(size_t i = 0; i < solventDensityCoordS.ctrlPoints().size(); i++)
-    {
-        dhFrameStream.setPoint(
-                0, 
-                solventDensityCoordS.uniqueKnots().at(i));
-        dhFrameStream.setPoint(
-                1, 
-                solventDensityCoordS.ctrlPoints().at(i));
-        dhFrameStream.finishPointSet();
-    }
+    addSplineToFrameStream(dhFrameStream, 6, solventDensityCoordS);
 
     // track range covered by solvent:
     real solventRangeLo = solventDensityCoordS.uniqueKnots().front();
@@ -1361,6 +2063,145 @@ ChapTrajectoryAnalysis::analyzeFrame(
     std::pair<real, real> minSolventDensity = numberDensity.minimum(lim);
 
 
+    // FIND WATER WIRE ACROSS PORE
+    //-------------------------------------------------------------------------
+
+    // check whether solvent inside pore connects the openings:
+    WaterWireCalculator wwc(wwCutoff_);
+    WaterWire waterWire = wwc(
+            solvPorePositions, 
+            solvPoreCoordS, 
+            molPath.sLo(), 
+            molPath.sHi());
+
+
+    // MAP PORE RESIDUES ONTO PATHWAY
+    //-------------------------------------------------------------------------
+ 
+    // selections have been evaluated for all channels in analyzeFrame():
+    const gmx::Selection poreMappingSelCal = pdata -> parallelSelection(channel.poreMappingSelCal_);    
+    const gmx::Selection poreMappingSelCog = pdata -> parallelSelection(channel.poreMappingSelCog_);    
+
+    // gather atom coordinates of each residue:
+    std::vector<gmx::RVec> poreCogAtoms;
+    std::vector<size_t> poreCogOffsets;
+    gatherResidueAtoms(
+            fr, 
+            poreMappingSelCog, 
+            pbc, 
+            poreCentre, 
+            poreCogAtoms, 
+            poreCogOffsets);
+    std::vector<gmx::RVec> poreCalAtoms;
+    std::vector<size_t> poreCalOffsets;
+    if( channel.findPfResidues_ && 
+        poreMappingSelCal.posCount() == poreMappingSelCog.posCount() )
+    {
+        gatherResidueAtoms(
+                fr, 
+                poreMappingSelCal, 
+                pbc, 
+                poreCentre, 
+                poreCalAtoms, 
+                poreCalOffsets);
+    }
+
+    // residue atoms are moved into reference frame:
+    if( channel.fitSuperposition_ )
+    {
+        for(auto &atom : poreCogAtoms)
+        {
+            atom = fitTransform.apply(atom);
+        }
+        for(auto &atom : poreCalAtoms)
+        {
+            atom = fitTransform.apply(atom);
+        }
+    }
+
+    // map residues and evaluate pathway properties in a single pass:
+    PoreResidueMapper poreResidueMapper(poreMappingMargin_);
+    std::vector<MappedResidue> poreResidues = poreResidueMapper(
+            poreCogAtoms,
+            poreCogOffsets,
+            poreCalAtoms,
+            poreCalOffsets,
+            molPath,
+            solventDensityCoordS,
+            fitPbc);
+
+
+    // ESTIMATE HYDROPHOBICITY PROFILE
+    //-------------------------------------------------------------------------
+   
+    // get vectors of coordinates of pore-facing and -lining residues:
+    std::vector<real> plResidueCoordS;
+    std::vector<real> plResidueHydrophobicity;
+    std::vector<real> pfResidueCoordS;
+    std::vector<real> pfResidueHydrophobicity;
+    real minPoreResS = std::numeric_limits<real>::infinity();
+    real maxPoreResS = -std::numeric_limits<real>::infinity();
+    for(size_t i = 0; i < poreResidues.size(); i++)
+    {
+        // residue information is keyed by topology residue index:
+        int resId = poreMappingSelCog.position(i).mappedId();
+        real s = poreResidues[i].mappedCog_[SS];
+        if( poreResidues[i].poreLining_ )
+        {
+            plResidueCoordS.push_back(s);
+            plResidueHydrophobicity.push_back(
+                    resInfo_.hydrophobicity(resId));
+        }
+        if( poreResidues[i].poreFacing_ )
+        {
+            pfResidueCoordS.push_back(s);
+            pfResidueHydrophobicity.push_back(
+                    resInfo_.hydrophobicity(resId));
+        }
+
+        // also track the largest and smallest residue positions:
+        if( s < minPoreResS )
+        {
+            minPoreResS = s;
+        }
+        if( s > maxPoreResS )
+        {
+            maxPoreResS = s;
+        }
+    }
+
+    // add mock values at both ends to ensure profile goes to zero smoothly:
+    pfResidueCoordS.push_back(minPoreResS - hpBandWidth_/2.0);
+    pfResidueCoordS.push_back(maxPoreResS + hpBandWidth_/2.0);
+    pfResidueHydrophobicity.push_back(0.0);
+    pfResidueHydrophobicity.push_back(0.0);
+
+    plResidueCoordS.push_back(minPoreResS - hpBandWidth_/2.0);
+    plResidueCoordS.push_back(maxPoreResS + hpBandWidth_/2.0);
+    plResidueHydrophobicity.push_back(0.0);
+    plResidueHydrophobicity.push_back(0.0);
+
+    // set up kernel smoother:
+    WeightedKernelDensityEstimator kernelSmoother;
+    kernelSmoother.setParameters(hydrophobKernelParams_);
+
+    // estimate hydrophobicity profiles due to pore-lining residues:
+    SplineCurve1D plHydrophobicity = kernelSmoother.estimate(
+            plResidueCoordS, 
+            plResidueHydrophobicity);
+
+    // add spline curve parameters to data handle:   
+    addSplineToFrameStream(dhFrameStream, 7, plHydrophobicity);
+
+    // estimate hydrophobicity profiles due to pore-facing residues:
+    SplineCurve1D pfHydrophobicity = kernelSmoother.estimate(
+            pfResidueCoordS, 
+            pfResidueHydrophobicity);
+
+    // add spline curve parameters to data handle:   
+    addSplineToFrameStream(dhFrameStream, 8, pfHydrophobicity);
+
+
     // ADD AGGREGATE DATA TO PARALLELISABLE CONTAINER
     //-------------------------------------------------------------------------   
 
@@ -1382,41 +2223,32 @@ ChapTrajectoryAnalysis::analyzeFrame(
     dhFrameStream.setPoint(11, molPath.sLo()); 
     dhFrameStream.setPoint(12, molPath.sHi());
     dhFrameStream.setPoint(13, deParams_.bandWidth()*deParams_.bandWidthScale());
+    dhFrameStream.setPoint(14, waterWire.isConnected_);
+    dhFrameStream.setPoint(15, waterWire.gapLocation_);
+    dhFrameStream.setPoint(16, waterWire.gapWidth_);
+    dhFrameStream.setPoint(17, alignShift);
     dhFrameStream.finishPointSet();
 
 
     // ADD RESIDUE DATA TO CONTAINER
     //-------------------------------------------------------------------------
 
-    // get pore radius and solvent density at each residue's position:
-    std::map<int, real> poreRadiusAtResidue;
-    std::map<int, real> solventDensityAtResidue;
-    for(auto res : poreCogMappedCoords)
-    {
-        // get residue-local radius and density:
-        real rad = molPath.radius(res.second[SS]);
-        real den = solventDensityCoordS.evaluate(res.second[SS], 0);
-
-        // add radius and density to data handle:
-        poreRadiusAtResidue[res.first] = rad;
-        solventDensityAtResidue[res.first] = den;
-    }
-
     // add mapped residues to data container:
     dhFrameStream.selectDataSet(4);
-    for(auto it = poreCogMappedCoords.begin(); it != poreCogMappedCoords.end(); it++)
-    {
-        dhFrameStream.setPoint( 0, poreMappingSelCog.position(it -> first).mappedId());
-        dhFrameStream.setPoint( 1, it -> second[SS]);            // s
-        dhFrameStream.setPoint( 2, std::sqrt(it -> second[RR])); // rho
-        dhFrameStream.setPoint( 3, it -> second[PP]);            // phi
-        dhFrameStream.setPoint( 4, poreLining[it -> first]);     // pore lining?
-        dhFrameStream.setPoint( 5, poreFacing[it -> first]);     // pore facing?
-        dhFrameStream.setPoint( 6, poreRadiusAtResidue[it -> first]);
-        dhFrameStream.setPoint( 7, solventDensityAtResidue[it -> first]);
-        dhFrameStream.setPoint( 8, poreMappingSelCog.position(it -> first).x()[XX]);
-        dhFrameStream.setPoint( 9, poreMappingSelCog.position(it -> first).x()[YY]);
-        dhFrameStream.setPoint(10, poreMappingSelCog.position(it -> first).x()[ZZ]);
+    for(size_t i = 0; i < poreResidues.size(); i++)
+    {
+        const MappedResidue &res = poreResidues[i];
+        dhFrameStream.setPoint( 0, poreMappingSelCog.position(i).mappedId());
+        dhFrameStream.setPoint( 1, res.mappedCog_[SS]);            // s
+        dhFrameStream.setPoint( 2, std::sqrt(res.mappedCog_[RR])); // rho
+        dhFrameStream.setPoint( 3, res.mappedCog_[PP]);            // phi
+        dhFrameStream.setPoint( 4, res.poreLining_);               // pore lining?
+        dhFrameStream.setPoint( 5, res.poreFacing_);               // pore facing?
+        dhFrameStream.setPoint( 6, res.poreRadius_);
+        dhFrameStream.setPoint( 7, res.solventDensity_);
+        dhFrameStream.setPoint( 8, res.cog_[XX]);
+        dhFrameStream.setPoint( 9, res.cog_[YY]);
+        dhFrameStream.setPoint(10, res.cog_[ZZ]);
         dhFrameStream.finishPointSet();
     }
 
@@ -1436,12 +2268,46 @@ ChapTrajectoryAnalysis::analyzeFrame(
 void
 ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
 {
+    // worker processes are done once all frames have been written:
+    if( workerRank_ != 0 )
+    {
+        std::cout.flush();
+        _exit(EXIT_SUCCESS);
+    }
+
+    // collect frames analysed by worker processes:
+    if( numProcesses_ > 1 )
+    {
+        joinWorkers();
+        for(auto &channel : channels_)
+        {
+            mergeFrameStreams(*channel);
+        }
+    }
+
     // free line for neater output:
     std::cout<<std::endl;
 
+    // each channel is aggregated and written separately:
+    for(auto &channel : channels_)
+    {
+        finishChannel(*channel, numFrames);
+    }
+}
+
+
+/*!
+ * Aggregates the per-frame data of a single channel into time averages and 
+ * time series and writes the JSON, PDB, and OBJ output files of this channel.
+ */
+void
+ChapTrajectoryAnalysis::finishChannel(
+        PoreChannel &channel,
+        int numFrames)
+{
     // transfer file names from user input:
-    std::string inFileName = std::string("stream_") + outputJsonFileName_;
-    std::string outFileName = outputJsonFileName_;
+    std::string inFileName = frameStreamFileName(channel, 0);
+    std::string outFileName = channel.outputJsonFileName_;
     std::fstream inFile;
     std::fstream outFile;
 
@@ -1465,6 +2331,9 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     SummaryStatistics arcLengthLoSummary;
     SummaryStatistics arcLengthHiSummary;
     SummaryStatistics bandWidthSummary;
+    SummaryStatistics waterWireSummary;
+    SummaryStatistics waterWireGapSummary;
+    SummaryStatistics alignShiftSummary;
 
     // containers for scalar time series:
     std::vector<real> argMinRadiusTimeSeries;
@@ -1476,6 +2345,9 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     std::vector<real> argMinSolventDensityTimeSeries;
     std::vector<real> minSolventDensityTimeSeries;
     std::vector<real> bandWidthTimeSeries;
+    std::vector<real> waterWireTimeSeries;
+    std::vector<real> waterWireGapTimeSeries;
+    std::vector<real> alignShiftTimeSeries;
 
     // number of residues in pore forming group:
     size_t numPoreRes = 0;
@@ -1484,6 +2356,12 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     // container for time stamps:
     std::vector<real> timeStamps;
 
+    // detector for dewetting events:
+    DewettingEventDetector dewettingDetector(
+            dewetThresholdLo_,
+            dewetThresholdHi_,
+            dewetMinDuration_);
+
     // read file line by line and calculate summary statistics:
     int linesRead = 0;
     std::string line;
@@ -1530,6 +2408,17 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
                 lineDoc["pathSummary"]["arcLengthHi"][0].GetDouble());
         bandWidthSummary.update(
                 lineDoc["pathSummary"]["bandWidth"][0].GetDouble());
+        waterWireSummary.update(
+                lineDoc["pathSummary"]["waterWire"][0].GetDouble());
+        alignShiftSummary.update(
+                lineDoc["pathSummary"]["alignShift"][0].GetDouble());
+
+        // gap location is only meaningful if wire is broken:
+        if( lineDoc["pathSummary"]["waterWire"][0].GetDouble() == 0.0 )
+        {
+            waterWireGapSummary.update(
+                    lineDoc["pathSummary"]["waterWireGap"][0].GetDouble());
+        }
         
         // get time stamp of current frame:
         real timeStamp = lineDoc["pathSummary"]["timeStamp"][0].GetDouble();
@@ -1545,6 +2434,34 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
         argMinSolventDensityTimeSeries.push_back(lineDoc["pathSummary"]["argMinSolventDensity"][0].GetDouble());
         minSolventDensityTimeSeries.push_back(lineDoc["pathSummary"]["minSolventDensity"][0].GetDouble());
         bandWidthTimeSeries.push_back(lineDoc["pathSummary"]["bandWidth"][0].GetDouble());
+        waterWireTimeSeries.push_back(lineDoc["pathSummary"]["waterWire"][0].GetDouble());
+        waterWireGapTimeSeries.push_back(lineDoc["pathSummary"]["waterWireGap"][0].GetDouble());
+        alignShiftTimeSeries.push_back(lineDoc["pathSummary"]["alignShift"][0].GetDouble());
+
+        // check for dewetting:
+        dewettingDetector.update(
+                timeStamp,
+                lineDoc["pathSummary"]["minSolventDensity"][0].GetDouble(),
+                lineDoc["pathSummary"]["argMinSolventDensity"][0].GetDouble(),
+                lineDoc["pathSummary"]["numPath"][0].GetDouble());
+
+        // accumulate solvent displacements for diffusion profile:
+        if( channel.diffProfileCalc_ )
+        {
+            const rapidjson::Value &solvPos = lineDoc["solventPositions"];
+            std::map<int, real> solvArcLength;
+            std::map<int, bool> solvInsideSample;
+            for(size_t i = 0; i < solvPos["resId"].Size(); i++)
+            {
+                int id = solvPos["resId"][i].GetDouble();
+                solvArcLength[id] = solvPos["s"][i].GetDouble();
+                solvInsideSample[id] = solvPos["inSample"][i].GetDouble();
+            }
+            channel.diffProfileCalc_ -> update(
+                    solvArcLength, 
+                    solvInsideSample, 
+                    timeStamp);
+        }
 
         // in first line, also read number of residues in pore forming group:
         if( linesRead == 0 )
@@ -1564,6 +2481,9 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
 
     // close per frame data set:
     inFile.close();
+
+    // close event still open at end of trajectory:
+    dewettingDetector.finish();
     
     // sanity check:
     if( linesRead != numFrames )
@@ -1604,6 +2524,7 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     std::vector<SummaryStatistics> energySummary(supportPoints.size());
     std::vector<SummaryStatistics> plHydrophobicitySummary(supportPoints.size());
     std::vector<SummaryStatistics> pfHydrophobicitySummary(supportPoints.size());
+    std::vector<SummaryStatistics> esPotentialSummary(supportPoints.size());
 
     // prepare summary statistics for residue properties:
     std::vector<SummaryStatistics> residueArcSummary(numPoreRes);
@@ -1617,11 +2538,39 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     std::vector<SummaryStatistics> residueYSummary(numPoreRes);
     std::vector<SummaryStatistics> residueZSummary(numPoreRes);
 
+    // correlation of residue positions with constriction:
+    std::vector<CovarianceStatistics> residueRhoMinRadiusCorr(numPoreRes);
+    std::vector<CovarianceStatistics> residueRhoArgMinRadiusCorr(numPoreRes);
+    std::vector<CovarianceStatistics> residueArcMinRadiusCorr(numPoreRes);
+    std::vector<CovarianceStatistics> residueArcArgMinRadiusCorr(numPoreRes);
+
     // containers for profile valued time series: 
     std::vector<std::vector<real>> radiusProfileTimeSeries;
     std::vector<std::vector<real>> solventDensityTimeSeries;
     std::vector<std::vector<real>> plHydrophobicityTimeSeries;
     std::vector<std::vector<real>> pfHydrophobicityTimeSeries;
+    std::vector<std::vector<real>> esPotentialTimeSeries;
+
+    // rolling window and moving average aggregates of profiles:
+    std::map<std::string, TimeResolvedProfileAggregator> timeResolvedProfiles;
+    if( trWindow_ > 0 || trEmaTime_ > 0.0 )
+    {
+        std::vector<std::string> names = {"radius", 
+                                          "density", 
+                                          "energy", 
+                                          "plHydrophobicity", 
+                                          "pfHydrophobicity"};
+        if( esSelIsSet_ )
+        {
+            names.push_back("electrostaticPotential");
+        }
+        for(auto &name : names)
+        {
+            timeResolvedProfiles.emplace(
+                    name, 
+                    TimeResolvedProfileAggregator(trWindow_, trStride_, trEmaTime_));
+        }
+    }
 
     // read file line by line:
     int linesProcessed = 0;
@@ -1649,7 +2598,7 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
         // copy first frame from here for OBJ output:
         if( linesProcessed == 0 )
         {
-            molPathAvg_.reset(new MolecularPath(lineDoc));
+            channel.molPathAvg_.reset(new MolecularPath(lineDoc));
         }
 
 
@@ -1687,6 +2636,20 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
         plHydrophobicityTimeSeries.push_back(plHydrophobicitySample);
 
 
+        // sample points from electrostatic potential spline:
+        if( esSelIsSet_ )
+        {
+            SplineCurve1D esPotentialSpline = SplineCurve1DJsonConverter::fromJson(
+                    lineDoc["electrostaticPotentialSpline"], 1);
+            std::vector<real> esPotentialSample = 
+                    esPotentialSpline.evaluateMultiple(supportPoints, 0);
+            SummaryStatistics::updateMultiple(
+                    esPotentialSummary,
+                    esPotentialSample);
+            esPotentialTimeSeries.push_back(esPotentialSample);
+        }
+
+
         // sample points from solvent density spline:
         SplineCurve1D solventDensitySpline = SplineCurve1DJsonConverter::fromJson(
                 lineDoc["solventDensitySpline"], 1);
@@ -1729,6 +2692,33 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
         anchorEnergyLo.update( energySpline.evaluate(anchorPointLo, 0) );
         anchorEnergyHi.update( energySpline.evaluate(anchorPointHi, 0) );
 
+        // update time-resolved profiles:
+        if( !timeResolvedProfiles.empty() )
+        {
+            real t = lineDoc["pathSummary"]["timeStamp"][0].GetDouble();
+            timeResolvedProfiles.at("radius").update(t, radiusSample);
+            timeResolvedProfiles.at("density").update(t, solventDensitySample);
+            timeResolvedProfiles.at("energy").update(t, energySample);
+            timeResolvedProfiles.at("plHydrophobicity").update(
+                    t, plHydrophobicitySample);
+            timeResolvedProfiles.at("pfHydrophobicity").update(
+                    t, pfHydrophobicitySample);
+            if( esSelIsSet_ )
+            {
+                timeResolvedProfiles.at("electrostaticPotential").update(
+                        t, esPotentialTimeSeries.back());
+            }
+        }
+
+
+        // constriction in this frame:
+        real minRad = lineDoc["pathSummary"]["minRadius"][0].GetDouble();
+        real argMinRad = lineDoc["pathSummary"]["argMinRadius"][0].GetDouble();
+
+        // residue positions in this frame for correlation with constriction:
+        std::vector<real> resRho(numPoreRes);
+        std::vector<real> resArc(numPoreRes);
+        std::vector<bool> resIsPoreLining(numPoreRes);
 
         // loop over all pore forming residues:
         for(size_t i = 0; i < numPoreRes; i++)
@@ -1755,8 +2745,24 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
             real den = lineDoc["residuePositions"]["solventDensity"][i].GetDouble();
             residuePoreRadiusSummary.at(i).update(rad);
             residueSolventDensitySummary.at(i).update(den*totalNumber/(M_PI*rad*rad));
+
+            // collect residue position for correlation with constriction:
+            resRho[i] = lineDoc["residuePositions"]["rho"][i].GetDouble();
+            resArc[i] = lineDoc["residuePositions"]["s"][i].GetDouble();
+            resIsPoreLining[i] = 
+                    lineDoc["residuePositions"]["poreLining"][i].GetDouble() > 0.0;
         }
 
+        // correlation with constriction only while residue is pore-lining:
+        CovarianceStatistics::updateMultiple(
+                residueRhoMinRadiusCorr, resRho, minRad, resIsPoreLining);
+        CovarianceStatistics::updateMultiple(
+                residueRhoArgMinRadiusCorr, resRho, argMinRad, resIsPoreLining);
+        CovarianceStatistics::updateMultiple(
+                residueArcMinRadiusCorr, resArc, minRad, resIsPoreLining);
+        CovarianceStatistics::updateMultiple(
+                residueArcArgMinRadiusCorr, resArc, argMinRad, resIsPoreLining);
+
         // increment line counter:
         linesProcessed++;
     }
@@ -1767,6 +2773,10 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
             energySummary.begin(), 
             energySummary.end(), 
             [this, shift](SummaryStatistics &s){s.shift(shift);});
+    if( !timeResolvedProfiles.empty() )
+    {
+        timeResolvedProfiles.at("energy").shift(shift);
+    }
 
     // inform user about progress:
     std::cout.precision(3);
@@ -1791,10 +2801,13 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     // ------------------------------------------------------------------------
 
     // assign residue pore facing and pore lining to occupency and bfac:
-    outputStructure_.setPoreFacing(residuePlSummary, residuePfSummary);
+    outputStructure_.setPoreFacing(
+            poreResIds, 
+            residuePlSummary, 
+            residuePfSummary);
 
     // write structure to PDB file:
-    PdbIo::write(outputPdbFileName_, outputStructure_);
+    PdbIo::write(channel.outputPdbFileName_, outputStructure_);
 
 
     // CREATE OUTPUT JSON
@@ -1813,6 +2826,18 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     results.addPathwaySummary("argMinSolventDensity", argMinSolventDensitySummary);
     results.addPathwaySummary("minSolventDensity", minSolventDensitySummary);
     results.addPathwaySummary("bandWidth", bandWidthSummary);
+    results.addPathwaySummary("alignShift", alignShiftSummary);
+    if( !solventSel_.empty() )
+    {
+        results.addPathwaySummary(
+                "dewettingDuration", 
+                dewettingDetector.durationSummary());
+        results.addPathwaySummary(
+                "dewettingLocation", 
+                dewettingDetector.locationSummary());
+        results.addPathwaySummary("waterWire", waterWireSummary);
+        results.addPathwaySummary("waterWireGap", waterWireGapSummary);
+    }
 
     // add time-averaged pathway profiles:
     results.addSupportPoints(supportPoints);
@@ -1821,6 +2846,10 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     results.addPathwayProfile("pfHydrophobicity", pfHydrophobicitySummary);
     results.addPathwayProfile("density", solventDensitySummary);
     results.addPathwayProfile("energy", energySummary);
+    if( esSelIsSet_ )
+    {
+        results.addPathwayProfile("electrostaticPotential", esPotentialSummary);
+    }
     
     // add scalar time series data to output:
     results.addTimeStamps(timeStamps);
@@ -1833,6 +2862,12 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     results.addPathwayScalarTimeSeries("argMinSolventDensity", argMinSolventDensityTimeSeries);
     results.addPathwayScalarTimeSeries("minSolventDensity", minSolventDensityTimeSeries);
     results.addPathwayScalarTimeSeries("bandWidth", bandWidthTimeSeries);
+    results.addPathwayScalarTimeSeries("alignShift", alignShiftTimeSeries);
+    if( !solventSel_.empty() )
+    {
+        results.addPathwayScalarTimeSeries("waterWire", waterWireTimeSeries);
+        results.addPathwayScalarTimeSeries("waterWireGap", waterWireGapTimeSeries);
+    }
 
     // add vector-valued time series data to output:
     results.addPathwayGridPoints(timeStamps, supportPoints);
@@ -1840,6 +2875,37 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     results.addPathwayProfileTimeSeries("density", solventDensityTimeSeries);
     results.addPathwayProfileTimeSeries("plHydrophobicity", plHydrophobicityTimeSeries);
     results.addPathwayProfileTimeSeries("pfHydrophobicity", pfHydrophobicityTimeSeries);
+    if( esSelIsSet_ )
+    {
+        results.addPathwayProfileTimeSeries("electrostaticPotential", esPotentialTimeSeries);
+    }
+
+    // add time-resolved profiles:
+    if( !timeResolvedProfiles.empty() )
+    {
+        results.addTimeResolvedGridPoints(
+                timeResolvedProfiles.at("radius").timeStamps(), 
+                supportPoints);
+        for(auto &trp : timeResolvedProfiles)
+        {
+            results.addTimeResolvedProfile(trp.first, trp.second);
+        }
+    }
+
+    // add position-dependent diffusion coefficient:
+    if( channel.diffProfileCalc_ )
+    {
+        results.addDiffusionProfile(
+                channel.diffProfileCalc_ -> binCentres(),
+                channel.diffProfileCalc_ -> diffusionCoefficients(),
+                channel.diffProfileCalc_ -> numSamples());
+    }
+
+    // add list of dewetting events:
+    if( !solventSel_.empty() )
+    {
+        results.addDewettingEvents(dewettingDetector);
+    }
 
     // add per-residue data to output document:
     results.addResidueInformation(poreResIds, resInfo_);
@@ -1853,6 +2919,10 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     results.addResidueSummary("x", residueXSummary);
     results.addResidueSummary("y", residueYSummary);
     results.addResidueSummary("z", residueZSummary);
+    results.addResidueCorrelation("rhoMinRadiusCorr", residueRhoMinRadiusCorr);
+    results.addResidueCorrelation("rhoArgMinRadiusCorr", residueRhoArgMinRadiusCorr);
+    results.addResidueCorrelation("sMinRadiusCorr", residueArcMinRadiusCorr);
+    results.addResidueCorrelation("sArgMinRadiusCorr", residueArcArgMinRadiusCorr);
 
 
     // write results to JSON file:
@@ -1912,12 +2982,27 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
 
 
     // associate properties with pathway:
-    molPathAvg_ -> addScalarProperty("avg_radius", avgRadiusSpl, false);
-    molPathAvg_ -> addScalarProperty("avg_density", avgSolventDensitySpl, false);
+    channel.molPathAvg_ -> addScalarProperty("avg_radius", avgRadiusSpl, false);
+    channel.molPathAvg_ -> addScalarProperty("avg_density", avgSolventDensitySpl, false);
     // FIXME: NaN energy values can not be exported to OBJ!
-    molPathAvg_ -> addScalarProperty("avg_energy", avgEnergySpl, false);
-    molPathAvg_ -> addScalarProperty("avg_pl_hydrophobicity", avgPlHydrophobicitySpl, true);
-    molPathAvg_ -> addScalarProperty("avg_pf_hydrophobicity", avgPfHydrophobicitySpl, true);
+    channel.molPathAvg_ -> addScalarProperty("avg_energy", avgEnergySpl, false);
+    channel.molPathAvg_ -> addScalarProperty("avg_pl_hydrophobicity", avgPlHydrophobicitySpl, true);
+    channel.molPathAvg_ -> addScalarProperty("avg_pf_hydrophobicity", avgPfHydrophobicitySpl, true);
+
+    // electrostatic potential is only available if requested:
+    if( esSelIsSet_ )
+    {
+        std::vector<real> avgEsPotential;
+        for(size_t i = 0; i < supportPoints.size(); i++)
+        {
+            avgEsPotential.push_back(esPotentialSummary.at(i).mean());
+        }
+        auto avgEsPotentialSpl = interp(
+                supportPoints,
+                avgEsPotential,
+                eSplineInterpBoundaryHermite);
+        channel.molPathAvg_ -> addScalarProperty("avg_electrostatic_potential", avgEsPotentialSpl, true);
+    }
 
     // load colour palettes from JSON file:
     std::string paletteFilePath = chapInstallBase() + 
@@ -1930,10 +3015,11 @@ ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
     mpexp.setExtrapDist(outputExtrapDist_);
     mpexp.setGridSampleDist(outputGridSampleDist_);
     mpexp.setCorrectionThreshold(outputCorrectionThreshold_);
+    mpexp.setTessellationTolerance(outputTessellationTolerance_);
     mpexp(
-        outputBaseFileName_, 
+        channel.outputBaseFileName_, 
         "time_averaged_molecular_path", 
-        *molPathAvg_,
+        *channel.molPathAvg_,
         palettes);
 }
 
@@ -1988,11 +3074,6 @@ ChapTrajectoryAnalysis::checkParameters()
     // OUTPUT PARAMETERS
     //-------------------------------------------------------------------------
 
-    // add proper extensions to file names:
-    // TODO: better in exporter code?
-    outputJsonFileName_ = outputBaseFileName_ + ".json";
-    outputPdbFileName_ = outputBaseFileName_ + ".pdb";
-
     // sanity checks:
     if( outputExtrapDist_ < 0.0 )
     {
@@ -2010,11 +3091,55 @@ ChapTrajectoryAnalysis::checkParameters()
         throw std::runtime_error("Parameter -out-vis-teak must be in interval "
                                  "(-1, 1).");
     }
+    if( outputTessellationTolerance_ <= 0.0 )
+    {
+        throw std::runtime_error("Parameter -out-vis-tol must be strictly "
+                                 "positive.");
+    }
+
+
+    // PARALLELISATION PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( numProcesses_ < 1 )
+    {
+        throw std::runtime_error("Parameter -np must be at least one.");
+    }
 
 
     // PATH FINDING PARAMETERS
     //-------------------------------------------------------------------------
 
+    // radii along reference pathway require in-plane optimisation:
+    if( pfMode_ == ePathFindingModeReference && 
+        pfMethod_ != ePathFindingMethodInplaneOptimised )
+    {
+        throw std::runtime_error("Parameter -pf-mode reference requires "
+                                 "-pf-method inplane_optim.");
+    }
+
+    // one initial probe position or selection per channel:
+    if( pfInitProbePosIsSet_ && 
+        pfInitProbePos_.size() != 3*pathwaySel_.size() )
+    {
+        throw std::runtime_error("Parameter -pf-init-probe-pos requires three "
+                                 "values per pathway selection.");
+    }
+    if( ippSelIsSet_ && ippSel_.size() != pathwaySel_.size() )
+    {
+        throw std::runtime_error("Parameter -pf-sel-ipp requires one "
+                                 "selection per pathway selection.");
+    }
+
+    // user-supplied reference pathway can only describe one channel:
+    if( pfMode_ == ePathFindingModeReference && pfRefPathJsonIsSet_ && 
+        pathwaySel_.size() > 1 )
+    {
+        throw std::runtime_error("Parameter -pf-ref-path-json can only be "
+                                 "used with a single pathway selection.");
+    }
+
     // create random seed unless user has set seed explicitly:
     if( !saRandomSeedIsSet_ )
     {
@@ -2046,6 +3171,36 @@ ChapTrajectoryAnalysis::checkParameters()
         pfParams_.setNbhCutoff(cutoff_);
     }
 
+    // early termination outside of protein hull:
+    if( pfHullMargin_ >= 0.0 )
+    {
+        pfParams_.setHullMargin(pfHullMargin_);
+    }
+
+    // predictor-corrector optimisation of probe position:
+    if( pfPredTol_ >= 0.0 )
+    {
+        pfParams_.setPredictorTolerance(pfPredTol_);
+    }
+
+    // smoothing of automatic channel direction and initial probe position:
+    if( pfAutoSmooth_ <= 0.0 || pfAutoSmooth_ > 1.0 )
+    {
+        throw std::runtime_error("Parameter -pf-auto-smooth must be in "
+                                 "interval (0, 1].");
+    }
+
+
+    // PATH MAPPING PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( pmGridDist_ < 0.0 )
+    {
+        throw std::runtime_error("Parameter -pm-grid-dist may not be "
+                                 "negative.");
+    }
+
 
     // DENSITY ESTIMATION PARAMETERS
     //-------------------------------------------------------------------------
@@ -2075,5 +3230,377 @@ ChapTrajectoryAnalysis::checkParameters()
     hydrophobKernelParams_.setBandWidth(hpBandWidth_);
     hydrophobKernelParams_.setEvalRangeCutoff(hpEvalRangeCutoff_);
     hydrophobKernelParams_.setMaxEvalPointDist(hpResolution_);
+
+
+    // ELECTROSTATICS PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( esResolution_ <= 0.0 )
+    {
+        throw std::runtime_error("Parameter -es-res must be strictly "
+                                 "positive.");
+    }
+
+    // parameters for smooth particle mesh Ewald:
+    esParams_.setGridSpacing(esGridSpacing_);
+    esParams_.setSplineOrder(esSplineOrder_);
+    esParams_.setRealSpaceCutoff(esCutoff_);
+    esParams_.setEwaldTolerance(esEwaldTolerance_);
+
+    // check validity of PME parameters early:
+    if( esSelIsSet_ )
+    {
+        PmePotentialCalculator pme;
+        pme.setParameters(esParams_);
+    }
+
+
+    // DIFFUSION PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( diffMaxLag_ < 0 )
+    {
+        throw std::runtime_error("Parameter -diff-max-lag must not be "
+                                 "negative.");
+    }
+    if( diffBinWidth_ <= 0.0 )
+    {
+        throw std::runtime_error("Parameter -diff-bin-width must be strictly "
+                                 "positive.");
+    }
+
+
+
+    // DEWETTING PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( dewetThresholdHi_ < dewetThresholdLo_ )
+    {
+        throw std::runtime_error("Parameter -dewet-threshold-hi must not be "
+                                 "smaller than -dewet-threshold-lo.");
+    }
+    if( dewetMinDuration_ < 0.0 )
+    {
+        throw std::runtime_error("Parameter -dewet-min-duration must not be "
+                                 "negative.");
+    }
+
+
+    // WATER WIRE PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( wwCutoff_ <= 0.0 )
+    {
+        throw std::runtime_error("Parameter -ww-cutoff must be positive.");
+    }
+
+
+    // TIME-RESOLVED PROFILE PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( trWindow_ < 0 )
+    {
+        throw std::runtime_error("Parameter -tr-window must not be negative.");
+    }
+    if( trStride_ < 0 )
+    {
+        throw std::runtime_error("Parameter -tr-stride must not be negative.");
+    }
+    if( trEmaTime_ < 0.0 )
+    {
+        throw std::runtime_error("Parameter -tr-ema-time must not be "
+                                 "negative.");
+    }
+
+    // stride defaults to non-overlapping blocks:
+    if( trStride_ == 0 )
+    {
+        trStride_ = trWindow_;
+    }
+    if( trEmaTime_ > 0.0 && trStride_ == 0 )
+    {
+        throw std::runtime_error("Parameter -tr-stride must be set if "
+                                 "-tr-ema-time is used without -tr-window.");
+    }
+}
+
+
+
+/*!
+ * Adds the unique knots and control points of a one-dimensional spline curve
+ * to the given data set of the per-frame data stream, one point set per knot.
+ * Both are accessed by reference, so that the cost is linear in the number of
+ * knots.
+ */
+void
+ChapTrajectoryAnalysis::addSplineToFrameStream(
+        AnalysisDataHandle &dh,
+        int dataSet,
+        const SplineCurve1D &spline) const
+{
+    const std::vector<real> &knots = spline.uniqueKnots();
+    const std::vector<real> &ctrlPoints = spline.ctrlPoints();
+
+    dh.selectDataSet(dataSet);
+    for(size_t i = 0; i < ctrlPoints.size(); i++)
+    {
+        dh.setPoint(0, knots.at(i));
+        dh.setPoint(1, ctrlPoints.at(i));
+        dh.finishPointSet();
+    }
+}
+
+
+/*!
+ * Copies the coordinates of the atoms making up each position of a residue 
+ * selection into a contiguous vector, grouped by residue. On return, the atoms
+ * of the i-th selection position are found between elements i and i + 1 of
+ * the offset vector, which has one element more than there are positions.
+ * Each atom is taken in its periodic image closest to the given centre.
+ */
+void
+ChapTrajectoryAnalysis::gatherResidueAtoms(
+        const t_trxframe &fr,
+        const Selection &sel,
+        const t_pbc *pbc,
+        const gmx::RVec &centre,
+        std::vector<gmx::RVec> &atoms,
+        std::vector<size_t> &offsets) const
+{
+    atoms.clear();
+    atoms.reserve(sel.atomCount());
+    offsets.clear();
+    offsets.reserve(sel.posCount() + 1);
+    offsets.push_back(0);
+    for(int i = 0; i < sel.posCount(); i++)
+    {
+        for(int idx : sel.position(i).atomIndices())
+        {
+            atoms.push_back(
+                    MoleculeUnwrapper::nearestImage(fr.x[idx], centre, pbc));
+        }
+        offsets.push_back(atoms.size());
+    }
+}
+
+
+/*!
+ * Precomputes the lookup grid for mapping particles onto the fixed reference
+ * pathway. The grid covers a tube around the centre line whose radius is the
+ * maximum pathway radius plus the pore mapping margin, as particles further
+ * away are not of interest in most analyses (they are still mapped correctly,
+ * just without the help of the grid).
+ */
+void
+ChapTrajectoryAnalysis::prepareRefPathMappingGrid(PoreChannel &channel)
+{
+    if( pmGridDist_ > 0.0 )
+    {
+        channel.refPath_ -> prepareMappingGrid(
+                pfMaxProbeRadius_ + poreMappingMargin_, 
+                pmGridDist_);
+    }
+}
+
+
+/*!
+ * Returns the name of the file to which the given process writes the 
+ * per-frame data of the given channel. The parent process (rank zero) writes 
+ * to the file that is read in finishChannel().
+ */
+std::string
+ChapTrajectoryAnalysis::frameStreamFileName(
+        const PoreChannel &channel,
+        int rank) const
+{
+    if( rank == 0 )
+    {
+        return std::string("stream_") + channel.outputJsonFileName_;
+    }
+    return std::string("stream_") + std::to_string(rank) + "_" + 
+           channel.outputJsonFileName_;
+}
+
+
+/*!
+ * Forks numProcesses_ - 1 worker processes. This is called at the end of 
+ * initAnalysis(), i.e. after the topology has been read and all selections 
+ * and lookup tables have been set up, but before the trajectory is opened, so
+ * that each worker shares the setup copy-on-write and reads the trajectory 
+ * through its own file handle. Each worker writes the frames assigned to it
+ * to a separate per-frame data file for each channel.
+ *
+ * \throws std::runtime_error if a worker process can not be created.
+ */
+void
+ChapTrajectoryAnalysis::spawnWorkers()
+{
+    // flush output so that it is not duplicated in child processes:
+    std::cout.flush();
+    std::fflush(stdout);
+
+    for(int rank = 1; rank < numProcesses_; rank++)
+    {
+        pid_t pid = fork();
+        if( pid < 0 )
+        {
+            throw std::runtime_error("Could not create worker process " + 
+                                     std::to_string(rank) + ".");
+        }
+        if( pid == 0 )
+        {
+            // worker writes to its own file and spawns no further processes:
+            workerRank_ = rank;
+            workerPids_.clear();
+            for(auto &channel : channels_)
+            {
+                channel -> frameStreamExporter_ -> setFileName(
+                        frameStreamFileName(*channel, rank));
+            }
+            return;
+        }
+        workerPids_.push_back(pid);
+    }
 }
 
+
+/*!
+ * Waits for all worker processes to terminate.
+ *
+ * \throws std::runtime_error if any worker did not exit successfully.
+ */
+void
+ChapTrajectoryAnalysis::joinWorkers()
+{
+    bool success = true;
+    for(auto pid : workerPids_)
+    {
+        int status = 0;
+        if( waitpid(pid, &status, 0) != pid || 
+            !WIFEXITED(status) || 
+            WEXITSTATUS(status) != EXIT_SUCCESS )
+        {
+            success = false;
+        }
+    }
+    workerPids_.clear();
+
+    if( !success )
+    {
+        throw std::runtime_error("At least one worker process did not "
+                                 "finish successfully.");
+    }
+}
+
+
+/*!
+ * Merges the per-frame data files of a channel written by all processes into
+ * a single file ordered by frame index. As each file is already ordered, this is a 
+ * simple k-way merge that holds only one line per process in memory. Worker
+ * files are deleted afterwards.
+ *
+ * \throws std::runtime_error if a file can not be opened, read, written,
+ * removed, or renamed, or if a line does not start with a frame index.
+ */
+void
+ChapTrajectoryAnalysis::mergeFrameStreams(const PoreChannel &channel)
+{
+    // open per-process files:
+    std::vector<std::ifstream> inFiles(numProcesses_);
+    std::vector<std::string> lines(numProcesses_);
+    std::vector<int> frameIdx(numProcesses_);
+    std::vector<bool> isOpen(numProcesses_);
+
+    // reads next line from a file and extracts its frame index:
+    const std::string indexPrefix = "{\"i\":";
+    auto advance = [&](int rank)
+    {
+        isOpen[rank] = static_cast<bool>(std::getline(inFiles[rank], lines[rank]));
+        if( inFiles[rank].bad() )
+        {
+            throw std::runtime_error("Could not read per-frame data file " + 
+                                     frameStreamFileName(channel, rank) + ".");
+        }
+        if( !isOpen[rank] )
+        {
+            return;
+        }
+        if( lines[rank].compare(0, indexPrefix.size(), indexPrefix) != 0 )
+        {
+            throw std::runtime_error("Per-frame data file " + 
+                                     frameStreamFileName(channel, rank) + 
+                                     " is corrupted.");
+        }
+        frameIdx[rank] = std::atoi(lines[rank].c_str() + indexPrefix.size());
+    };
+
+    // read first line of each file:
+    for(int rank = 0; rank < numProcesses_; rank++)
+    {
+        inFiles[rank].open(frameStreamFileName(channel, rank));
+        if( !inFiles[rank].is_open() )
+        {
+            throw std::runtime_error("Could not open per-frame data file " + 
+                                     frameStreamFileName(channel, rank) + ".");
+        }
+        advance(rank);
+    }
+
+    // write lines in order of frame index:
+    std::string mergedFileName = frameStreamFileName(channel, 0) + ".merged";
+    std::ofstream outFile(mergedFileName);
+    if( !outFile.is_open() )
+    {
+        throw std::runtime_error("Could not open merged per-frame data file " +
+                                 mergedFileName + ".");
+    }
+    while( true )
+    {
+        // find open file with smallest frame index:
+        int next = -1;
+        for(int rank = 0; rank < numProcesses_; rank++)
+        {
+            if( isOpen[rank] && (next < 0 || frameIdx[rank] < frameIdx[next]) )
+            {
+                next = rank;
+            }
+        }
+        if( next < 0 )
+        {
+            break;
+        }
+
+        // transfer line and advance in this file:
+        outFile<<lines[next]<<"\n";
+        advance(next);
+    }
+    outFile.close();
+    if( outFile.fail() )
+    {
+        throw std::runtime_error("Could not write merged per-frame data file " +
+                                 mergedFileName + ".");
+    }
+
+    // replace parent file with merged file and remove worker files:
+    for(int rank = 0; rank < numProcesses_; rank++)
+    {
+        inFiles[rank].close();
+        if( std::remove(frameStreamFileName(channel, rank).c_str()) != 0 )
+        {
+            throw std::runtime_error("Could not remove per-frame data file " +
+                                     frameStreamFileName(channel, rank) + ".");
+        }
+    }
+    if( std::rename(mergedFileName.c_str(), 
+                    frameStreamFileName(channel, 0).c_str()) != 0 )
+    {
+        throw std::runtime_error("Could not rename merged per-frame data "
+                                 "file " + mergedFileName + " to " +
+                                 frameStreamFileName(channel, 0) + ".");
+    }
+}
@@ -0,0 +1,136 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "aggregation/dewetting_event_detector.hpp"
+
+
+/*!
+ * \brief Test fixture for DewettingEventDetector.
+ *
+ * Provides a hard-coded density time series with unit time step that contains
+ * a long dewetting event, a fluctuation around the lower threshold, a short 
+ * event, and an event that is still open at the end of the series.
+ */
+class DewettingEventDetectorTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        DewettingEventDetectorTest()
+        {
+            density_ = {30.0, 0.5, 0.2, 3.0, 0.1, 2.0, 20.0, 
+                        0.9, 1.1, 0.8, 12.0, 0.3, 15.0, 
+                        25.0, 0.4, 0.6};
+            location_ = {0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0,
+                         7.0, 8.0, 9.0, 10.0, 11.0, 12.0,
+                         13.0, 14.0, 15.0};
+        }
+
+    protected:
+
+        // test data:
+        std::vector<real> density_;
+        std::vector<real> location_;
+
+        // feed test data to a detector:
+        void runDetector(DewettingEventDetector &ded)
+        {
+            for(size_t i = 0; i < density_.size(); i++)
+            {
+                ded.update(i, density_[i], location_[i], density_[i]);
+            }
+            ded.finish();
+        }
+};
+
+
+/*!
+ * Checks that invalid parameters are rejected by the constructor.
+ */
+TEST_F(DewettingEventDetectorTest, DewettingEventDetectorExceptionTest)
+{
+    ASSERT_THROW(DewettingEventDetector(2.0, 1.0, 0.0), std::logic_error);
+    ASSERT_THROW(DewettingEventDetector(1.0, 2.0, -1.0), std::logic_error);
+    ASSERT_NO_THROW(DewettingEventDetector(1.0, 1.0, 0.0));
+}
+
+
+/*!
+ * Checks that the hysteresis merges fluctuations around the lower threshold 
+ * into single events and that the constriction location and minimum density
+ * are recorded correctly.
+ */
+TEST_F(DewettingEventDetectorTest, DewettingEventDetectorHysteresisTest)
+{
+    DewettingEventDetector ded(1.0, 10.0, 0.0);
+    runDetector(ded);
+
+    const std::vector<DewettingEvent> &events = ded.events();
+    ASSERT_EQ(4, events.size());
+
+    // first event contains a fluctuation above the lower threshold:
+    ASSERT_NEAR(1.0, events[0].start_, 1e-6);
+    ASSERT_NEAR(6.0, events[0].end_, 1e-6);
+    ASSERT_NEAR(4.0, events[0].location_, 1e-6);
+    ASSERT_NEAR(0.1, events[0].minDensity_, 1e-6);
+    ASSERT_NEAR(0.1, events[0].minNumPathway_, 1e-6);
+    ASSERT_TRUE(events[0].isComplete_);
+
+    // second event starts and ends in a single frame each:
+    ASSERT_NEAR(7.0, events[1].start_, 1e-6);
+    ASSERT_NEAR(10.0, events[1].end_, 1e-6);
+    ASSERT_NEAR(9.0, events[1].location_, 1e-6);
+
+    // last event is still open at end of series:
+    ASSERT_NEAR(14.0, events[3].start_, 1e-6);
+    ASSERT_NEAR(15.0, events[3].end_, 1e-6);
+    ASSERT_FALSE(events[3].isComplete_);
+
+    // check aggregate quantities:
+    ASSERT_EQ(4, ded.durationSummary().num());
+    ASSERT_NEAR((5.0 + 3.0 + 1.0 + 1.0)/4.0, ded.durationSummary().mean(), 1e-6);
+    ASSERT_NEAR((5.0 + 3.0 + 1.0 + 1.0)/15.0, ded.dewettedFraction(), 1e-6);
+}
+
+
+/*!
+ * Checks that events shorter than the minimum duration are discarded.
+ */
+TEST_F(DewettingEventDetectorTest, DewettingEventDetectorMinDurationTest)
+{
+    DewettingEventDetector ded(1.0, 10.0, 2.0);
+    runDetector(ded);
+
+    const std::vector<DewettingEvent> &events = ded.events();
+    ASSERT_EQ(2, events.size());
+    ASSERT_NEAR(1.0, events[0].start_, 1e-6);
+    ASSERT_NEAR(7.0, events[1].start_, 1e-6);
+    ASSERT_NEAR(6.5, ded.locationSummary().mean(), 1e-6);
+}
+
@@ -0,0 +1,146 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "aggregation/diffusion_profile_calculator.hpp"
+
+
+/*!
+ * \brief Test fixture for DiffusionProfileCalculator.
+ */
+class DiffusionProfileCalculatorTest : public ::testing::Test
+{
+
+};
+
+
+/*!
+ * Checks that invalid parameters are rejected by the constructor.
+ */
+TEST_F(DiffusionProfileCalculatorTest, DiffusionProfileCalculatorExceptionTest)
+{
+    ASSERT_THROW(DiffusionProfileCalculator(0, 0.1), std::logic_error);
+    ASSERT_THROW(DiffusionProfileCalculator(5, 0.0), std::logic_error);
+    ASSERT_NO_THROW(DiffusionProfileCalculator(1, 0.1));
+}
+
+
+/*!
+ * Checks that the diffusion coefficient of simulated one dimensional Brownian
+ * motion is recovered, even if the positions are subject to uncorrelated
+ * noise (as caused by mapping particles onto a centre line).
+ */
+TEST_F(DiffusionProfileCalculatorTest, DiffusionProfileCalculatorBrownianTest)
+{
+    // parameters of simulated motion:
+    const real diffCoef = 0.5;
+    const real timeStep = 2.0;
+    const real noiseSd = 0.5;
+    const int numParticles = 2000;
+    const int numFrames = 200;
+
+    // random number generation:
+    std::mt19937 rng(15011);
+    std::normal_distribution<real> step(0.0, std::sqrt(2.0*diffCoef*timeStep));
+    std::normal_distribution<real> noise(0.0, noiseSd);
+
+    // initial positions in a single wide bin:
+    std::vector<real> pos(numParticles, 0.0);
+
+    // all particles inside sample region:
+    std::map<int, bool> inside;
+    for(int i = 0; i < numParticles; i++)
+    {
+        inside[i] = true;
+    }
+
+    // propagate particles and update calculator:
+    DiffusionProfileCalculator dpc(5, 1e6);
+    for(int f = 0; f < numFrames; f++)
+    {
+        std::map<int, real> s;
+        for(int i = 0; i < numParticles; i++)
+        {
+            s[i] = pos[i] + noise(rng);
+            pos[i] += step(rng);
+        }
+        dpc.update(s, inside, f*timeStep);
+    }
+
+    // check estimate in all bins with data:
+    std::vector<real> estimate = dpc.diffusionCoefficients();
+    std::vector<int> numSamples = dpc.numSamples();
+    ASSERT_EQ(dpc.binCentres().size(), estimate.size());
+    ASSERT_EQ(estimate.size(), numSamples.size());
+    int totalSamples = 0;
+    for(size_t i = 0; i < estimate.size(); i++)
+    {
+        ASSERT_NEAR(diffCoef, estimate[i], 0.05*diffCoef);
+        totalSamples += numSamples[i];
+    }
+    ASSERT_EQ(numParticles*(numFrames - 1), totalSamples);
+}
+
+
+/*!
+ * Checks that displacements are binned by their starting position, that 
+ * particle histories are reset if a particle is missing from a frame, and that
+ * lag windows starting outside the sample region are ignored.
+ */
+TEST_F(DiffusionProfileCalculatorTest, DiffusionProfileCalculatorBinningTest)
+{
+    DiffusionProfileCalculator dpc(1, 1.0);
+
+    // particle moves with unit velocity, but is missing in third frame:
+    std::map<int, bool> inside = {{0, true}, {1, false}};
+    for(int f = 0; f < 5; f++)
+    {
+        std::map<int, real> s = {{1, -10.0 + f}};
+        if( f != 2 )
+        {
+            s[0] = f + 0.5;
+        }
+        dpc.update(s, inside, f);
+    }
+
+    // only displacements from frames 0 and 3 are valid:
+    std::vector<real> centres = dpc.binCentres();
+    std::vector<real> diffCoef = dpc.diffusionCoefficients();
+    std::vector<int> numSamples = dpc.numSamples();
+    ASSERT_EQ(2, centres.size());
+    ASSERT_NEAR(0.5, centres[0], 1e-6);
+    ASSERT_NEAR(3.5, centres[1], 1e-6);
+    for(size_t i = 0; i < centres.size(); i++)
+    {
+        ASSERT_NEAR(0.5, diffCoef[i], 1e-6);
+        ASSERT_EQ(1, numSamples[i]);
+    }
+}
+
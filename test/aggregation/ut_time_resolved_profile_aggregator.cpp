@@ -0,0 +1,143 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "aggregation/time_resolved_profile_aggregator.hpp"
+
+
+/*!
+ * \brief Test fixture for TimeResolvedProfileAggregator.
+ *
+ * Provides a series of two-point profiles (i, -2i) at times 10i.
+ */
+class TimeResolvedProfileAggregatorTest : public ::testing::Test
+{
+    public:
+
+        // feed test data to aggregator:
+        void runAggregator(
+                TimeResolvedProfileAggregator &agg,
+                int numFrames)
+        {
+            for(int i = 0; i < numFrames; i++)
+            {
+                agg.update(10.0*i, std::vector<real>({real(1.0*i), real(-2.0*i)}));
+            }
+        }
+};
+
+
+/*!
+ * Checks that invalid parameters are rejected by the constructor.
+ */
+TEST_F(TimeResolvedProfileAggregatorTest, TimeResolvedProfileAggregatorExceptionTest)
+{
+    ASSERT_THROW(TimeResolvedProfileAggregator(-1, 1, 0.0), std::logic_error);
+    ASSERT_THROW(TimeResolvedProfileAggregator(2, 0, 0.0), std::logic_error);
+    ASSERT_THROW(TimeResolvedProfileAggregator(0, 1, 0.0), std::logic_error);
+    ASSERT_THROW(TimeResolvedProfileAggregator(2, 2, -1.0), std::logic_error);
+
+    TimeResolvedProfileAggregator agg(2, 2, 0.0);
+    agg.update(0.0, std::vector<real>({1.0, 2.0}));
+    ASSERT_THROW(agg.update(1.0, std::vector<real>({1.0})), std::logic_error);
+}
+
+
+/*!
+ * Checks mean and standard deviation over non-overlapping blocks.
+ */
+TEST_F(TimeResolvedProfileAggregatorTest, TimeResolvedProfileAggregatorBlockTest)
+{
+    TimeResolvedProfileAggregator agg(4, 4, 0.0);
+    runAggregator(agg, 10);
+
+    // two complete blocks, incomplete last block is not recorded:
+    ASSERT_FALSE(agg.hasEma());
+    ASSERT_EQ(2, agg.timeStamps().size());
+    ASSERT_EQ(0, agg.ema().size());
+    ASSERT_NEAR(30.0, agg.timeStamps()[0], 1e-6);
+    ASSERT_NEAR(70.0, agg.timeStamps()[1], 1e-6);
+
+    // mean and sd of {0,1,2,3} and {4,5,6,7}:
+    real sd = std::sqrt(5.0/3.0);
+    ASSERT_NEAR(1.5, agg.mean()[0][0], 1e-6);
+    ASSERT_NEAR(-3.0, agg.mean()[0][1], 1e-6);
+    ASSERT_NEAR(5.5, agg.mean()[1][0], 1e-6);
+    ASSERT_NEAR(sd, agg.sd()[1][0], 1e-6);
+    ASSERT_NEAR(2.0*sd, agg.sd()[1][1], 1e-6);
+}
+
+
+/*!
+ * Checks mean over a rolling window and the shift of recorded profiles.
+ */
+TEST_F(TimeResolvedProfileAggregatorTest, TimeResolvedProfileAggregatorRollingTest)
+{
+    TimeResolvedProfileAggregator agg(3, 1, 0.0);
+    runAggregator(agg, 6);
+    agg.shift(1.0);
+
+    // one output per frame once window is full:
+    ASSERT_EQ(4, agg.timeStamps().size());
+    for(size_t i = 0; i < agg.timeStamps().size(); i++)
+    {
+        ASSERT_NEAR(10.0*(i + 2), agg.timeStamps()[i], 1e-6);
+        ASSERT_NEAR(i + 1.0 + 1.0, agg.mean()[i][0], 1e-6);
+        ASSERT_NEAR(1.0, agg.sd()[i][0], 1e-6);
+    }
+}
+
+
+/*!
+ * Checks the exponential moving average against a direct calculation.
+ */
+TEST_F(TimeResolvedProfileAggregatorTest, TimeResolvedProfileAggregatorEmaTest)
+{
+    real tau = 25.0;
+    TimeResolvedProfileAggregator agg(0, 2, tau);
+    runAggregator(agg, 6);
+
+    ASSERT_FALSE(agg.hasWindow());
+    ASSERT_EQ(3, agg.ema().size());
+    ASSERT_EQ(0, agg.mean().size());
+
+    // direct calculation with constant time step:
+    real alpha = 1.0 - std::exp(-10.0/tau);
+    real ema = 0.0;
+    for(int i = 1; i < 6; i++)
+    {
+        ema += alpha*(i - ema);
+        if( i % 2 == 1 )
+        {
+            ASSERT_NEAR(ema, agg.ema()[i/2][0], 1e-5);
+            ASSERT_NEAR(-2.0*ema, agg.ema()[i/2][1], 1e-5);
+        }
+    }
+}
+
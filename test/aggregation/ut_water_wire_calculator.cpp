@@ -0,0 +1,158 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "aggregation/water_wire_calculator.hpp"
+
+
+/*!
+ * \brief Test fixture for WaterWireCalculator.
+ *
+ * Provides a straight chain of particles along the z-axis with spacing 0.3 
+ * between the pore openings at s = 0 and s = 3, so that the arc length 
+ * coordinate of each particle equals its z-coordinate.
+ */
+class WaterWireCalculatorTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        WaterWireCalculatorTest()
+        {
+            for(int i = 0; i <= 10; i++)
+            {
+                positions_.push_back(gmx::RVec(0.0, 0.0, 0.3*i));
+                arcLength_.push_back(0.3*i);
+            }
+        }
+
+    protected:
+
+        // test data:
+        std::vector<gmx::RVec> positions_;
+        std::vector<real> arcLength_;
+        real sLo_ = 0.0;
+        real sHi_ = 3.0;
+
+        // remove the particle with the given index from the test data:
+        void removeParticle(size_t idx)
+        {
+            positions_.erase(positions_.begin() + idx);
+            arcLength_.erase(arcLength_.begin() + idx);
+        }
+};
+
+
+/*!
+ * Checks that invalid parameters and inconsistent input are rejected.
+ */
+TEST_F(WaterWireCalculatorTest, WaterWireCalculatorExceptionTest)
+{
+    ASSERT_THROW(WaterWireCalculator(0.0), std::logic_error);
+    ASSERT_THROW(WaterWireCalculator(-0.35), std::logic_error);
+
+    WaterWireCalculator wwc(0.35);
+    arcLength_.pop_back();
+    ASSERT_THROW(wwc(positions_, arcLength_, sLo_, sHi_), std::logic_error);
+}
+
+
+/*!
+ * Checks that an unbroken chain connects the openings and that a chain with
+ * one missing particle does not, in which case the gap must be located at the
+ * missing particle.
+ */
+TEST_F(WaterWireCalculatorTest, WaterWireCalculatorChainTest)
+{
+    WaterWireCalculator wwc(0.35);
+
+    // complete chain:
+    WaterWire wire = wwc(positions_, arcLength_, sLo_, sHi_);
+    ASSERT_TRUE(wire.isConnected_);
+    ASSERT_NEAR(0.0, wire.gapWidth_, std::numeric_limits<real>::epsilon());
+
+    // larger cutoff bridges a single missing particle:
+    removeParticle(4);
+    wire = WaterWireCalculator(0.65)(positions_, arcLength_, sLo_, sHi_);
+    ASSERT_TRUE(wire.isConnected_);
+    ASSERT_NEAR(1.2, wire.gapLocation_, 1e-5);
+
+    // but the default cutoff does not:
+    wire = wwc(positions_, arcLength_, sLo_, sHi_);
+    ASSERT_FALSE(wire.isConnected_);
+    ASSERT_NEAR(1.2, wire.gapLocation_, 1e-5);
+    ASSERT_NEAR(0.6, wire.gapWidth_, 1e-5);
+
+    // neither does a chain detached from the upper opening:
+    positions_.insert(positions_.begin() + 4, gmx::RVec(0.0, 0.0, 1.2));
+    arcLength_.insert(arcLength_.begin() + 4, 1.2);
+    removeParticle(10);
+    removeParticle(9);
+    wire = wwc(positions_, arcLength_, sLo_, sHi_);
+    ASSERT_FALSE(wire.isConnected_);
+    ASSERT_NEAR(2.7, wire.gapLocation_, 1e-5);
+    ASSERT_NEAR(0.6, wire.gapWidth_, 1e-5);
+
+    // an empty pore is one large gap:
+    wire = wwc(std::vector<gmx::RVec>(), std::vector<real>(), sLo_, sHi_);
+    ASSERT_FALSE(wire.isConnected_);
+    ASSERT_NEAR(1.5, wire.gapLocation_, 1e-5);
+    ASSERT_NEAR(3.0, wire.gapWidth_, 1e-5);
+}
+
+
+/*!
+ * Checks that particles that are close along the pathway but laterally 
+ * separated are not considered in contact, and that the result does not 
+ * depend on the order in which particles are given.
+ */
+TEST_F(WaterWireCalculatorTest, WaterWireCalculatorLateralTest)
+{
+    WaterWireCalculator wwc(0.35);
+
+    // shift upper half of chain sideways:
+    for(size_t i = 6; i < positions_.size(); i++)
+    {
+        positions_[i][XX] += 0.5;
+    }
+    WaterWire wire = wwc(positions_, arcLength_, sLo_, sHi_);
+    ASSERT_FALSE(wire.isConnected_);
+    ASSERT_NEAR(1.65, wire.gapLocation_, 1e-5);
+
+    // add bridging particle and reverse order:
+    positions_.push_back(gmx::RVec(0.25, 0.0, 1.65));
+    arcLength_.push_back(1.65);
+    std::reverse(positions_.begin(), positions_.end());
+    std::reverse(arcLength_.begin(), arcLength_.end());
+    wire = wwc(positions_, arcLength_, sLo_, sHi_);
+    ASSERT_TRUE(wire.isConnected_);
+}
+
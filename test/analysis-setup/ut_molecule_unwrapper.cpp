@@ -0,0 +1,172 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/pbcutil/pbc.h>
+
+#include "analysis-setup/molecule_unwrapper.hpp"
+
+
+/*!
+ * \brief Test fixture for MoleculeUnwrapper.
+ *
+ * Provides a cubic box of edge length 3.0 and a system of two linear chains
+ * of four atoms with bond length 0.5, which are both split across the 
+ * boundary in x, and one additional atom that is not part of the group.
+ */
+class MoleculeUnwrapperTest : public ::testing::Test
+{
+    public:
+
+        MoleculeUnwrapperTest()
+        {
+            matrix box = {{3.0, 0.0, 0.0}, {0.0, 3.0, 0.0}, {0.0, 0.0, 3.0}};
+            set_pbc(&pbc_, epbcXYZ, box);
+
+            // whole chains along x at y = 1.0 and y = 2.0:
+            for(int c = 0; c < 2; c++)
+            {
+                for(int i = 0; i < 4; i++)
+                {
+                    whole_.push_back(gmx::RVec(2.4 + 0.5*i, 1.0 + c, 1.5));
+                }
+            }
+
+            // put atoms into box and bond consecutive atoms of each chain:
+            for(size_t i = 0; i < whole_.size(); i++)
+            {
+                gmx::RVec pos = whole_[i];
+                pos[XX] = std::fmod(pos[XX], 3.0);
+                x_.push_back(pos);
+                atomIndices_.push_back(i);
+                if( i % 4 != 0 )
+                {
+                    bonds_.push_back(std::make_pair(i - 1, i));
+                }
+            }
+            x_.push_back(gmx::RVec(0.1, 0.1, 0.1));
+            bonds_.push_back(std::make_pair(7, 8));
+        }
+
+    protected:
+
+        t_pbc pbc_;
+        std::vector<gmx::RVec> whole_;
+        std::vector<gmx::RVec> x_;
+        std::vector<int> atomIndices_;
+        std::vector<std::pair<int, int>> bonds_;
+};
+
+
+/*!
+ * Checks that invalid groups are rejected.
+ */
+TEST_F(MoleculeUnwrapperTest, MoleculeUnwrapperExceptionTest)
+{
+    ASSERT_THROW(
+            MoleculeUnwrapper(std::vector<int>(), bonds_), 
+            std::logic_error);
+    ASSERT_THROW(
+            MoleculeUnwrapper(std::vector<int>({0, 1, 1}), bonds_), 
+            std::logic_error);
+}
+
+
+/*!
+ * Checks that split chains are made whole and kept together, and that atoms
+ * outside the group are ignored.
+ */
+TEST_F(MoleculeUnwrapperTest, MoleculeUnwrapperWholeTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    MoleculeUnwrapper unwrapper(atomIndices_, bonds_);
+    std::vector<gmx::RVec> pos = unwrapper(as_rvec_array(x_.data()), &pbc_);
+    ASSERT_EQ(whole_.size(), pos.size());
+
+    // bonds have original length:
+    for(size_t i = 0; i < pos.size(); i++)
+    {
+        if( i % 4 != 0 )
+        {
+            gmx::RVec d;
+            rvec_sub(pos[i], pos[i - 1], d);
+            ASSERT_NEAR(0.5, norm(d), eps);
+        }
+    }
+
+    // chains are side by side:
+    for(size_t i = 0; i < 4; i++)
+    {
+        gmx::RVec d;
+        rvec_sub(pos[i + 4], pos[i], d);
+        ASSERT_NEAR(0.0, d[XX], eps);
+        ASSERT_NEAR(1.0, d[YY], eps);
+    }
+
+    // without PBC coordinates are unchanged:
+    std::vector<gmx::RVec> raw = unwrapper(as_rvec_array(x_.data()), nullptr);
+    for(size_t i = 0; i < raw.size(); i++)
+    {
+        ASSERT_NEAR(x_[i][XX], raw[i][XX], eps);
+    }
+}
+
+
+/*!
+ * Checks that the group is placed in the image closest to the reference 
+ * centre and that nearestImage() wraps positions around a centre.
+ */
+TEST_F(MoleculeUnwrapperTest, MoleculeUnwrapperReferenceTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    MoleculeUnwrapper unwrapper(atomIndices_, bonds_);
+    unwrapper.setReferenceCentre(gmx::RVec(3.2, 1.5, 1.5));
+    std::vector<gmx::RVec> pos = unwrapper(as_rvec_array(x_.data()), &pbc_);
+    for(size_t i = 0; i < pos.size(); i++)
+    {
+        ASSERT_NEAR(whole_[i][XX], pos[i][XX], eps);
+        ASSERT_NEAR(whole_[i][YY], pos[i][YY], eps);
+    }
+
+    gmx::RVec cog = MoleculeUnwrapper::centreOfGeometry(pos);
+    ASSERT_NEAR(3.15, cog[XX], eps);
+
+    gmx::RVec img = MoleculeUnwrapper::nearestImage(x_.back(), cog, &pbc_);
+    ASSERT_NEAR(3.1, img[XX], eps);
+    ASSERT_NEAR(0.1, img[YY], eps);
+    ASSERT_NEAR(0.1, img[ZZ], eps);
+}
+
@@ -0,0 +1,250 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "electrostatics/pme_potential_calculator.hpp"
+
+
+/*!
+ * \brief Test fixture for PmePotentialCalculator.
+ *
+ * Sets up a small neutral system of point charges in a triclinic box and 
+ * provides a reference implementation of the conventional Ewald sum.
+ */
+class PmePotentialCalculatorTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        PmePotentialCalculatorTest()
+        {
+            // triclinic box:
+            box_[XX][XX] = 3.0; box_[XX][YY] = 0.0; box_[XX][ZZ] = 0.0;
+            box_[YY][XX] = 0.4; box_[YY][YY] = 2.8; box_[YY][ZZ] = 0.0;
+            box_[ZZ][XX] = -0.3; box_[ZZ][YY] = 0.5; box_[ZZ][ZZ] = 3.2;
+
+            // pairs of opposite charges:
+            for(int i = 0; i < 6; i++)
+            {
+                positions_.push_back(gmx::RVec(
+                        0.4*i + 0.1, std::fmod(1.7*i, 2.6), 0.5*i - 0.2));
+                positions_.push_back(gmx::RVec(
+                        3.0 - 0.3*i, 0.2 + 0.35*i, std::fmod(2.1*i, 3.0)));
+                charges_.push_back(0.1 + 0.1*i);
+                charges_.push_back(-0.1 - 0.1*i);
+            }
+
+            // evaluation points along a line:
+            for(int i = 0; i < 10; i++)
+            {
+                evalPoints_.push_back(gmx::RVec(1.35, 1.25, 0.31*i + 0.05));
+            }
+
+            // PME parameters:
+            params_.setGridSpacing(0.05);
+            params_.setSplineOrder(6);
+            params_.setRealSpaceCutoff(1.2);
+            params_.setEwaldTolerance(1e-5);
+        }
+
+
+    protected:
+
+        matrix box_;
+        std::vector<gmx::RVec> positions_;
+        std::vector<real> charges_;
+        std::vector<gmx::RVec> evalPoints_;
+        PmeParameters params_;
+
+        // conventional Ewald sum as reference:
+        std::vector<real> ewaldSum(real beta)
+        {
+            // volume and reciprocal box (for lower triangular box):
+            double vol = box_[XX][XX]*box_[YY][YY]*box_[ZZ][ZZ];
+            double rec[DIM][DIM] = {{0}};
+            rec[XX][XX] = 1.0/box_[XX][XX];
+            rec[YY][XX] = -box_[YY][XX]/(box_[XX][XX]*box_[YY][YY]);
+            rec[YY][YY] = 1.0/box_[YY][YY];
+            rec[ZZ][XX] = (box_[YY][XX]*box_[ZZ][YY] - box_[YY][YY]*box_[ZZ][XX])
+                        / (box_[XX][XX]*box_[YY][YY]*box_[ZZ][ZZ]);
+            rec[ZZ][YY] = -box_[ZZ][YY]/(box_[YY][YY]*box_[ZZ][ZZ]);
+            rec[ZZ][ZZ] = 1.0/box_[ZZ][ZZ];
+
+            std::vector<real> potential;
+            for(auto r : evalPoints_)
+            {
+                double phi = 0.0;
+
+                // real space sum over nearby images:
+                int nImg = 2;
+                for(int a = -nImg; a <= nImg; a++)
+                for(int b = -nImg; b <= nImg; b++)
+                for(int c = -nImg; c <= nImg; c++)
+                {
+                    for(size_t j = 0; j < positions_.size(); j++)
+                    {
+                        double d[DIM];
+                        for(int e = 0; e < DIM; e++)
+                        {
+                            d[e] = r[e] - positions_[j][e] - a*box_[XX][e] - 
+                                   b*box_[YY][e] - c*box_[ZZ][e];
+                        }
+                        double dist = std::sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+                        phi += charges_[j]*std::erfc(beta*dist)/dist;
+                    }
+                }
+
+                // reciprocal space sum:
+                int mMax = 12;
+                for(int a = -mMax; a <= mMax; a++)
+                for(int b = -mMax; b <= mMax; b++)
+                for(int c = -mMax; c <= mMax; c++)
+                {
+                    if( a == 0 && b == 0 && c == 0 )
+                    {
+                        continue;
+                    }
+                    double m[DIM];
+                    for(int e = 0; e < DIM; e++)
+                    {
+                        m[e] = a*rec[e][XX] + b*rec[e][YY] + c*rec[e][ZZ];
+                    }
+                    double mSq = m[0]*m[0] + m[1]*m[1] + m[2]*m[2];
+                    double fac = std::exp(-M_PI*M_PI*mSq/(beta*beta))/(M_PI*vol*mSq);
+                    for(size_t j = 0; j < positions_.size(); j++)
+                    {
+                        double arg = 0.0;
+                        for(int e = 0; e < DIM; e++)
+                        {
+                            arg += 2.0*M_PI*m[e]*(r[e] - positions_[j][e]);
+                        }
+                        phi += fac*charges_[j]*std::cos(arg);
+                    }
+                }
+
+                potential.push_back(138.935458*phi);
+            }
+
+            return potential;
+        }
+};
+
+
+/*!
+ * Checks that the Ewald splitting coefficient satisfies the defining relation
+ * with cutoff and tolerance.
+ */
+TEST_F(PmePotentialCalculatorTest, PmePotentialCalculatorEwaldCoefficientTest)
+{
+    PmePotentialCalculator pme;
+    pme.setParameters(params_);
+    ASSERT_NEAR(1e-5, std::erfc(pme.ewaldCoefficient()*1.2), 1e-7);
+}
+
+
+/*!
+ * Checks that the SPME potential agrees with a conventional Ewald summation
+ * at points inside and outside the primary unit cell.
+ */
+TEST_F(PmePotentialCalculatorTest, PmePotentialCalculatorEwaldSumTest)
+{
+    // absolute tolerance in kJ/mol/e:
+    real eps = 1e-2;
+
+    // calculate potential with SPME:
+    PmePotentialCalculator pme;
+    pme.setParameters(params_);
+    std::vector<real> potential = pme(positions_, charges_, box_, evalPoints_);
+
+    // reference potential:
+    std::vector<real> reference = ewaldSum(pme.ewaldCoefficient());
+
+    // compare:
+    ASSERT_EQ(reference.size(), potential.size());
+    for(size_t i = 0; i < reference.size(); i++)
+    {
+        ASSERT_NEAR(reference[i], potential[i], eps);
+    }
+}
+
+
+/*!
+ * Checks that the potential is periodic, i.e. invariant under translation of
+ * the evaluation points by a box vector.
+ */
+TEST_F(PmePotentialCalculatorTest, PmePotentialCalculatorPeriodicityTest)
+{
+    // absolute tolerance in kJ/mol/e:
+    real eps = 1e-2;
+
+    // shifted evaluation points:
+    std::vector<gmx::RVec> shiftedPoints = evalPoints_;
+    for(auto &point : shiftedPoints)
+    {
+        rvec_inc(point, box_[YY]);
+        rvec_dec(point, box_[ZZ]);
+    }
+
+    // calculate potential at original and shifted points:
+    PmePotentialCalculator pme;
+    pme.setParameters(params_);
+    std::vector<real> potential = pme(positions_, charges_, box_, evalPoints_);
+    std::vector<real> shiftedPotential = pme(
+            positions_, 
+            charges_, 
+            box_, 
+            shiftedPoints);
+
+    // compare:
+    for(size_t i = 0; i < potential.size(); i++)
+    {
+        ASSERT_NEAR(potential[i], shiftedPotential[i], eps);
+    }
+}
+
+
+/*!
+ * Checks that an exception is thrown if the real space cutoff exceeds the 
+ * dimensions of the box and if parameters are missing.
+ */
+TEST_F(PmePotentialCalculatorTest, PmePotentialCalculatorExceptionTest)
+{
+    // parameters not set:
+    PmePotentialCalculator pme;
+    ASSERT_THROW(
+            pme(positions_, charges_, box_, evalPoints_), 
+            std::logic_error);
+
+    // cutoff too large:
+    params_.setRealSpaceCutoff(3.5);
+    pme.setParameters(params_);
+    ASSERT_THROW(
+            pme(positions_, charges_, box_, evalPoints_), 
+            std::runtime_error);
+}
+
@@ -0,0 +1,173 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fourier/fast_fourier_transform.hpp"
+
+
+/*!
+ * \brief Test fixture for FastFourierTransform.
+ *
+ * Provides a naive discrete Fourier transform as reference.
+ */
+class FastFourierTransformTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        FastFourierTransformTest()
+        {
+            lengths_ = {1, 2, 7, 8, 12, 15, 30, 64};
+        }
+
+
+    protected:
+
+        // lengths to test:
+        std::vector<size_t> lengths_;
+
+        // deterministic test sequence:
+        std::vector<std::complex<real>> testSequence(size_t n)
+        {
+            std::vector<std::complex<real>> seq;
+            for(size_t i = 0; i < n; i++)
+            {
+                seq.push_back(std::complex<real>(
+                        std::sin(0.7*i) + 0.1*i, 
+                        std::cos(1.3*i*i)));
+            }
+            return seq;
+        }
+
+        // naive transform:
+        std::vector<std::complex<real>> naiveTransform(
+                const std::vector<std::complex<real>> &seq,
+                real sign)
+        {
+            size_t n = seq.size();
+            std::vector<std::complex<real>> res(n);
+            for(size_t k = 0; k < n; k++)
+            {
+                std::complex<double> sum = 0.0;
+                for(size_t j = 0; j < n; j++)
+                {
+                    double arg = sign*2.0*M_PI*j*k/n;
+                    sum += std::complex<double>(seq[j].real(), seq[j].imag())*
+                           std::complex<double>(std::cos(arg), std::sin(arg));
+                }
+                res[k] = std::complex<real>(sum.real(), sum.imag());
+            }
+            return res;
+        }
+};
+
+
+/*!
+ * Checks that forward and backward transforms agree with a naive evaluation 
+ * of the discrete Fourier transform for a range of lengths, including prime
+ * lengths and lengths with mixed factors.
+ */
+TEST_F(FastFourierTransformTest, FastFourierTransformNaiveTest)
+{
+    // floating point tolerance:
+    real eps = 1e-3;
+
+    for(auto n : lengths_)
+    {
+        std::vector<std::complex<real>> seq = testSequence(n);
+        FastFourierTransform fft(n);
+
+        // forward transform:
+        std::vector<std::complex<real>> fwd = seq;
+        fft(fwd, eFftDirectionForward);
+        std::vector<std::complex<real>> fwdRef = naiveTransform(seq, -1.0);
+        for(size_t i = 0; i < n; i++)
+        {
+            ASSERT_NEAR(fwdRef[i].real(), fwd[i].real(), eps);
+            ASSERT_NEAR(fwdRef[i].imag(), fwd[i].imag(), eps);
+        }
+
+        // backward transform:
+        std::vector<std::complex<real>> bwd = seq;
+        fft(bwd, eFftDirectionBackward);
+        std::vector<std::complex<real>> bwdRef = naiveTransform(seq, 1.0);
+        for(size_t i = 0; i < n; i++)
+        {
+            ASSERT_NEAR(bwdRef[i].real(), bwd[i].real(), eps);
+            ASSERT_NEAR(bwdRef[i].imag(), bwd[i].imag(), eps);
+        }
+    }
+}
+
+
+/*!
+ * Checks that a forward transform followed by a backward transform of a 
+ * three-dimensional array recovers the input scaled by the number of 
+ * elements.
+ */
+TEST_F(FastFourierTransformTest, FastFourierTransform3DRoundTripTest)
+{
+    // floating point tolerance:
+    real eps = 1e-4;
+
+    // array dimensions:
+    size_t nx = 6;
+    size_t ny = 5;
+    size_t nz = 8;
+    std::vector<std::complex<real>> data = testSequence(nx*ny*nz);
+
+    // forward and backward transform:
+    FastFourierTransform3D fft(nx, ny, nz);
+    std::vector<std::complex<real>> res = data;
+    fft(res, eFftDirectionForward);
+    fft(res, eFftDirectionBackward);
+
+    // check that input is recovered:
+    for(size_t i = 0; i < data.size(); i++)
+    {
+        ASSERT_NEAR(data[i].real(), res[i].real()/(nx*ny*nz), eps);
+        ASSERT_NEAR(data[i].imag(), res[i].imag()/(nx*ny*nz), eps);
+    }
+}
+
+
+/*!
+ * Checks that fastSize() returns the smallest number with prime factors 2, 3,
+ * and 5 only.
+ */
+TEST_F(FastFourierTransformTest, FastFourierTransformFastSizeTest)
+{
+    ASSERT_EQ(1, FastFourierTransform::fastSize(0));
+    ASSERT_EQ(1, FastFourierTransform::fastSize(1));
+    ASSERT_EQ(8, FastFourierTransform::fastSize(7));
+    ASSERT_EQ(12, FastFourierTransform::fastSize(11));
+    ASSERT_EQ(60, FastFourierTransform::fastSize(59));
+    ASSERT_EQ(125, FastFourierTransform::fastSize(121));
+}
+
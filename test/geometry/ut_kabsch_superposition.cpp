@@ -0,0 +1,166 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "geometry/kabsch_superposition.hpp"
+
+
+/*!
+ * \brief Test fixture for KabschSuperposition.
+ *
+ * Provides an asymmetric reference structure and a copy of it that has been
+ * rotated about an oblique axis and translated.
+ */
+class KabschSuperpositionTest : public ::testing::Test
+{
+    public:
+
+        KabschSuperpositionTest()
+        {
+            reference_.push_back(gmx::RVec(0.0, 0.0, 0.0));
+            reference_.push_back(gmx::RVec(1.5, 0.0, 0.0));
+            reference_.push_back(gmx::RVec(0.0, 2.0, 0.0));
+            reference_.push_back(gmx::RVec(0.0, 0.0, 0.5));
+            reference_.push_back(gmx::RVec(1.0, 1.0, 1.0));
+            weights_ = std::vector<real>({1.0, 2.0, 1.0, 3.0, 1.0});
+
+            // rotation by 50 degrees about normalised (1,1,1):
+            real a = 50.0*std::acos(-1.0)/180.0;
+            real c = std::cos(a);
+            real s = std::sin(a);
+            real n = 1.0/std::sqrt(3.0);
+            rvec u = {n, n, n};
+            for(int i = 0; i < DIM; i++)
+            {
+                for(int j = 0; j < DIM; j++)
+                {
+                    rotation_[i][j] = (1.0 - c)*u[i]*u[j];
+                }
+                rotation_[i][i] += c;
+            }
+            rotation_[XX][YY] -= s*u[ZZ];
+            rotation_[XX][ZZ] += s*u[YY];
+            rotation_[YY][XX] += s*u[ZZ];
+            rotation_[YY][ZZ] -= s*u[XX];
+            rotation_[ZZ][XX] -= s*u[YY];
+            rotation_[ZZ][YY] += s*u[XX];
+
+            gmx::RVec shift(3.0, -1.0, 2.0);
+            for(auto pos : reference_)
+            {
+                gmx::RVec tmp;
+                mvmul(rotation_, pos, tmp);
+                rvec_inc(tmp, shift);
+                mobile_.push_back(tmp);
+            }
+        }
+
+    protected:
+
+        std::vector<gmx::RVec> reference_;
+        std::vector<gmx::RVec> mobile_;
+        std::vector<real> weights_;
+        matrix rotation_;
+};
+
+
+/*!
+ * Checks that mismatched inputs are rejected.
+ */
+TEST_F(KabschSuperpositionTest, KabschSuperpositionExceptionTest)
+{
+    std::vector<real> weights(reference_.size() - 1, 1.0);
+    ASSERT_THROW(KabschSuperposition(reference_, weights), std::logic_error);
+    weights.assign(reference_.size(), 0.0);
+    ASSERT_THROW(KabschSuperposition(reference_, weights), std::logic_error);
+
+    KabschSuperposition fit(reference_, weights_);
+    mobile_.pop_back();
+    ASSERT_THROW(fit(mobile_), std::logic_error);
+}
+
+
+/*!
+ * Checks that a rotated and translated copy of the reference is mapped back
+ * onto the reference exactly.
+ */
+TEST_F(KabschSuperpositionTest, KabschSuperpositionRecoveryTest)
+{
+    real eps = 1e-4;
+    KabschSuperposition fit(reference_, weights_);
+    RigidBodyTransform trans = fit(mobile_);
+
+    for(size_t i = 0; i < reference_.size(); i++)
+    {
+        gmx::RVec pos = trans.apply(mobile_[i]);
+        ASSERT_NEAR(reference_[i][XX], pos[XX], eps);
+        ASSERT_NEAR(reference_[i][YY], pos[YY], eps);
+        ASSERT_NEAR(reference_[i][ZZ], pos[ZZ], eps);
+    }
+
+    // direction vectors are rotated by the inverse of the applied rotation:
+    gmx::RVec dir(0.0, 0.0, 1.0);
+    gmx::RVec rotDir;
+    mvmul(rotation_, dir, rotDir);
+    gmx::RVec back = trans.rotate(rotDir);
+    ASSERT_NEAR(dir[XX], back[XX], eps);
+    ASSERT_NEAR(dir[YY], back[YY], eps);
+    ASSERT_NEAR(dir[ZZ], back[ZZ], eps);
+}
+
+
+/*!
+ * Checks that the inverse transform undoes the forward transform and that a 
+ * structure identical to the reference yields the identity.
+ */
+TEST_F(KabschSuperpositionTest, KabschSuperpositionInverseTest)
+{
+    real eps = 1e-4;
+    KabschSuperposition fit(reference_, weights_);
+
+    RigidBodyTransform trans = fit(mobile_);
+    gmx::RVec pos(-0.7, 4.2, 1.3);
+    gmx::RVec back = trans.applyInverse(trans.apply(pos));
+    ASSERT_NEAR(pos[XX], back[XX], eps);
+    ASSERT_NEAR(pos[YY], back[YY], eps);
+    ASSERT_NEAR(pos[ZZ], back[ZZ], eps);
+
+    RigidBodyTransform ident = fit(reference_);
+    gmx::RVec same = ident.apply(pos);
+    ASSERT_NEAR(pos[XX], same[XX], eps);
+    ASSERT_NEAR(pos[YY], same[YY], eps);
+    ASSERT_NEAR(pos[ZZ], same[ZZ], eps);
+
+    RigidBodyTransform defaultTrans;
+    same = defaultTrans.applyInverse(defaultTrans.apply(pos));
+    ASSERT_NEAR(pos[XX], same[XX], eps);
+    ASSERT_NEAR(pos[YY], same[YY], eps);
+    ASSERT_NEAR(pos[ZZ], same[ZZ], eps);
+}
+
@@ -26,6 +26,7 @@
 #include <cmath>
 #include <limits>
 #include <iomanip>
+#include <random>
 
 #include <gtest/gtest.h>
 
@@ -440,6 +441,65 @@ TEST_F(SplineCurve3DTest, SplineCurve3DArcLengthReparameterisationTest)
 }
 
 
+/*!
+ * Tests the adaptive choice of sample points in the arc length 
+ * re-parameterisation. A straight line should be sampled much less densely 
+ * than a circular arc, which in turn should be sampled densely enough that 
+ * the curve has unit speed and stays on the circle. The curvature of the 
+ * circle is also checked.
+ */
+TEST_F(SplineCurve3DTest, SplineCurve3DAdaptiveArcLengthReparameterisationTest)
+{
+    // floating point comparison threshold:
+    real eps = 2.0*std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // point sets along a straight line and a semicircle of radius two:
+    const real PI = std::acos(-1.0);
+    real radius = 2.0;
+    size_t nPoints = 11;
+    std::vector<gmx::RVec> linePoints;
+    std::vector<gmx::RVec> circlePoints;
+    for(size_t i = 0; i < nPoints; i++)
+    {
+        real phi = i*PI/(nPoints - 1);
+        linePoints.push_back(gmx::RVec(0.0, 0.0, 0.2*i));
+        circlePoints.push_back(gmx::RVec(radius*std::cos(phi), 
+                                         radius*std::sin(phi), 
+                                         0.0));
+    }
+
+    // create splines by interpolation:
+    CubicSplineInterp3D Interp;
+    SplineCurve3D line = Interp(linePoints, eSplineInterpBoundaryHermite);
+    SplineCurve3D circle = Interp(circlePoints, eSplineInterpBoundaryHermite);
+
+    // tolerance must be positive:
+    ASSERT_THROW(line.arcLengthParam(0.0), std::logic_error);
+
+    // straight line is sampled densely only near its endpoints:
+    line.arcLengthParam();
+    ASSERT_LT(line.uniqueKnots().size(), 2*nPoints);
+    ASSERT_NEAR(2.0, line.length(), eps);
+
+    // curvature of interpolated circle:
+    ASSERT_NEAR(1.0/radius, circle.curvature(0.5*circle.uniqueKnots().back()), 1e-2);
+
+    // circle needs more knots than straight line:
+    circle.arcLengthParam();
+    ASSERT_LT(line.uniqueKnots().size(), circle.uniqueKnots().size());
+
+    // check unit speed and distance from circle centre:
+    int nEval = 100;
+    real circleLength = circle.length();
+    for(int i = 0; i < nEval; i++)
+    {
+        real evalPoint = i*circleLength/(nEval - 1);
+        ASSERT_NEAR(1.0, circle.speed(evalPoint), eps);
+        ASSERT_NEAR(radius, norm(circle.evaluate(evalPoint, 0)), 1e-3);
+    }
+}
+
+
 /*!
  * Test for the projection of points in Cartesian coordinates onto a spline 
  * curve. Two cases are considered: a linear spline curve and a spline curve 
@@ -719,3 +779,66 @@ TEST_F(SplineCurve3DTest, CartesianToCurvilinearExternalTest)
     }   
 }
 
+
+/*!
+ * Tests that mapping points with the precomputed lookup grid yields the same
+ * curvilinear coordinates as mapping without the grid, both inside the tube
+ * covered by the grid and outside of it, and that the grid remains valid
+ * after the curve parameter has been shifted.
+ */
+TEST_F(SplineCurve3DTest, CartesianToCurvilinearGridTest)
+{
+    // floating point comparison threshold:
+    real eps = 2.0*std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // create a point set describing a helix:
+    const real PI = std::acos(-1.0);
+    size_t nParams = 50;
+    std::vector<real> params;
+    std::vector<gmx::RVec> points;
+    for(unsigned int i = 0; i < nParams; i++)
+    {
+        real t = i*2.0*PI/(nParams - 1);
+        params.push_back(t);
+        points.push_back(gmx::RVec(std::cos(t), std::sin(t), 0.5*t));
+    }
+
+    // create arc length parameterised spline with and without grid:
+    CubicSplineInterp3D Interp;
+    SplineCurve3D splExact = Interp(params, points, eSplineInterpBoundaryHermite);
+    splExact.arcLengthParam();
+    SplineCurve3D splGrid = splExact;
+    ASSERT_FALSE(splGrid.mappingGridAvailable());
+    ASSERT_THROW(splGrid.prepareMappingGrid(0.0, 0.1), std::logic_error);
+    splGrid.prepareMappingGrid(0.4, 0.1);
+    ASSERT_TRUE(splGrid.mappingGridAvailable());
+
+    // shifting the parameter does not invalidate grid:
+    gmx::RVec shift(0.0, 0.7, 0.0);
+    splExact.shift(shift);
+    splGrid.shift(shift);
+
+    // random points in and around the tube:
+    std::default_random_engine generator;
+    std::uniform_real_distribution<real> angle(-0.5, 2.5*PI);
+    std::uniform_real_distribution<real> offset(-0.6, 0.6);
+    for(int i = 0; i < 1000; i++)
+    {
+        real t = angle(generator);
+        gmx::RVec point(std::cos(t) + offset(generator),
+                        std::sin(t) + offset(generator),
+                        0.5*t + offset(generator));
+
+        gmx::RVec curvExact = splExact.cartesianToCurvilinear(point);
+        gmx::RVec curvGrid = splGrid.cartesianToCurvilinear(point);
+        // (Brent's method only locates minimum to relative precision)
+        ASSERT_NEAR(curvExact[SS], curvGrid[SS], 
+                    eps*std::max(real(1.0), std::fabs(curvExact[SS])));
+        ASSERT_NEAR(curvExact[RR], curvGrid[RR], eps);
+    }
+
+    // re-parameterisation discards grid:
+    splGrid.arcLengthParam();
+    ASSERT_FALSE(splGrid.mappingGridAvailable());
+}
+
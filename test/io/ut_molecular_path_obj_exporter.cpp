@@ -28,6 +28,8 @@
 
 #include <gtest/gtest.h>
 
+#include "geometry/cubic_spline_interp_1D.hpp"
+#include "geometry/cubic_spline_interp_3D.hpp"
 #include "io/molecular_path_obj_exporter.hpp"
 
 
@@ -139,3 +141,132 @@ TEST_F(MolecularPathObjExporterTest, MolecularPathObjExporterAxisRotationTest)
     ASSERT_NEAR( vec[ZZ], rotZ[ZZ], 10*eps);
 }
 
+
+
+/*!
+ * Tests that the RegularVertexGrid stores vertices and normals only once for
+ * all properties and that the faces of different properties reference the
+ * same vertices. Uses a simple cylinder, on which all vertex normals should
+ * point in radial direction.
+ */
+TEST_F(MolecularPathObjExporterTest, RegularVertexGridSharedVerticesTest)
+{
+    const real PI = std::acos(-1.0);
+    const real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // grid coordinates:
+    std::vector<real> s = {0.0, 1.0, 2.0, 3.0};
+    std::vector<real> phi;
+    for(int j = 0; j < 8; j++)
+    {
+        phi.push_back(j*2.0*PI/8);
+    }
+
+    // build cylinder with two properties:
+    RegularVertexGrid grid(s, phi);
+    for(size_t i = 0; i < s.size(); i++)
+    {
+        for(size_t j = 0; j < phi.size(); j++)
+        {
+            grid.addVertex(
+                    i, 
+                    j, 
+                    gmx::RVec(std::cos(phi[j]), std::sin(phi[j]), s[i]));
+            grid.addWeight(i, j, "a", i/3.0);
+            grid.addWeight(i, j, "b", 1.0 - i/3.0);
+        }
+    }
+    grid.normalsFromFaces();
+
+    // vertices and normals are stored once:
+    auto vertices = grid.vertices();
+    auto normals = grid.normals();
+    ASSERT_EQ(s.size()*phi.size(), vertices.size());
+    ASSERT_EQ(s.size()*phi.size(), normals.size());
+
+    // interior normals point in radial direction:
+    for(size_t k = phi.size(); k < vertices.size() - phi.size(); k++)
+    {
+        real radial = normals[k][XX]*vertices[k][XX] + 
+                      normals[k][YY]*vertices[k][YY];
+        ASSERT_NEAR(1.0, std::fabs(radial), eps);
+    }
+
+    // faces of both properties reference the same vertices:
+    auto facesA = grid.faces("a");
+    auto facesB = grid.faces("b");
+    ASSERT_EQ(facesA.size(), facesB.size());
+    for(size_t k = 0; k < facesA.size(); k++)
+    {
+        for(int l = 0; l < facesA[k].numVertices(); l++)
+        {
+            ASSERT_EQ(facesA[k].vertexIdx(l), facesB[k].vertexIdx(l));
+            ASSERT_LE(1, facesA[k].vertexIdx(l));
+            ASSERT_GE(vertices.size(), facesA[k].vertexIdx(l));
+        }
+    }
+}
+
+
+/*!
+ * Tests that the surface resolution adapts to the pathway geometry: a 
+ * straight cylinder needs no refinement beyond the sample distance, while a
+ * bent pathway with varying radius is refined, and the number of vertices 
+ * per ring grows with the radius.
+ */
+TEST_F(MolecularPathObjExporterTest, MolecularPathObjExporterTessellationTest)
+{
+    // object to test on:
+    MolecularPathObjExporter molPathExp;
+    molPathExp.setGridSampleDist(0.5);
+    molPathExp.setTessellationTolerance(0.01);
+    ASSERT_THROW(molPathExp.setTessellationTolerance(0.0), std::runtime_error);
+
+    // straight centre line and bent centre line: 
+    std::vector<real> t;
+    std::vector<gmx::RVec> straightPoints;
+    std::vector<gmx::RVec> bentPoints;
+    std::vector<real> constRadius;
+    std::vector<real> varRadius;
+    for(int i = 0; i <= 20; i++)
+    {
+        real z = 0.25*i;
+        t.push_back(z);
+        straightPoints.push_back(gmx::RVec(0.0, 0.0, z));
+        bentPoints.push_back(gmx::RVec(std::sin(z), 0.0, z));
+        constRadius.push_back(1.0);
+        varRadius.push_back(1.0 - 0.5*std::exp(-(z - 2.5)*(z - 2.5)));
+    }
+    CubicSplineInterp3D interp3D;
+    CubicSplineInterp1D interp1D;
+    SplineCurve3D straight = interp3D(t, straightPoints, eSplineInterpBoundaryHermite);
+    SplineCurve3D bent = interp3D(t, bentPoints, eSplineInterpBoundaryHermite);
+    SplineCurve1D constRad = interp1D(t, constRadius, eSplineInterpBoundaryHermite);
+    SplineCurve1D varRad = interp1D(t, varRadius, eSplineInterpBoundaryHermite);
+    std::pair<real, real> range(0.0, 5.0);
+
+    // straight cylinder only uses initial partition:
+    std::vector<real> s = molPathExp.tessellateArcLength(
+            straight, constRad, range);
+    ASSERT_EQ(11, s.size());
+    ASSERT_NEAR(range.first, s.front(), std::numeric_limits<real>::epsilon());
+    ASSERT_NEAR(range.second, s.back(), 1e-5);
+
+    // bent pathway is refined and points remain ordered:
+    std::vector<real> sBent = molPathExp.tessellateArcLength(
+            bent, varRad, range);
+    ASSERT_GT(sBent.size(), s.size());
+    for(size_t i = 1; i < sBent.size(); i++)
+    {
+        ASSERT_GT(sBent[i], sBent[i - 1]);
+    }
+
+    // sagitta of ring polygon is within tolerance:
+    size_t numPhi = molPathExp.tessellateAngle(constRad, s);
+    ASSERT_LE(1.0 - std::cos(M_PI/numPhi), 0.01);
+    ASSERT_GT(1.0 - std::cos(M_PI/(numPhi - 1)), 0.01);
+
+    // smaller radius needs fewer vertices per ring:
+    ASSERT_LE(molPathExp.tessellateAngle(varRad, s), numPhi);
+}
+
@@ -0,0 +1,302 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "path-finding/channel_axis_estimator.hpp"
+
+
+/*!
+ * \brief Test fixture for ChannelAxisEstimator.
+ *
+ * Provides a generator for atoms arranged in rings around a cylinder axis.
+ */
+class ChannelAxisEstimatorTest : public ::testing::Test
+{
+    public:
+
+        // rings of atoms on a cylinder surface:
+        std::vector<gmx::RVec> cylinder(
+                gmx::RVec centre,
+                gmx::RVec axis,
+                real radius,
+                real length,
+                int numRings,
+                int numPerRing)
+        {
+            unitv(axis, axis);
+            gmx::RVec u(0.0, 1.0, 0.0);
+            if( std::fabs(axis[YY]) > 0.9 )
+            {
+                u = gmx::RVec(1.0, 0.0, 0.0);
+            }
+            gmx::RVec v;
+            cprod(axis, u, v);
+            unitv(v, v);
+            cprod(v, axis, u);
+
+            std::vector<gmx::RVec> positions;
+            for(int i = 0; i < numRings; i++)
+            {
+                real a = -0.5*length + length*i/(numRings - 1);
+                for(int j = 0; j < numPerRing; j++)
+                {
+                    real phi = 2.0*std::acos(-1.0)*j/numPerRing;
+                    gmx::RVec pos = centre;
+                    for(int d = 0; d < DIM; d++)
+                    {
+                        pos[d] += a*axis[d] + radius*std::cos(phi)*u[d] 
+                                + radius*std::sin(phi)*v[d];
+                    }
+                    positions.push_back(pos);
+                }
+            }
+            return positions;
+        }
+};
+
+
+/*!
+ * Checks that invalid parameters and inputs are rejected.
+ */
+TEST_F(ChannelAxisEstimatorTest, ChannelAxisEstimatorExceptionTest)
+{
+    gmx::RVec dir(0.0, 0.0, 1.0);
+    ASSERT_THROW(
+            ChannelAxisEstimator(gmx::RVec(0.0, 0.0, 0.0), true, 0.5), 
+            std::logic_error);
+    ASSERT_THROW(ChannelAxisEstimator(dir, true, 0.0), std::logic_error);
+    ASSERT_THROW(ChannelAxisEstimator(dir, true, 1.5), std::logic_error);
+
+    ChannelAxisEstimator est(dir, true, 1.0);
+    std::vector<gmx::RVec> positions = cylinder(
+            dir, dir, 1.0, 2.0, 5, 8);
+    std::vector<real> radii(positions.size() - 1, 0.1);
+    std::vector<gmx::RVec> membrane;
+    ASSERT_THROW(est.update(positions, radii, membrane), std::logic_error);
+}
+
+
+/*!
+ * Checks that the axis of a tilted and off-centre cylinder is found with the
+ * sign given by the initial direction and that the initial probe position 
+ * lies on this axis.
+ */
+TEST_F(ChannelAxisEstimatorTest, ChannelAxisEstimatorTiltedCylinderTest)
+{
+    real eps = 1e-4;
+    gmx::RVec centre(2.0, 3.0, 4.0);
+    gmx::RVec axis(-1.0, 0.0, 1.0);
+    unitv(axis, axis);
+    std::vector<gmx::RVec> positions = cylinder(
+            centre, axis, 1.0, 4.0, 17, 12);
+    std::vector<real> radii(positions.size(), 0.15);
+    std::vector<gmx::RVec> membrane;
+
+    ChannelAxisEstimator est(gmx::RVec(0.0, 0.0, 1.0), true, 1.0);
+    est.update(positions, radii, membrane);
+
+    gmx::RVec dir = est.direction();
+    ASSERT_NEAR(1.0, iprod(dir, axis), eps);
+
+    // probe position on axis:
+    gmx::RVec d;
+    rvec_sub(est.initProbePos(), centre, d);
+    real a = iprod(d, axis);
+    ASSERT_NEAR(0.0, norm2(d) - a*a, eps);
+}
+
+
+/*!
+ * Checks that the membrane normal overrides the shape-based choice of axis 
+ * and that a fixed direction is retained.
+ */
+TEST_F(ChannelAxisEstimatorTest, ChannelAxisEstimatorMembraneTest)
+{
+    real eps = 1e-4;
+
+    // flat group that is most elongated along y:
+    std::vector<gmx::RVec> positions;
+    for(int i = -2; i <= 2; i++)
+    {
+        for(int j = -4; j <= 4; j++)
+        {
+            for(int k = -1; k <= 1; k++)
+            {
+                positions.push_back(gmx::RVec(0.5*i, 0.5*j, 0.5*k));
+            }
+        }
+    }
+    std::vector<real> radii(positions.size(), 0.1);
+
+    // membrane in the y-z-plane:
+    std::vector<gmx::RVec> membrane;
+    for(int j = -10; j <= 10; j++)
+    {
+        for(int k = -10; k <= 10; k++)
+        {
+            membrane.push_back(gmx::RVec(1.5, 0.5*j, 0.5*k));
+            membrane.push_back(gmx::RVec(-1.5, 0.5*j, 0.5*k));
+        }
+    }
+
+    // without membrane the distinct axis is y:
+    ChannelAxisEstimator est(gmx::RVec(1.0, 1.0, 0.0), true, 1.0);
+    est.update(positions, radii, std::vector<gmx::RVec>());
+    ASSERT_NEAR(1.0, est.direction()[YY], eps);
+
+    // with membrane the membrane normal is used:
+    ChannelAxisEstimator membEst(gmx::RVec(1.0, 1.0, 0.0), true, 1.0);
+    membEst.update(positions, radii, membrane);
+    ASSERT_NEAR(1.0, membEst.direction()[XX], eps);
+
+    // fixed direction is retained:
+    ChannelAxisEstimator fixedEst(gmx::RVec(0.0, 0.0, 2.0), false, 1.0);
+    fixedEst.update(positions, radii, membrane);
+    ASSERT_NEAR(1.0, fixedEst.direction()[ZZ], eps);
+}
+
+
+/*!
+ * Checks exponential smoothing of the direction and of the probe position
+ * relative to the group centre.
+ */
+TEST_F(ChannelAxisEstimatorTest, ChannelAxisEstimatorSmoothingTest)
+{
+    real eps = 1e-4;
+    gmx::RVec centre(0.0, 0.0, 0.0);
+    gmx::RVec axisA(0.0, 0.0, 1.0);
+    gmx::RVec axisB(0.0, 1.0, 1.0);
+    unitv(axisB, axisB);
+    std::vector<gmx::RVec> membrane;
+
+    ChannelAxisEstimator est(axisA, true, 0.5);
+    std::vector<gmx::RVec> positions = cylinder(
+            centre, axisA, 1.0, 4.0, 17, 12);
+    std::vector<real> radii(positions.size(), 0.15);
+    est.update(positions, radii, membrane);
+    ASSERT_NEAR(1.0, iprod(est.direction(), axisA), eps);
+
+    // direction after second frame is halfway between both axes:
+    positions = cylinder(centre, axisB, 1.0, 4.0, 17, 12);
+    est.update(positions, radii, membrane);
+    gmx::RVec expected;
+    rvec_add(axisA, axisB, expected);
+    unitv(expected, expected);
+    ASSERT_NEAR(1.0, iprod(est.direction(), expected), eps);
+
+    // translated group carries probe position along:
+    ChannelAxisEstimator fixedEst(axisB, false, 0.5);
+    fixedEst.update(positions, radii, membrane);
+    gmx::RVec before = fixedEst.initProbePos();
+    gmx::RVec shift(5.0, -2.0, 1.0);
+    for(auto &pos : positions)
+    {
+        rvec_inc(pos, shift);
+    }
+    fixedEst.update(positions, radii, membrane);
+    gmx::RVec after = fixedEst.initProbePos();
+    ASSERT_NEAR(before[XX] + shift[XX], after[XX], eps);
+    ASSERT_NEAR(before[YY] + shift[YY], after[YY], eps);
+    ASSERT_NEAR(before[ZZ] + shift[ZZ], after[ZZ], eps);
+}
+
+
+
+/*!
+ * Checks that the per-frame estimates written by several processes, each of
+ * which updates its estimator in every frame but only reports its own 
+ * frames, are identical to those of a single process. Also checks that 
+ * updating only in a process's own frames would give a different result.
+ */
+TEST_F(ChannelAxisEstimatorTest, ChannelAxisEstimatorProcessCountTest)
+{
+    // tumbling and drifting cylinder as trajectory:
+    int numFrames = 12;
+    std::vector<std::vector<gmx::RVec>> frames;
+    for(int i = 0; i < numFrames; i++)
+    {
+        gmx::RVec centre(0.1*i, -0.05*i, 0.02*i*i);
+        gmx::RVec axis(0.15*i, 0.1*std::sin(1.0*i), 1.0);
+        frames.push_back(cylinder(centre, axis, 1.0, 4.0, 9, 10));
+    }
+    std::vector<real> radii(frames.front().size(), 0.15);
+    std::vector<gmx::RVec> membrane;
+
+    // per-frame stream of direction and probe position merged over processes:
+    auto stream = [&](int numProcesses, bool updateAllFrames)
+    {
+        std::vector<std::vector<real>> merged(numFrames);
+        for(int rank = 0; rank < numProcesses; rank++)
+        {
+            ChannelAxisEstimator est(gmx::RVec(0.0, 0.0, 1.0), true, 0.3);
+            for(int i = 0; i < numFrames; i++)
+            {
+                bool isOwnFrame = (i % numProcesses == rank);
+                if( !isOwnFrame && !updateAllFrames )
+                {
+                    continue;
+                }
+                est.update(frames[i], radii, membrane);
+                if( isOwnFrame )
+                {
+                    gmx::RVec dir = est.direction();
+                    gmx::RVec ipp = est.initProbePos();
+                    merged[i] = {dir[XX], dir[YY], dir[ZZ], 
+                                 ipp[XX], ipp[YY], ipp[ZZ]};
+                }
+            }
+        }
+        return merged;
+    };
+
+    // serial and parallel stream agree exactly:
+    std::vector<std::vector<real>> serial = stream(1, true);
+    std::vector<std::vector<real>> parallel = stream(3, true);
+    for(int i = 0; i < numFrames; i++)
+    {
+        ASSERT_EQ(serial[i].size(), parallel[i].size());
+        for(size_t j = 0; j < serial[i].size(); j++)
+        {
+            ASSERT_EQ(serial[i][j], parallel[i][j]);
+        }
+    }
+
+    // smoothing over own frames only depends on number of processes:
+    std::vector<std::vector<real>> ownOnly = stream(3, false);
+    real maxDev = 0.0;
+    for(int i = 0; i < numFrames; i++)
+    {
+        for(size_t j = 0; j < serial[i].size(); j++)
+        {
+            maxDev = std::max(maxDev, std::fabs(serial[i][j] - ownOnly[i][j]));
+        }
+    }
+    ASSERT_GT(maxDev, 1e-3);
+}
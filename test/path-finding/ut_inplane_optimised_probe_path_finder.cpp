@@ -23,6 +23,7 @@
 
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <fstream>
 
@@ -606,3 +607,496 @@ TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderZDirT
     }
 }
 
+
+
+/*!
+ * \brief Tests early termination of the in-plane optimisation once the probe
+ * has left the hull of the pore forming particles.
+ *
+ * A pore aligned with the \f$ z \f$-axis is created as in the previous tests
+ * and its particles are used to define the hull. The test asserts that the 
+ * pore internal points still lie on the centre line, that all points beyond
+ * the hull margin lie on a straight line along the channel direction (i.e. 
+ * have not been optimised), and that the endpoint radii are still set to the
+ * maximum probe radius.
+ */
+TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderHullTest)
+{
+    // set up periodic boundary conditions:
+    t_pbc pbc;
+    set_pbc(&pbc, 1, boxMat_);
+ 
+    // set parameters to defaults:
+    std::map<std::string, real> params = params_;
+
+    // define pore parameters:
+    real poreLength = 2.0;
+    real poreCentreRadius = 0.25;
+    real poreVdwRadius = 0.2;
+    real hullMargin = 0.1;
+    gmx::RVec poreCentre(0.0, 0.0, 0.0);
+    int poreDir = ZZ;
+
+    // create pore pointing in the z-direction:
+    std::vector<gmx::RVec> particleCentres = makePore(poreLength,
+                                                      poreCentreRadius,
+                                                      poreVdwRadius,
+                                                      poreCentre,
+                                                      poreDir);    
+    std::vector<real> vdwRadii;
+    vdwRadii.insert(vdwRadii.begin(), particleCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions nbhPos(particleCentres);   
+
+    // create path finder:
+    gmx::RVec initProbePos(poreCentre[XX] + 0.2*poreCentreRadius, 
+                           poreCentre[YY] - 0.1*poreCentreRadius, 
+                           poreCentre[ZZ]);
+    gmx::RVec chanDirVec(0.0, 0.0, 1.0);
+    InplaneOptimisedProbePathFinder pfm(params,
+                                        initProbePos,
+                                        chanDirVec,
+                                        &pbc,
+                                        nbhPos,
+                                        vdwRadii);
+
+    // set path finder parameters and hull:
+    PathFindingParameters par;
+    par.setProbeStepLength(params["pfProbeStepLength"]);
+    par.setMaxProbeRadius(params["pfProbeMaxRadius"]);
+    par.setMaxProbeSteps(params["pfProbeMaxSteps"]);
+    par.setHullMargin(hullMargin);
+    pfm.setParameters(par);
+    pfm.setHullPoints(particleCentres);
+
+    // find and extract path and path points:
+    pfm.findPath();
+    std::vector<real> radii = pfm.pathRadii();
+    std::vector<gmx::RVec> points = pfm.pathPoints();
+
+    // endpoints have the maximum probe radius:
+    ASSERT_FLOAT_EQ(params["pfProbeMaxRadius"], radii.front());
+    ASSERT_FLOAT_EQ(params["pfProbeMaxRadius"], radii.back());
+
+    // check internal and external points:
+    real clDistTol = 10.0*std::numeric_limits<real>::epsilon();
+    real hullHi = poreCentre[poreDir] + 0.5*poreLength + hullMargin;
+    real hullLo = poreCentre[poreDir] - 0.5*poreLength - hullMargin;
+    int numOutside = 0;
+    for(unsigned int i = 1; i < points.size() - 1; i++)
+    {
+        // internal points lie on the centre line:
+        if( std::fabs(points[i][poreDir]) <= 0.5*poreLength )
+        {
+            ASSERT_NEAR(poreCentre[XX], points[i][XX], clDistTol);
+            ASSERT_NEAR(poreCentre[YY], points[i][YY], clDistTol);
+        }
+
+        // points beyond hull margin are not moved in plane:
+        // (path runs from forward to backward endpoint, so the preceding 
+        // probe position in the forward tail is the next path point)
+        if( points[i][poreDir] > hullHi )
+        {
+            ASSERT_NEAR(points[i + 1][XX], points[i][XX], clDistTol);
+            ASSERT_NEAR(points[i + 1][YY], points[i][YY], clDistTol);
+            numOutside++;
+        }
+        if( points[i][poreDir] < hullLo )
+        {
+            ASSERT_NEAR(points[i - 1][XX], points[i][XX], clDistTol);
+            ASSERT_NEAR(points[i - 1][YY], points[i][YY], clDistTol);
+            numOutside++;
+        }
+    }
+    ASSERT_LT(0, numOutside);
+}
+
+
+/*!
+ * Tests radius calculation along fixed path points. A path found in a narrow
+ * pore is used as the reference path in a wider pore, where the path points 
+ * must remain unchanged and the internal radii must lie between the minimal
+ * and maximal free distance of the wider pore.
+ */
+TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderFixedPathTest)
+{
+    // set up periodic boundary conditions:
+    t_pbc pbc;
+    set_pbc(&pbc, 1, boxMat_);
+ 
+    // set parameters to defaults:
+    std::map<std::string, real> params = params_;
+    PathFindingParameters par;
+    par.setProbeStepLength(params["pfProbeStepLength"]);
+    par.setMaxProbeRadius(params["pfProbeMaxRadius"]);
+    par.setMaxProbeSteps(params["pfProbeMaxSteps"]);
+
+    // define pore parameters:
+    real poreLength = 2.0;
+    real poreVdwRadius = 0.2;
+    gmx::RVec poreCentre(0.0, 0.0, 0.0);
+    gmx::RVec chanDirVec(0.0, 0.0, 1.0);
+    int poreDir = ZZ;
+
+    // find reference path in narrow pore:
+    std::vector<gmx::RVec> narrowCentres = makePore(poreLength,
+                                                    0.25,
+                                                    poreVdwRadius,
+                                                    poreCentre,
+                                                    poreDir);
+    std::vector<real> narrowVdwRadii(narrowCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions narrowPos(narrowCentres);
+    InplaneOptimisedProbePathFinder refPfm(params,
+                                           poreCentre,
+                                           chanDirVec,
+                                           &pbc,
+                                           narrowPos,
+                                           narrowVdwRadii);
+    refPfm.setParameters(par);
+    refPfm.findPath();
+    std::vector<gmx::RVec> refPoints = refPfm.pathPoints();
+
+    // determine radii along reference path in wider pore:
+    real poreCentreRadius = 0.35;
+    std::vector<gmx::RVec> wideCentres = makePore(poreLength,
+                                                  poreCentreRadius,
+                                                  poreVdwRadius,
+                                                  poreCentre,
+                                                  poreDir);
+    std::vector<real> wideVdwRadii(wideCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions widePos(wideCentres);
+    InplaneOptimisedProbePathFinder pfm(params,
+                                        poreCentre,
+                                        chanDirVec,
+                                        &pbc,
+                                        widePos,
+                                        wideVdwRadii);
+    ASSERT_THROW(pfm.findPathRadii(refPoints), std::logic_error);
+    pfm.setParameters(par);
+    pfm.findPathRadii(refPoints);
+    std::vector<real> radii = pfm.pathRadii();
+    std::vector<gmx::RVec> points = pfm.pathPoints();
+
+    // path points are unchanged:
+    ASSERT_EQ(refPoints.size(), points.size());
+    ASSERT_EQ(refPoints.size(), radii.size());
+    for(unsigned int i = 0; i < points.size(); i++)
+    {
+        ASSERT_NEAR(0.0, distance2(refPoints[i], points[i]), 0.0);
+    }
+
+    // internal radii lie between minimal and maximal free distance:
+    real poreMinFreeRadius = poreCentreRadius - poreVdwRadius;
+    real poreMaxFreeRadius = std::sqrt(std::pow(poreVdwRadius/4.0, 2.0) + 
+                             std::pow(poreCentreRadius, 2.0)) - poreVdwRadius;
+    real freeRadTol = 10.0*std::numeric_limits<real>::epsilon();
+    for(unsigned int i = 0; i < radii.size(); i++)
+    {
+        ASSERT_GE(params["pfProbeMaxRadius"], radii[i]);
+        if( std::fabs(points[i][poreDir] - poreCentre[poreDir]) <= 0.5*poreLength )
+        {
+            ASSERT_LE(poreMinFreeRadius - freeRadTol, radii[i]);
+            ASSERT_GE(poreMaxFreeRadius + freeRadTol, radii[i]);
+        }
+    }
+}
+
+
+
+/*!
+ * Tests the prediction of the probe position in the next plane on a curved
+ * centre line. With two path points, the prediction is the linear 
+ * extrapolation, with three and four points it is the exact quadratic 
+ * extrapolation through the last three points, and with five or more points
+ * it is the extrapolation of a least squares quadratic fitted to the last 
+ * five points. All of these are exact on a straight or quadratic centre 
+ * line. The least squares fit is less sensitive to noise in the most recent
+ * point than the exact quadratic extrapolation and older points are ignored.
+ */
+TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderPredictionTest)
+{
+    // set up periodic boundary conditions:
+    t_pbc pbc;
+    set_pbc(&pbc, 1, boxMat_);
+
+    // path finder in arbitrary pore along z-axis:
+    std::map<std::string, real> params = params_;
+    real poreVdwRadius = 0.2;
+    gmx::RVec poreCentre(0.0, 0.0, 0.0);
+    std::vector<gmx::RVec> particleCentres = makePore(2.0,
+                                                      0.5,
+                                                      poreVdwRadius,
+                                                      poreCentre,
+                                                      ZZ);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions porePos(particleCentres);
+    InplaneOptimisedProbePathFinder pfm(params,
+                                        poreCentre,
+                                        gmx::RVec(0.0, 0.0, 1.0),
+                                        &pbc,
+                                        porePos,
+                                        vdwRadii);
+
+    // curved and straight centre lines sampled in planes along z-axis:
+    real h = params["pfProbeStepLength"];
+    auto curved = [](real z)
+    {
+        return gmx::RVec(0.1 + 0.5*z - 3.0*z*z, -0.2 + 0.3*z + 2.0*z*z, z);
+    };
+    auto straight = [](real z)
+    {
+        return gmx::RVec(0.1 + 0.5*z, -0.2 + 0.3*z, z);
+    };
+
+    // predicted position for given number of preceding points:
+    auto predict = [&](std::function<gmx::RVec(real)> centreLine, int numPoints)
+    {
+        pfm.path_.clear();
+        for(int i = 0; i < numPoints; i++)
+        {
+            pfm.path_.push_back(centreLine(i*h));
+        }
+        pfm.crntProbePos_ = gmx::RVec(0.0, 0.0, numPoints*h);
+        return pfm.optimToConfig(pfm.predictInplanePos());
+    };
+
+    real eps = 1e-5;
+
+    // without preceding path there is no prediction:
+    pfm.path_ = std::vector<gmx::RVec>({curved(0.0)});
+    pfm.crntProbePos_ = gmx::RVec(0.0, 0.0, h);
+    std::vector<real> noPred = pfm.predictInplanePos();
+    ASSERT_NEAR(0.0, noPred[0], eps);
+    ASSERT_NEAR(0.0, noPred[1], eps);
+
+    // linear extrapolation from two points:
+    gmx::RVec pred = predict(straight, 2);
+    for(int d = 0; d < DIM; d++)
+    {
+        ASSERT_NEAR(straight(2*h)[d], pred[d], eps);
+    }
+    pred = predict(curved, 2);
+    for(int d = 0; d < DIM; d++)
+    {
+        ASSERT_NEAR(2.0*curved(h)[d] - curved(0.0)[d], pred[d], eps);
+    }
+
+    // exact quadratic and least squares extrapolation:
+    for(int numPoints : {3, 4, 5, 7})
+    {
+        pred = predict(curved, numPoints);
+        for(int d = 0; d < DIM; d++)
+        {
+            ASSERT_NEAR(curved(numPoints*h)[d], pred[d], eps);
+        }
+    }
+
+    // least squares fit reduces effect of noise in most recent point:
+    real noise = 0.01;
+    predict(curved, 3);
+    pfm.path_.back()[XX] += noise;
+    real errExact = std::fabs(
+            pfm.optimToConfig(pfm.predictInplanePos())[XX] - curved(3*h)[XX]);
+    predict(curved, 5);
+    pfm.path_.back()[XX] += noise;
+    real errLeastSquares = std::fabs(
+            pfm.optimToConfig(pfm.predictInplanePos())[XX] - curved(5*h)[XX]);
+    ASSERT_NEAR(3.0*noise, errExact, eps);
+    ASSERT_LT(errLeastSquares, errExact);
+
+    // points beyond the most recent five are ignored:
+    predict(curved, 7);
+    pfm.path_.front()[XX] += 1.0;
+    pfm.path_.at(1)[YY] -= 1.0;
+    pred = pfm.optimToConfig(pfm.predictInplanePos());
+    for(int d = 0; d < DIM; d++)
+    {
+        ASSERT_NEAR(curved(7*h)[d], pred[d], eps);
+    }
+}
+
+
+/*!
+ * Tests the predictor-corrector optimisation in a single plane of a 
+ * cylindrical pore. If the prediction is close to the centre line, the short
+ * optimisation from the prediction lands within the predictor tolerance and
+ * its result is accepted. If the prediction is far off, the short 
+ * optimisation lands further than the tolerance from the prediction and the 
+ * full optimisation from the straight advance is used instead. With a 
+ * negative tolerance, the full optimisation is always used.
+ */
+TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderCorrectorTest)
+{
+    // set up periodic boundary conditions:
+    t_pbc pbc;
+    set_pbc(&pbc, 1, boxMat_);
+
+    // cylindrical pore along z-axis:
+    std::map<std::string, real> params = params_;
+    real poreVdwRadius = 0.2;
+    gmx::RVec poreCentre(0.0, 0.0, 0.0);
+    std::vector<gmx::RVec> particleCentres = makePore(2.0,
+                                                      0.5,
+                                                      poreVdwRadius,
+                                                      poreCentre,
+                                                      ZZ);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions porePos(particleCentres);
+
+    // path finder with predictor:
+    real predTol = 0.1;
+    PathFindingParameters par;
+    par.setProbeStepLength(params["pfProbeStepLength"]);
+    par.setMaxProbeRadius(params["pfProbeMaxRadius"]);
+    par.setMaxProbeSteps(params["pfProbeMaxSteps"]);
+    par.setPredictorTolerance(predTol);
+    InplaneOptimisedProbePathFinder pfm(params,
+                                        poreCentre,
+                                        gmx::RVec(0.0, 0.0, 1.0),
+                                        &pbc,
+                                        porePos,
+                                        vdwRadii);
+    pfm.setParameters(par);
+    pfm.prepareNeighborhoodSearch(&pbc, porePos, pfm.nbhCutoff_);
+    ObjectiveFunction objFun = std::bind(
+            &InplaneOptimisedProbePathFinder::findMinimalFreeDistance, 
+            &pfm, 
+            std::placeholders::_1);
+
+    // probe in central plane with straight preceding path at given offset:
+    real h = params["pfProbeStepLength"];
+    auto setPath = [&](InplaneOptimisedProbePathFinder &finder, real offset)
+    {
+        finder.path_ = std::vector<gmx::RVec>({
+                gmx::RVec(offset, 0.0, -2.0*h), 
+                gmx::RVec(offset, 0.0, -h)});
+        finder.crntProbePos_ = poreCentre;
+    };
+    auto dist = [](std::vector<real> a, std::vector<real> b)
+    {
+        return std::sqrt((a[0] - b[0])*(a[0] - b[0]) + 
+                         (a[1] - b[1])*(a[1] - b[1]));
+    };
+
+    // optimisation from straight advance:
+    std::vector<real> initState = {0.0, 0.0};
+    OptimSpacePoint fullPoint = pfm.optimiseInPlane(objFun, initState, false);
+
+    // accurate prediction is accepted:
+    setPath(pfm, 0.02);
+    std::vector<real> predState = pfm.predictInplanePos();
+    OptimSpacePoint shortPoint = pfm.optimiseInPlane(objFun, predState, true);
+    ASSERT_GE(predTol, dist(shortPoint.first, predState));
+    OptimSpacePoint optimPoint = pfm.predictAndOptimise(objFun);
+    ASSERT_EQ(shortPoint.first, optimPoint.first);
+    ASSERT_EQ(shortPoint.second, optimPoint.second);
+
+    // inaccurate prediction falls back to full optimisation:
+    setPath(pfm, 0.25);
+    predState = pfm.predictInplanePos();
+    shortPoint = pfm.optimiseInPlane(objFun, predState, true);
+    ASSERT_LT(predTol, dist(shortPoint.first, predState));
+    optimPoint = pfm.predictAndOptimise(objFun);
+    ASSERT_EQ(fullPoint.first, optimPoint.first);
+    ASSERT_EQ(fullPoint.second, optimPoint.second);
+
+    // both results lie on centre line:
+    real clDistTol = 1e-3;
+    ASSERT_NEAR(0.0, dist(fullPoint.first, initState), clDistTol);
+    setPath(pfm, 0.02);
+    ASSERT_NEAR(0.0, dist(pfm.predictAndOptimise(objFun).first, initState), 
+                clDistTol);
+
+    // negative tolerance always uses full optimisation:
+    par.setPredictorTolerance(-predTol);
+    InplaneOptimisedProbePathFinder noPredPfm(params,
+                                              poreCentre,
+                                              gmx::RVec(0.0, 0.0, 1.0),
+                                              &pbc,
+                                              porePos,
+                                              vdwRadii);
+    noPredPfm.setParameters(par);
+    noPredPfm.prepareNeighborhoodSearch(&pbc, porePos, noPredPfm.nbhCutoff_);
+    ObjectiveFunction noPredObjFun = std::bind(
+            &InplaneOptimisedProbePathFinder::findMinimalFreeDistance, 
+            &noPredPfm, 
+            std::placeholders::_1);
+    setPath(noPredPfm, 0.02);
+    optimPoint = noPredPfm.predictAndOptimise(noPredObjFun);
+    ASSERT_EQ(fullPoint.first, optimPoint.first);
+    ASSERT_EQ(fullPoint.second, optimPoint.second);
+}
+
+
+/*!
+ * Tests that a negative predictor tolerance reproduces the path found without
+ * prediction exactly and that the path found with prediction agrees with it
+ * to within the predictor tolerance.
+ */
+TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderPredictorToleranceTest)
+{
+    // set up periodic boundary conditions:
+    t_pbc pbc;
+    set_pbc(&pbc, 1, boxMat_);
+
+    // cylindrical pore along z-axis:
+    std::map<std::string, real> params = params_;
+    real poreVdwRadius = 0.2;
+    gmx::RVec poreCentre(0.0, 0.0, 0.0);
+    std::vector<gmx::RVec> particleCentres = makePore(2.0,
+                                                      0.4,
+                                                      poreVdwRadius,
+                                                      poreCentre,
+                                                      ZZ);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions porePos(particleCentres);
+    gmx::RVec initProbePos(0.05, -0.03, 0.1);
+    gmx::RVec chanDirVec(0.1, 0.0, 1.0);
+
+    // path for given predictor tolerance (unset if NaN):
+    auto findPath = [&](real predTol)
+    {
+        PathFindingParameters par;
+        par.setProbeStepLength(params["pfProbeStepLength"]);
+        par.setMaxProbeRadius(params["pfProbeMaxRadius"]);
+        par.setMaxProbeSteps(params["pfProbeMaxSteps"]);
+        if( !std::isnan(predTol) )
+        {
+            par.setPredictorTolerance(predTol);
+        }
+        InplaneOptimisedProbePathFinder pfm(params,
+                                            initProbePos,
+                                            chanDirVec,
+                                            &pbc,
+                                            porePos,
+                                            vdwRadii);
+        pfm.setParameters(par);
+        pfm.findPath();
+        return std::make_pair(pfm.pathPoints(), pfm.pathRadii());
+    };
+
+    // negative tolerance reproduces path without prediction:
+    auto oldPath = findPath(std::nan(""));
+    auto negPath = findPath(-0.1);
+    ASSERT_EQ(oldPath.first.size(), negPath.first.size());
+    for(size_t i = 0; i < oldPath.first.size(); i++)
+    {
+        ASSERT_EQ(oldPath.second[i], negPath.second[i]);
+        for(int d = 0; d < DIM; d++)
+        {
+            ASSERT_EQ(oldPath.first[i][d], negPath.first[i][d]);
+        }
+    }
+
+    // path with prediction agrees inside pore:
+    real predTol = 0.1;
+    auto predPath = findPath(predTol);
+    ASSERT_EQ(oldPath.first.size(), predPath.first.size());
+    for(size_t i = 0; i < oldPath.first.size(); i++)
+    {
+        if( std::fabs(oldPath.first[i][ZZ]) < 1.0 )
+        {
+            ASSERT_GE(predTol, 
+                      std::sqrt(distance2(oldPath.first[i], predPath.first[i])));
+        }
+    }
+}
@@ -476,3 +476,56 @@ TEST_F(MolecularPathTest, MolecularPathVolumeTest)
                 std::sqrt(eps));                
 }
 
+
+/*!
+ * Tests that updating the radii of a MolecularPath leaves its centre line 
+ * unchanged and yields the same radius profile as constructing a new path 
+ * from the same points and radii, also after the path has been shifted.
+ */
+TEST_F(MolecularPathTest, MolecularPathSetRadiiTest)
+{
+    // get machine epsilon:
+    real eps = std::numeric_limits<real>::epsilon();
+
+    // cylinder and hourglass with the same centre line:
+    gmx::RVec dir(0.0, 0.0, 1.0);
+    gmx::RVec centre(1.0, -1.0, 0.5);
+    real length = 2.0;
+    int numPoints = 21;
+    MolecularPath mpCylindrical = makeCylindricalPath(
+            dir, centre, length, 1.0, numPoints);
+    MolecularPath mpHourglass = makeHourglassPath(
+            dir, centre, length, 0.2, numPoints);
+
+    // number of radii must match number of points:
+    std::vector<real> tooFew(numPoints - 1, 1.0);
+    ASSERT_THROW(mpCylindrical.setPathRadii(tooFew), std::logic_error);
+
+    // shift both paths by same amount:
+    gmx::RVec shift(0.3, 0.0, 0.0);
+    mpCylindrical.shift(shift);
+    mpHourglass.shift(shift);
+
+    // give the cylinder the hourglass radii:
+    std::vector<gmx::RVec> centreLineBefore = mpCylindrical.samplePoints(10, 0.0);
+    mpCylindrical.setPathRadii(mpHourglass.pathRadii());
+    std::vector<gmx::RVec> centreLineAfter = mpCylindrical.samplePoints(10, 0.0);
+
+    // centre line is unchanged:
+    for(size_t i = 0; i < centreLineBefore.size(); i++)
+    {
+        ASSERT_NEAR(0.0, distance2(centreLineBefore[i], centreLineAfter[i]), eps);
+    }
+
+    // radius profile matches that of the hourglass:
+    ASSERT_NEAR(mpHourglass.minRadius().second, 
+                mpCylindrical.minRadius().second, 
+                std::sqrt(eps));
+    std::vector<real> radCylindrical = mpCylindrical.sampleRadii(50, 0.0);
+    std::vector<real> radHourglass = mpHourglass.sampleRadii(50, 0.0);
+    for(size_t i = 0; i < radCylindrical.size(); i++)
+    {
+        ASSERT_NEAR(radHourglass[i], radCylindrical[i], std::sqrt(eps));
+    }
+}
+
@@ -0,0 +1,189 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gromacs/math/vec.h>
+
+#include "path-finding/pore_residue_mapper.hpp"
+
+
+/*!
+ * \brief Test fixture for PoreResidueMapper.
+ *
+ * Provides a straight cylindrical pathway of radius 0.5 along the z-axis, a
+ * linear density profile, and three residues: a pore-facing one, a 
+ * pore-lining one whose C-alpha is closer to the centre line than its COG,
+ * and one outside the pore.
+ */
+class PoreResidueMapperTest : public ::testing::Test
+{
+    public:
+
+        PoreResidueMapperTest()
+        {
+            // straight pathway along z-axis:
+            std::vector<gmx::RVec> pathPoints;
+            std::vector<real> pathRadii;
+            for(int i = 0; i < 21; i++)
+            {
+                pathPoints.push_back(gmx::RVec(0.0, 0.0, -2.0 + 0.2*i));
+                pathRadii.push_back(0.5);
+            }
+            molPath_.reset(new MolecularPath(pathPoints, pathRadii));
+
+            // linear density profile:
+            density_ = SplineCurve1D(
+                    1, 
+                    std::vector<real>({-10.0, -10.0, 10.0, 10.0}),
+                    std::vector<real>({0.0, 20.0}));
+
+            // residue atoms (two per residue) and C-alphas:
+            cogAtoms_ = {gmx::RVec(0.2, 0.0, 0.0), gmx::RVec(0.4, 0.0, 0.0),
+                         gmx::RVec(0.0, 0.2, 1.0), gmx::RVec(0.0, 0.4, 1.0),
+                         gmx::RVec(1.0, 0.0, -1.0), gmx::RVec(1.2, 0.0, -1.0)};
+            cogOffsets_ = {0, 2, 4, 6};
+            calAtoms_ = {gmx::RVec(0.6, 0.0, 0.0),
+                         gmx::RVec(0.0, 0.1, 1.0),
+                         gmx::RVec(1.5, 0.0, -1.0)};
+            calOffsets_ = {0, 1, 2, 3};
+        }
+
+    protected:
+
+        std::unique_ptr<MolecularPath> molPath_;
+        SplineCurve1D density_;
+        std::vector<gmx::RVec> cogAtoms_;
+        std::vector<size_t> cogOffsets_;
+        std::vector<gmx::RVec> calAtoms_;
+        std::vector<size_t> calOffsets_;
+};
+
+
+/*!
+ * Checks that inconsistent offsets are rejected.
+ */
+TEST_F(PoreResidueMapperTest, PoreResidueMapperExceptionTest)
+{
+    PoreResidueMapper prm(0.1);
+    std::vector<size_t> badOffsets = {0, 2, 4};
+    ASSERT_THROW(
+            prm(cogAtoms_, badOffsets, calAtoms_, calOffsets_, *molPath_, 
+                density_, nullptr), 
+            std::logic_error);
+    ASSERT_THROW(
+            prm(cogAtoms_, cogOffsets_, calAtoms_, badOffsets, *molPath_, 
+                density_, nullptr), 
+            std::logic_error);
+}
+
+
+/*!
+ * Checks the fused mapping against separate mapping of each position and 
+ * evaluation of radius and density.
+ */
+TEST_F(PoreResidueMapperTest, PoreResidueMapperMappingTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    PoreResidueMapper prm(0.1);
+    std::vector<MappedResidue> res = prm(
+            cogAtoms_, 
+            cogOffsets_, 
+            calAtoms_, 
+            calOffsets_, 
+            *molPath_, 
+            density_, 
+            nullptr);
+    ASSERT_EQ(3, res.size());
+
+    // classification of residues:
+    ASSERT_TRUE(res[0].poreLining_);
+    ASSERT_TRUE(res[0].poreFacing_);
+    ASSERT_TRUE(res[1].poreLining_);
+    ASSERT_FALSE(res[1].poreFacing_);
+    ASSERT_FALSE(res[2].poreLining_);
+    ASSERT_FALSE(res[2].poreFacing_);
+
+    for(size_t i = 0; i < res.size(); i++)
+    {
+        // centre of geometry is midpoint of atoms:
+        for(int j = 0; j < DIM; j++)
+        {
+            ASSERT_NEAR(
+                    0.5*(cogAtoms_[2*i][j] + cogAtoms_[2*i + 1][j]),
+                    res[i].cog_[j],
+                    eps);
+        }
+
+        // mapped coordinates agree with direct mapping:
+        gmx::RVec cog = molPath_ -> mapPosition(res[i].cog_);
+        gmx::RVec cal = molPath_ -> mapPosition(calAtoms_[i]);
+        ASSERT_NEAR(cog[SS], res[i].mappedCog_[SS], eps);
+        ASSERT_NEAR(cog[RR], res[i].mappedCog_[RR], eps);
+        ASSERT_NEAR(cal[SS], res[i].mappedCal_[SS], eps);
+        ASSERT_NEAR(cal[RR], res[i].mappedCal_[RR], eps);
+
+        // properties evaluated at mapped position:
+        ASSERT_NEAR(0.5, res[i].poreRadius_, eps);
+        ASSERT_NEAR(
+                density_.evaluate(cog[SS], 0), 
+                res[i].solventDensity_, 
+                eps);
+    }
+}
+
+
+/*!
+ * Checks that no residue is pore-facing without C-alpha positions.
+ */
+TEST_F(PoreResidueMapperTest, PoreResidueMapperNoCalphaTest)
+{
+    PoreResidueMapper prm(0.1);
+    std::vector<MappedResidue> res = prm(
+            cogAtoms_, 
+            cogOffsets_, 
+            std::vector<gmx::RVec>(), 
+            std::vector<size_t>(), 
+            *molPath_, 
+            density_, 
+            nullptr);
+    ASSERT_EQ(3, res.size());
+    ASSERT_TRUE(res[0].poreLining_);
+    ASSERT_TRUE(res[1].poreLining_);
+    ASSERT_FALSE(res[2].poreLining_);
+    for(auto r : res)
+    {
+        ASSERT_FALSE(r.poreFacing_);
+    }
+}
+
@@ -0,0 +1,185 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "path-finding/radius_profile_registration.hpp"
+
+
+/*!
+ * \brief Test fixture for RadiusProfileRegistration.
+ *
+ * Provides a radius profile with an off-centre Gaussian constriction.
+ */
+class RadiusProfileRegistrationTest : public ::testing::Test
+{
+    public:
+
+        // profile sampled on [sLo, sHi] with constriction at sCon:
+        std::vector<real> profile(
+                real sLo, 
+                real sHi, 
+                real sCon, 
+                real resolution)
+        {
+            std::vector<real> radii;
+            for(real s = sLo; s <= sHi + 1e-6; s += resolution)
+            {
+                real x = (s - sCon)/0.3;
+                real y = (s - sCon - 1.0)/0.5;
+                radii.push_back(
+                        0.8 - 0.6*std::exp(-x*x) - 0.2*std::exp(-y*y));
+            }
+            return radii;
+        }
+};
+
+
+/*!
+ * Checks that invalid resolutions are rejected and that the shift is zero 
+ * as long as there is no reference.
+ */
+TEST_F(RadiusProfileRegistrationTest, RadiusProfileRegistrationExceptionTest)
+{
+    ASSERT_THROW(RadiusProfileRegistration(0.0), std::logic_error);
+    ASSERT_THROW(RadiusProfileRegistration(-0.1), std::logic_error);
+
+    RadiusProfileRegistration reg(0.1);
+    ASSERT_FALSE(reg.hasReference());
+    ASSERT_NEAR(0.0, reg(profile(-2.0, 2.0, 0.0, 0.1), -2.0), 1e-6);
+}
+
+
+/*!
+ * Checks that the shift of a constriction is recovered for profiles with 
+ * different support, including shifts that are not a multiple of the grid 
+ * spacing.
+ */
+TEST_F(RadiusProfileRegistrationTest, RadiusProfileRegistrationShiftTest)
+{
+    real h = 0.05;
+    RadiusProfileRegistration reg(h);
+    reg.update(profile(-3.0, 3.0, 0.0, h), -3.0);
+    ASSERT_TRUE(reg.hasReference());
+
+    // integer shift on different support:
+    real shift = reg(profile(-2.0, 3.5, 0.5, h), -2.0);
+    ASSERT_NEAR(0.5, shift, 0.25*h);
+
+    // shift below grid spacing:
+    shift = reg(profile(-3.02, 2.48, -0.72, h), -3.02);
+    ASSERT_NEAR(-0.72, shift, 0.25*h);
+}
+
+
+/*!
+ * Checks that aligned profiles are averaged into the reference on its own 
+ * grid.
+ */
+TEST_F(RadiusProfileRegistrationTest, RadiusProfileRegistrationUpdateTest)
+{
+    real h = 0.1;
+    RadiusProfileRegistration reg(h);
+    reg.update(std::vector<real>({1.0, 1.0, 1.0, 1.0}), 0.0);
+
+    // partially overlapping profile between grid points:
+    reg.update(std::vector<real>({3.0, 5.0, 7.0}), 0.15);
+    std::vector<real> ref = reg.reference();
+    ASSERT_EQ(4, ref.size());
+    ASSERT_NEAR(1.0, ref[0], 1e-6);
+    ASSERT_NEAR(1.0, ref[1], 1e-6);
+    ASSERT_NEAR(0.5*(1.0 + 4.0), ref[2], 1e-5);
+    ASSERT_NEAR(0.5*(1.0 + 6.0), ref[3], 1e-5);
+}
+
+
+
+/*!
+ * Checks that the per-frame shifts reported by several processes, each of 
+ * which registers every frame against its running reference but only reports
+ * its own frames, are identical to those of a single process. Also checks 
+ * that registering only a process's own frames would give different shifts.
+ */
+TEST_F(RadiusProfileRegistrationTest, RadiusProfileRegistrationProcessCountTest)
+{
+    // constriction wanders along pathway with varying support:
+    real h = 0.1;
+    int numFrames = 10;
+    std::vector<std::vector<real>> frames;
+    std::vector<real> frameLo;
+    for(int i = 0; i < numFrames; i++)
+    {
+        real sLo = -2.0 - 0.1*(i % 3);
+        real sCon = 0.37*std::sin(1.3*i) + 0.04*i;
+        frames.push_back(profile(sLo, 2.0 + 0.1*(i % 2), sCon, h));
+        frameLo.push_back(sLo);
+    }
+
+    // per-frame stream of shifts merged over processes:
+    auto stream = [&](int numProcesses, bool registerAllFrames)
+    {
+        std::vector<real> merged(numFrames);
+        for(int rank = 0; rank < numProcesses; rank++)
+        {
+            RadiusProfileRegistration reg(h);
+            for(int i = 0; i < numFrames; i++)
+            {
+                bool isOwnFrame = (i % numProcesses == rank);
+                if( !isOwnFrame && !registerAllFrames )
+                {
+                    continue;
+                }
+                real shift = reg(frames[i], frameLo[i]);
+                reg.update(frames[i], frameLo[i] - shift);
+                if( isOwnFrame )
+                {
+                    merged[i] = shift;
+                }
+            }
+        }
+        return merged;
+    };
+
+    // serial and parallel shifts agree exactly:
+    std::vector<real> serial = stream(1, true);
+    std::vector<real> parallel = stream(2, true);
+    for(int i = 0; i < numFrames; i++)
+    {
+        ASSERT_EQ(serial[i], parallel[i]);
+    }
+
+    // registering own frames only depends on number of processes:
+    std::vector<real> ownOnly = stream(2, false);
+    real maxDev = 0.0;
+    for(int i = 0; i < numFrames; i++)
+    {
+        maxDev = std::max(maxDev, std::fabs(serial[i] - ownOnly[i]));
+    }
+    ASSERT_GT(maxDev, 0.5*h);
+}
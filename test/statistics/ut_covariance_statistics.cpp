@@ -0,0 +1,249 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "statistics/covariance_statistics.hpp"
+
+
+/*!
+ * \brief Test fixture for CovarianceStatistics.
+ *
+ * Initialises a simple hard-coded bivariate data set used in all tests.
+ */
+class CovarianceStatisticsTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        CovarianceStatisticsTest()
+        {
+            dataX_ = {0.3, 1.5, -0.9, 1.4, -5.1, 2.2};
+            dataY_ = {1.1, 2.0, -0.3, 0.8, -4.0, 3.5};
+        }
+
+    protected:
+
+        // test data:
+        std::vector<real> dataX_;
+        std::vector<real> dataY_;
+};
+
+
+/*!
+ * Checks that covariance and correlation agree with values computed directly
+ * from the entire data set.
+ */
+TEST_F(CovarianceStatisticsTest, CovarianceStatisticsCorrTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = 10.0*std::numeric_limits<real>::epsilon();
+
+    // accumulate statistics:
+    CovarianceStatistics cs;
+    for(size_t i = 0; i < dataX_.size(); i++)
+    {
+        cs.update(dataX_[i], dataY_[i]);
+    }
+
+    // reference values computed directly:
+    double n = dataX_.size();
+    double mx = 0.0;
+    double my = 0.0;
+    for(size_t i = 0; i < dataX_.size(); i++)
+    {
+        mx += dataX_[i]/n;
+        my += dataY_[i]/n;
+    }
+    double sxx = 0.0;
+    double syy = 0.0;
+    double sxy = 0.0;
+    for(size_t i = 0; i < dataX_.size(); i++)
+    {
+        sxx += (dataX_[i] - mx)*(dataX_[i] - mx);
+        syy += (dataY_[i] - my)*(dataY_[i] - my);
+        sxy += (dataX_[i] - mx)*(dataY_[i] - my);
+    }
+
+    // assert correctness:
+    ASSERT_EQ(static_cast<int>(dataX_.size()), cs.num());
+    ASSERT_NEAR(mx, cs.meanX(), eps);
+    ASSERT_NEAR(my, cs.meanY(), eps);
+    ASSERT_NEAR(sxy/(n - 1.0), cs.cov(), eps);
+    ASSERT_NEAR(sxy/std::sqrt(sxx*syy), cs.corr(), eps);
+
+    // perfectly (anti-)correlated data:
+    CovarianceStatistics pos;
+    CovarianceStatistics neg;
+    for(auto x : dataX_)
+    {
+        pos.update(x, 2.0*x + 1.0);
+        neg.update(x, -0.5*x);
+    }
+    ASSERT_NEAR(1.0, pos.corr(), eps);
+    ASSERT_NEAR(-1.0, neg.corr(), eps);
+}
+
+
+/*!
+ * Checks the degenerate cases of too few samples, constant data, and 
+ * infinite values.
+ */
+TEST_F(CovarianceStatisticsTest, CovarianceStatisticsDegenerateTest)
+{
+    // no data and a single sample:
+    CovarianceStatistics cs;
+    ASSERT_EQ(0, cs.num());
+    ASSERT_EQ(0.0, cs.corr());
+    cs.update(1.0, 2.0);
+    ASSERT_EQ(0.0, cs.cov());
+    ASSERT_EQ(0.0, cs.corr());
+
+    // constant second variable:
+    cs.update(2.0, 2.0);
+    cs.update(3.0, 2.0);
+    ASSERT_EQ(0.0, cs.corr());
+
+    // infinities are skipped:
+    cs.update(std::numeric_limits<real>::infinity(), 1.0);
+    ASSERT_EQ(3, cs.num());
+}
+
+
+/*!
+ * Checks that merging statistics accumulated over disjoint parts of the data 
+ * set yields the same result as accumulating over the entire data set.
+ */
+TEST_F(CovarianceStatisticsTest, CovarianceStatisticsMergeTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = 10.0*std::numeric_limits<real>::epsilon();
+
+    // accumulate over entire data set and over two parts:
+    CovarianceStatistics full;
+    CovarianceStatistics lo;
+    CovarianceStatistics hi;
+    for(size_t i = 0; i < dataX_.size(); i++)
+    {
+        full.update(dataX_[i], dataY_[i]);
+        if( i < 2 )
+        {
+            lo.update(dataX_[i], dataY_[i]);
+        }
+        else
+        {
+            hi.update(dataX_[i], dataY_[i]);
+        }
+    }
+
+    // merge, including an empty set of statistics:
+    CovarianceStatistics merged;
+    merged.merge(lo);
+    merged.merge(CovarianceStatistics());
+    merged.merge(hi);
+
+    // assert correctness:
+    ASSERT_EQ(full.num(), merged.num());
+    ASSERT_NEAR(full.meanX(), merged.meanX(), eps);
+    ASSERT_NEAR(full.meanY(), merged.meanY(), eps);
+    ASSERT_NEAR(full.cov(), merged.cov(), eps);
+    ASSERT_NEAR(full.corr(), merged.corr(), eps);
+}
+
+
+
+/*!
+ * Checks that updating multiple statistics only considers included elements,
+ * as used to restrict residue correlations to frames in which a residue is
+ * pore-lining.
+ */
+TEST_F(CovarianceStatisticsTest, CovarianceStatisticsUpdateMultipleTest)
+{
+    // floating point tolerance:
+    real eps = std::numeric_limits<real>::epsilon();
+
+    // first element always included, second every other frame, third never:
+    std::vector<CovarianceStatistics> stat(3);
+    CovarianceStatistics everyOther;
+    for(size_t i = 0; i < dataX_.size(); i++)
+    {
+        std::vector<real> x = {dataX_[i], dataX_[i], dataX_[i]};
+        std::vector<bool> include = {true, i % 2 == 0, false};
+        CovarianceStatistics::updateMultiple(stat, x, dataY_[i], include);
+        if( i % 2 == 0 )
+        {
+            everyOther.update(dataX_[i], dataY_[i]);
+        }
+    }
+
+    // assert correctness:
+    ASSERT_EQ(dataX_.size(), stat[0].num());
+    ASSERT_EQ(everyOther.num(), stat[1].num());
+    ASSERT_NEAR(everyOther.corr(), stat[1].corr(), eps);
+    ASSERT_EQ(0, stat[2].num());
+
+    // vectors of different size are rejected:
+    std::vector<real> x = {0.0, 1.0};
+    std::vector<bool> include = {true, true, true};
+    ASSERT_THROW(
+            CovarianceStatistics::updateMultiple(stat, x, 0.0, include), 
+            std::logic_error);
+}
+
+
+/*!
+ * Checks that statistics are ranked by absolute correlation and that 
+ * statistics with fewer than two samples are left unranked.
+ */
+TEST_F(CovarianceStatisticsTest, CovarianceStatisticsRankTest)
+{
+    // weak, no, strong negative, single sample, and strong positive correlation:
+    std::vector<CovarianceStatistics> stat(5);
+    std::vector<real> x = {0.0, 1.0, 2.0, 3.0};
+    std::vector<real> weak = {0.0, 1.0, -1.0, 1.0};
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        stat[0].update(x[i], weak[i]);
+        stat[2].update(x[i], -2.0*x[i]);
+        stat[4].update(x[i], x[i] + 0.1*weak[i]);
+    }
+    stat[3].update(1.0, 1.0);
+
+    // rank:
+    std::vector<int> rank = CovarianceStatistics::rankByCorrelation(stat);
+
+    // assert correct ranking:
+    ASSERT_EQ(stat.size(), rank.size());
+    ASSERT_EQ(1, rank[2]);
+    ASSERT_EQ(2, rank[4]);
+    ASSERT_EQ(3, rank[0]);
+    ASSERT_EQ(0, rank[1]);
+    ASSERT_EQ(0, rank[3]);
+}
+
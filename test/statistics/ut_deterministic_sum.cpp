@@ -0,0 +1,122 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "statistics/deterministic_sum.hpp"
+
+
+/*!
+ * \brief Test fixture for DeterministicSum.
+ */
+class DeterministicSumTest : public ::testing::Test
+{
+
+};
+
+
+/*!
+ * Checks that pairwise summation of a range of values agrees with a sum
+ * computed in extended precision and handles empty and short inputs.
+ */
+TEST_F(DeterministicSumTest, DeterministicSumAccuracyTest)
+{
+    // trivial cases:
+    ASSERT_EQ(0.0, DeterministicSum::pairwise(std::vector<real>()));
+    ASSERT_EQ(2.5, DeterministicSum::pairwise(std::vector<real>({2.5})));
+
+    // random values covering several orders of magnitude:
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<real> dist(-3.0, 3.0);
+    std::vector<real> values(100000);
+    long double exact = 0.0;
+    for(auto &v : values)
+    {
+        v = std::pow(10.0, dist(rng));
+        exact += v;
+    }
+
+    real sum = DeterministicSum::pairwise(values);
+    ASSERT_NEAR(1.0, sum/exact, 1e-6);
+}
+
+
+/*!
+ * Checks that the sum equals the combination of unrounded partial sums over 
+ * the subtrees of the reduction tree, i.e. that the reduction tree depends 
+ * only on the number of summands, so that a parallel evaluation of subtrees
+ * yields a bitwise identical result.
+ */
+TEST_F(DeterministicSumTest, DeterministicSumTreeShapeTest)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<real> dist(-1.0, 1.0);
+
+    for(size_t n : {33, 100, 1000, 4097})
+    {
+        std::vector<real> values(n);
+        for(auto &v : values)
+        {
+            v = dist(rng);
+        }
+
+        // sum over whole range:
+        real sum = DeterministicSum::pairwise(values);
+        double sumDouble = DeterministicSum::pairwiseDouble(values);
+        ASSERT_EQ(sum, static_cast<real>(sumDouble));
+
+        // sums over halves combined at the root:
+        size_t half = n/2;
+        std::vector<real> lo(values.begin(), values.begin() + half);
+        std::vector<real> hi(values.begin() + half, values.end());
+        double combined = DeterministicSum::pairwiseDouble(lo) + 
+                          DeterministicSum::pairwiseDouble(hi);
+        ASSERT_EQ(sumDouble, combined);
+        ASSERT_EQ(sum, static_cast<real>(combined));
+
+        // sums over quarters combined in tree order:
+        // (only if halves are long enough to be split further)
+        if( n >= 100 )
+        {
+            std::vector<real> loLo(lo.begin(), lo.begin() + lo.size()/2);
+            std::vector<real> loHi(lo.begin() + lo.size()/2, lo.end());
+            std::vector<real> hiLo(hi.begin(), hi.begin() + hi.size()/2);
+            std::vector<real> hiHi(hi.begin() + hi.size()/2, hi.end());
+            double combinedQuarters = 
+                    (DeterministicSum::pairwiseDouble(loLo) + 
+                     DeterministicSum::pairwiseDouble(loHi)) + 
+                    (DeterministicSum::pairwiseDouble(hiLo) + 
+                     DeterministicSum::pairwiseDouble(hiHi));
+            ASSERT_EQ(sumDouble, combinedQuarters);
+        }
+
+        // repeated evaluation must agree exactly:
+        ASSERT_EQ(sum, DeterministicSum::pairwise(values));
+    }
+}
+
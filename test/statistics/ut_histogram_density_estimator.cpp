@@ -321,3 +321,47 @@ TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorEstimateTest)
    }
 }
 
+
+/*!
+ * Checks that direct binning of unsorted samples yields the same counts as
+ * counting between consecutive break points in the sorted sample, and that 
+ * estimates with more than 25000 bins (which used to exceed the stack limit
+ * of the interpolation code) can be computed.
+ */
+TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorDirectBinningTest)
+{
+    // create histogram estimator and set bin width:
+    HistogramDensityEstimator hde;
+    hde.setBinWidth(0.01);
+
+    // density from unsorted data:
+    std::vector<real> breaks = hde.createBreaks(testData_);
+    std::vector<real> density = hde.calculateDensity(testData_, breaks);
+
+    // reference counts by searching the sorted data:
+    std::vector<real> sorted = testData_;
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_EQ(breaks, hde.createBreaks(sorted));
+    for(size_t i = 0; i < breaks.size() - 1; i++)
+    {
+        auto lo = std::upper_bound(sorted.begin(), sorted.end(), breaks[i]);
+        auto hi = std::upper_bound(lo, sorted.end(), breaks[i + 1]);
+        real refDensity = static_cast<real>(std::distance(lo, hi))/sorted.size();
+        ASSERT_EQ(refDensity, density[i]);
+    }
+
+    // fine bins over the whole data range:
+    real binWidth = 1e-4;
+    hde.setBinWidth(binWidth);
+    ASSERT_GT(hde.createMidpoints(hde.createBreaks(testData_)).size(), 25000);
+    SplineCurve1D densitySpline = hde.estimate(testData_);
+
+    // integral over data range is one:
+    real integral = 0.0;
+    for(auto x : densitySpline.uniqueKnots())
+    {
+        integral += densitySpline.evaluate(x, 0)*binWidth;
+    }
+    ASSERT_NEAR(1.0, integral, 1e-3);
+}
+
@@ -124,26 +124,115 @@ TEST_F(SummaryStatisticsTest, SummaryStatisticsVarSdTest)
     }
 
     // manually compute mean (needed to compute variance):
-    real mean = std::accumulate(testData_.begin(), testData_.end(), 0.0);
+    // (reference values are computed in double precision as summary 
+    // statistics are accumulated in double precision)
+    double mean = std::accumulate(testData_.begin(), testData_.end(), 0.0);
     mean /= testData_.size();
 
     // manually compute variance and standard deviation:
-    std::vector<real> diff(testData_.size());
+    std::vector<double> diff(testData_.size());
     std::transform(
             testData_.begin(), 
             testData_.end(),
             diff.begin(),
             [mean](real x){ return x - mean; });
-    real var = std::inner_product(
+    double var = std::inner_product(
             diff.begin(), 
             diff.end(), 
             diff.begin(), 
             0.0);
     var /= testData_.size() - 1;
-    real sd = std::sqrt(var);
+    double sd = std::sqrt(var);
+
+    // assert correctness up to rounding to real:
+    ASSERT_NEAR(var, testDataSummary.var(), eps*var);
+    ASSERT_NEAR(sd, testDataSummary.sd(), eps*sd);
+}
+
+
+
+/*!
+ * Checks that merging summary statistics accumulated over two disjoint parts
+ * of the data set yields the same result as accumulating over the entire data
+ * set and that merging with empty statistics has no effect.
+ */
+TEST_F(SummaryStatisticsTest, SummaryStatisticsMergeTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = 10.0*std::numeric_limits<real>::epsilon();
+
+    // accumulate over entire data set:
+    SummaryStatistics fullSummary;
+    for(size_t i = 0; i < testData_.size(); i++)
+    {
+        fullSummary.update(testData_.at(i));
+    }
+
+    // accumulate over two parts of data set:
+    SummaryStatistics loSummary;
+    SummaryStatistics hiSummary;
+    for(size_t i = 0; i < testData_.size(); i++)
+    {
+        if( i < 2 )
+        {
+            loSummary.update(testData_.at(i));
+        }
+        else
+        {
+            hiSummary.update(testData_.at(i));
+        }
+    }
+
+    // merge, including an empty set of statistics:
+    SummaryStatistics mergedSummary;
+    mergedSummary.merge(loSummary);
+    mergedSummary.merge(hiSummary);
+    mergedSummary.merge(SummaryStatistics());
 
     // assert correctness:
-    ASSERT_NEAR(var, testDataSummary.var(), eps);
-    ASSERT_NEAR(sd, testDataSummary.sd(), eps);
+    ASSERT_EQ(fullSummary.num(), mergedSummary.num());
+    ASSERT_NEAR(fullSummary.min(), mergedSummary.min(), eps);
+    ASSERT_NEAR(fullSummary.max(), mergedSummary.max(), eps);
+    ASSERT_NEAR(fullSummary.mean(), mergedSummary.mean(), eps);
+    ASSERT_NEAR(fullSummary.var(), mergedSummary.var(), eps);
 }
 
+
+/*!
+ * Checks that mean and variance remain accurate for a large number of samples
+ * with a large offset from zero, which is where naive accumulation in single
+ * precision loses accuracy.
+ */
+TEST_F(SummaryStatisticsTest, SummaryStatisticsLargeSampleTest)
+{
+    // create large data set with large offset:
+    int numSamples = 1000000;
+    std::vector<real> data;
+    data.reserve(numSamples);
+    for(int i = 0; i < numSamples; i++)
+    {
+        data.push_back(1000.0 + 1e-3*(i % 1000));
+    }
+
+    // reference values computed in double precision:
+    double mean = std::accumulate(data.begin(), data.end(), 0.0);
+    mean /= data.size();
+    double var = 0.0;
+    for(auto x : data)
+    {
+        var += (x - mean)*(x - mean);
+    }
+    var /= data.size() - 1;
+
+    // accumulate summary statistics:
+    SummaryStatistics summary;
+    for(auto x : data)
+    {
+        summary.update(x);
+    }
+
+    // assert correctness:
+    ASSERT_EQ(numSamples, summary.num());
+    ASSERT_NEAR(mean, summary.mean(), 1e-6*mean);
+    ASSERT_NEAR(var, summary.var(), 1e-4*var);
+}